@@ -0,0 +1,468 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stack>
+#include <queue>
+#include <memory>
+#include <type_traits>
+#include <iterator>
+#include "节点池.h"
+#include "运行统计.h"
+
+// 节点从 NodePool 分配，T 可平凡析构时整棵树随节点池整块释放
+template <typename T, typename Alloc = std::allocator<T>>
+class AVLTree
+{
+public:
+    explicit AVLTree(const Alloc &alloc = Alloc()) : root(nullptr), pool(alloc) {}
+    ~AVLTree()
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            destroy(root);
+        }
+    }
+    // 由升序且无重复的序列直接建树
+    template <typename It>
+    AVLTree(It first, It last, const Alloc &alloc = Alloc()) : root(nullptr), pool(alloc)
+    {
+        buildFromSorted(first, last);
+    }
+    AVLTree(const AVLTree &) = delete;
+    AVLTree &operator=(const AVLTree &) = delete;
+
+    // O(n) 建树：每次取中间元素作根，左右子树大小最多差1，天然平衡，不需要任何旋转。
+    // 按中序顺序消费迭代器，所以只需要前向迭代器；原有内容会被清空
+    template <typename It>
+    void buildFromSorted(It first, It last)
+    {
+        clear();
+        size_t n = std::distance(first, last);
+        root = build(first, n);
+    }
+
+    // 合并另一棵树：两棵树分别中序展开成有序序列，归并去重后重新建树，O(n + m)。
+    // other 合并后为空
+    void merge(AVLTree &other)
+    {
+        std::vector<T> a, b, merged;
+        a.reserve(size());
+        b.reserve(other.size());
+        forEach([&a](const T &value)
+                { a.push_back(value); });
+        other.forEach([&b](const T &value)
+                      { b.push_back(value); });
+        merged.reserve(a.size() + b.size());
+        std::set_union(std::make_move_iterator(a.begin()), std::make_move_iterator(a.end()),
+                       std::make_move_iterator(b.begin()), std::make_move_iterator(b.end()),
+                       std::back_inserter(merged));
+        other.clear();
+        buildFromSorted(std::make_move_iterator(merged.begin()), std::make_move_iterator(merged.end()));
+    }
+
+    // 删除所有元素，节点内存留在池里复用
+    void clear()
+    {
+        release(root);
+        root = nullptr;
+    }
+
+    // 插入操作 ，参数value为要插入的值，返回插入后的根节点
+    // 统计：每次修改后整棵树的高度，直方图的最大值就是出现过的最大深度
+    void insert(T value)
+    {
+        root = insert(root, value);
+        NOTES_STATS_RECORD("avl.height", getHeight(root));
+    }
+    void remove(T value)
+    {
+        root = remove(root, value);
+        NOTES_STATS_RECORD("avl.height", getHeight(root));
+    }
+
+    bool find(const T &value) const
+    {
+        Node *current = root;
+        size_t depth = 0;
+        while (current != nullptr)
+        {
+            depth++;
+            if (value < current->data)
+            {
+                current = current->left;
+            }
+            else if (current->data < value)
+            {
+                current = current->right;
+            }
+            else
+            {
+                NOTES_STATS_RECORD("avl.find_depth", depth);
+                return true;
+            }
+        }
+        NOTES_STATS_RECORD("avl.find_depth", depth);
+        return false;
+    }
+
+    size_t size() const
+    {
+        return getSize(root);
+    }
+
+    // 顺序统计：每个节点记录子树大小，以下查询都只走一条根到叶的路径，O(log n)
+    // 第k小的元素（k从0开始），越界时返回nullptr；倒数第k个就是 select(size() - k)
+    const T *select(size_t k) const
+    {
+        Node *current = root;
+        while (current != nullptr)
+        {
+            size_t leftSize = getSize(current->left);
+            if (k < leftSize)
+            {
+                current = current->left;
+            }
+            else if (k == leftSize)
+            {
+                return &current->data;
+            }
+            else
+            {
+                k -= leftSize + 1;
+                current = current->right;
+            }
+        }
+        return nullptr;
+    }
+
+    // 小于 value 的元素个数
+    size_t rank(const T &value) const
+    {
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
+        {
+            if (current->data < value)
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
+            else
+            {
+                current = current->left;
+            }
+        }
+        return n;
+    }
+
+    // 落在闭区间 [lo, hi] 内的元素个数
+    size_t countRange(const T &lo, const T &hi) const
+    {
+        if (hi < lo)
+        {
+            return 0;
+        }
+        return rankUpper(hi) - rank(lo);
+    }
+
+    // 中序遍历
+    void inorderTraversal(std::function<void(T)> visit)
+    {
+        inorderTraversal(root, visit);
+    }
+
+    // 非递归中序遍历，visit 按模板参数传入可以内联；AVL树高度不超过 1.44*log2(n)，固定栈足够
+    template <typename F>
+    void forEach(F visit) const
+    {
+        Node *stack[96];
+        int top = 0;
+        Node *current = root;
+        while (current != nullptr || top > 0)
+        {
+            while (current != nullptr)
+            {
+                stack[top++] = current;
+                current = current->left;
+            }
+            current = stack[--top];
+            visit(current->data);
+            current = current->right;
+        }
+    }
+
+private:
+    struct Node
+    {
+        T data;
+        Node *left;
+        Node *right;
+        int height;
+        size_t size; // 子树节点数，用于顺序统计
+        Node(T value = T()) : data(std::move(value)), left(nullptr), right(nullptr), height(1), size(1) {}
+    };
+    Node *root;
+    NodePool<Node, Alloc> pool; // 所有节点都从这里分配
+
+    template <typename U>
+    Node *createNode(U &&value)
+    {
+        return new (pool.allocate()) Node(std::forward<U>(value));
+    }
+
+    void destroyNode(Node *node)
+    {
+        node->~Node();
+        pool.deallocate(node);
+    }
+
+    // 后序析构整棵树的元素，节点内存由节点池统一释放
+    void destroy(Node *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        destroy(node->left);
+        destroy(node->right);
+        node->~Node();
+    }
+
+    // 不大于 value 的元素个数
+    size_t rankUpper(const T &value) const
+    {
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
+        {
+            if (value < current->data)
+            {
+                current = current->left;
+            }
+            else
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
+        }
+        return n;
+    }
+
+    // 按中序消费 n 个元素，返回子树的根
+    template <typename It>
+    Node *build(It &it, size_t n)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        Node *left = build(it, n / 2);
+        Node *node = createNode(*it);
+        ++it;
+        node->left = left;
+        node->right = build(it, n - n / 2 - 1);
+        update(node);
+        return node;
+    }
+
+    void release(Node *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        release(node->left);
+        release(node->right);
+        destroyNode(node);
+    }
+
+    // 获取节点的高度
+    int getHeight(Node *node) const
+    {
+        return node == nullptr ? 0 : node->height;
+    }
+
+    size_t getSize(Node *node) const
+    {
+        return node == nullptr ? 0 : node->size;
+    }
+
+    // 孩子变化后重新计算高度和子树大小；旋转、插入、删除回溯时都会调用
+    void update(Node *node)
+    {
+        node->height = std::max(getHeight(node->left), getHeight(node->right)) + 1;
+        node->size = getSize(node->left) + getSize(node->right) + 1;
+    }
+    // 右旋转操作 ，参数y为旋转的轴，返回旋转后的根节点
+
+    Node *rightRotate(Node *father)
+    {
+        NOTES_STATS_ADD("avl.rotations", 1);
+        Node *child = father->left;
+        father->left = child->right;
+        child->right = father;
+
+        update(father);
+        update(child);
+
+        return child;
+    }
+    // 左旋转操作 ，参数y为旋转的轴，返回旋转后的根节点
+    Node *leftRotate(Node *father)
+    {
+        NOTES_STATS_ADD("avl.rotations", 1);
+        Node *child = father->right;
+        father->right = child->left;
+        child->left = father;
+
+        update(father);
+        update(child);
+
+        return child;
+    }
+
+    // 左平衡操作
+    Node *leftBalance(Node *node)
+    {
+
+        node->left = leftRotate(node->left);
+        return rightRotate(node); // 右旋转
+    }
+
+    // 右平衡操作
+    Node *rightBalance(Node *node)
+    {
+        node->right = rightRotate(node->right);
+        return leftRotate(node); // 左旋转
+    }
+
+    Node *insert(Node *node, T value)
+    {
+        if (node == nullptr)
+        {
+            return createNode(value);
+        }
+        if (value < node->data)
+        {
+            node->left = insert(node->left, value);
+            if (getHeight(node->left) - getHeight(node->right) > 1)
+            {
+                if (getHeight(node->left->left) > getHeight(node->left->right))
+                {
+                    node = rightRotate(node); // 右旋转
+                }
+                else
+                {
+                    node = leftBalance(node); // 左平衡
+                }
+            }
+        }
+        else if (value > node->data)
+        {
+            node->right = insert(node->right, value);
+            if (getHeight(node->right) - getHeight(node->left) > 1)
+            {
+                if (getHeight(node->right->right) > getHeight(node->right->left))
+                {
+                    node = leftRotate(node); // 左旋转
+                }
+                else
+                {
+                    node = rightBalance(node); // 右平衡
+                }
+            }
+        }
+        else
+        {
+            ;
+        }
+        update(node);
+
+        return node;
+    }
+
+    Node *remove(Node *node, const T &value)
+    {
+        if (node == nullptr)
+        {
+            return nullptr;
+        }
+
+        if (node->data > value)
+        {
+            node->left = remove(node->left, value);
+            if (getHeight(node->right) - getHeight(node->left) > 1)
+            {
+                if (getHeight(node->right->right) > getHeight(node->right->left))
+                {
+                    node = leftRotate(node); // 左旋转
+                }
+                else
+                {
+                    node = rightBalance(node); // 右平衡
+                }
+            }
+        }
+        else if (node->data < value)
+        {
+            node->right = remove(node->right, value);
+            if (getHeight(node->left) - getHeight(node->right) > 1)
+            {
+                if (getHeight(node->left->left) > getHeight(node->left->right))
+                {
+                    node = rightRotate(node); // 右旋转
+                }
+                else
+                {
+                    node = leftBalance(node); // 左平衡
+                }
+            }
+        }
+        else
+        {
+            if (node->left != nullptr && node->right != nullptr)
+            {
+
+                if (getHeight(node->left) > getHeight(node->right))
+                {
+                    Node *maxNode = node->left;
+                    while (maxNode->right != nullptr)
+                    {
+                        maxNode = maxNode->right;
+                    }
+                    node->data = maxNode->data;
+                    node->left = remove(node->left, maxNode->data);
+                }
+                else
+                {
+                    Node *minNode = node->right;
+                    while (minNode->left != nullptr)
+                    {
+                        minNode = minNode->left;
+                    }
+                    node->data = minNode->data;
+                    node->right = remove(node->right, minNode->data);
+                }
+            }
+            else
+            {
+                Node *temp = node->left != nullptr ? node->left : node->right;
+                destroyNode(node);
+                return temp;
+            }
+        }
+        update(node);
+
+        return node;
+    }
+
+    void inorderTraversal(Node *node, std::function<void(T)> visit)
+    {
+        if (node == nullptr)
+            return;
+        inorderTraversal(node->left, visit);
+        visit(node->data);
+        inorderTraversal(node->right, visit);
+    }
+};
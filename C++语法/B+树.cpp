@@ -0,0 +1,120 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "B+树.h"
+#include "红黑树.h"
+#include "AVL树.h"
+
+// B+树与红黑树、AVL树的对比压测：随机插入、随机查找、顺序遍历
+// 用法: ./a.out [n]，默认 10000000 个键
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char *name, const char *phase, double seconds, size_t n)
+{
+    std::cout << std::left << std::setw(8) << name << std::setw(10) << phase
+              << std::right << std::fixed << std::setprecision(3) << std::setw(8) << seconds << " s  "
+              << std::setprecision(1) << std::setw(8) << n / seconds / 1e6 << " M/s" << std::endl;
+}
+
+template <typename Tree>
+static void benchSet(const char *name, const std::vector<int> &keys, const std::vector<int> &probes)
+{
+    Tree tree;
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys)
+    {
+        tree.insert(key);
+    }
+    report(name, "insert", secondsSince(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int key : probes)
+    {
+        hits += tree.find(key);
+    }
+    report(name, "lookup", secondsSince(start), probes.size());
+
+    start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    tree.forEach([&sum](int value)
+                 { sum += value; });
+    report(name, "scan", secondsSince(start), keys.size());
+    if (hits != probes.size() || sum != (long long)keys.size() * ((long long)keys.size() - 1) / 2)
+    {
+        std::cout << name << " 结果错误" << std::endl;
+    }
+}
+
+static void benchBPlus(const std::vector<int> &keys, const std::vector<int> &probes)
+{
+    BPlusTree<int, int> tree;
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys)
+    {
+        tree.insert(key, key);
+    }
+    report("B+Tree", "insert", secondsSince(start), keys.size());
+
+    start = std::chrono::steady_clock::now();
+    size_t hits = 0;
+    for (int key : probes)
+    {
+        hits += tree.find(key);
+    }
+    report("B+Tree", "lookup", secondsSince(start), probes.size());
+
+    start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it)
+    {
+        sum += it.key();
+    }
+    report("B+Tree", "scan", secondsSince(start), keys.size());
+    if (hits != probes.size() || sum != (long long)keys.size() * ((long long)keys.size() - 1) / 2)
+    {
+        std::cout << "B+Tree 结果错误" << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BPlusTree<int, int> demo;
+    for (int i = 0; i < 100; i++)
+    {
+        demo.insert(i, i * 10);
+    }
+    demo.remove(42);
+    std::cout << "Find 42: " << demo.find(42) << std::endl;  // false
+    std::cout << "Value 43: " << *demo.get(43) << std::endl; // 430
+    std::cout << "Range [40, 46): ";
+    for (auto it = demo.lowerBound(40); it != demo.end() && it.key() < 46; ++it)
+    {
+        std::cout << it.key() << " ";
+    }
+    std::cout << std::endl; // 40 41 43 44 45
+
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        keys[i] = (int)i;
+    }
+    std::mt19937_64 rng(12345);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<int> probes(keys);
+    std::shuffle(probes.begin(), probes.end(), rng);
+
+    std::cout << n << " keys" << std::endl;
+    benchBPlus(keys, probes);
+    benchSet<RBTree<int>>("RBTree", keys, probes);
+    benchSet<AVLTree<int>>("AVLTree", keys, probes);
+    return 0;
+}
@@ -0,0 +1,569 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "节点池.h"
+
+// B+树：红黑树每层一次缓存未命中，每个节点还要带三个指针和一个颜色；
+// 这里每个节点是 NODE_BYTES 字节、按缓存行对齐的宽节点，一次能装几十个键，
+// 树高只有 log_B(n)，节点内用二分查找，基本只在换层时才发生缓存未命中。
+// 数据只存在叶子里，叶子之间双向链接，范围扫描就是顺着叶子链表读连续内存。
+// 内部节点 keys[i] 是 children[i+1] 子树里的最小键的下界：children[i] 中的键 < keys[i] <= children[i+1] 中的键。
+template <typename K, typename V, typename Compare = std::less<K>, typename Alloc = std::allocator<K>>
+class BPlusTree
+{
+    static const int NODE_BYTES = 256; // 4条缓存行
+    static const int LEAF_SLOTS = std::max<int>(4, (NODE_BYTES - 32) / (sizeof(K) + sizeof(V)));
+    static const int INNER_SLOTS = std::max<int>(4, (NODE_BYTES - 16) / (sizeof(K) + sizeof(void *)));
+    static const int LEAF_MIN = LEAF_SLOTS / 2;
+    static const int INNER_MIN = INNER_SLOTS / 2;
+
+    struct NodeBase
+    {
+        bool leaf;
+        int count; // 叶子：键值对个数；内部节点：键的个数（孩子数 = count + 1）
+    };
+
+    struct alignas(64) Leaf : NodeBase
+    {
+        Leaf *prev;
+        Leaf *next;
+        K keys[LEAF_SLOTS];
+        V values[LEAF_SLOTS];
+    };
+
+    struct alignas(64) Inner : NodeBase
+    {
+        K keys[INNER_SLOTS];
+        NodeBase *children[INNER_SLOTS + 1];
+    };
+
+public:
+    // 顺着叶子链表前进的迭代器
+    class iterator
+    {
+    public:
+        iterator(Leaf *leaf = nullptr, int pos = 0) : leaf(leaf), pos(pos) {}
+        const K &key() const
+        {
+            return leaf->keys[pos];
+        }
+        V &value() const
+        {
+            return leaf->values[pos];
+        }
+        iterator &operator++()
+        {
+            if (++pos == leaf->count)
+            {
+                leaf = leaf->next;
+                pos = 0;
+            }
+            return *this;
+        }
+        bool operator==(const iterator &other) const
+        {
+            return leaf == other.leaf && pos == other.pos;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        Leaf *leaf;
+        int pos;
+    };
+
+    explicit BPlusTree(const Alloc &alloc = Alloc()) : leafPool(alloc), innerPool(alloc), elementCount(0)
+    {
+        root = head = createLeaf();
+    }
+    ~BPlusTree()
+    {
+        if (!std::is_trivially_destructible<K>::value || !std::is_trivially_destructible<V>::value)
+        {
+            destroy(root);
+        }
+    }
+    BPlusTree(const BPlusTree &) = delete;
+    BPlusTree &operator=(const BPlusTree &) = delete;
+
+    // 插入键值对，键已存在时返回false
+    bool insert(const K &key, const V &value)
+    {
+        K splitKey;
+        NodeBase *splitNode = nullptr;
+        if (!insert(root, key, value, splitKey, splitNode))
+        {
+            return false;
+        }
+        if (splitNode != nullptr)
+        {
+            // 根分裂，树长高一层
+            Inner *newRoot = createInner();
+            newRoot->count = 1;
+            newRoot->keys[0] = splitKey;
+            newRoot->children[0] = root;
+            newRoot->children[1] = splitNode;
+            root = newRoot;
+        }
+        elementCount++;
+        return true;
+    }
+
+    bool remove(const K &key)
+    {
+        if (!remove(root, key))
+        {
+            return false;
+        }
+        // 根只剩一个孩子时，树降低一层
+        if (!root->leaf && root->count == 0)
+        {
+            Inner *old = static_cast<Inner *>(root);
+            root = old->children[0];
+            destroyInner(old);
+        }
+        elementCount--;
+        return true;
+    }
+
+    bool find(const K &key) const
+    {
+        return get(key) != nullptr;
+    }
+
+    // 查找键对应的值，不存在时返回nullptr
+    V *get(const K &key) const
+    {
+        Leaf *leaf = findLeaf(key);
+        int i = lowerBound(leaf->keys, leaf->count, key);
+        if (i < leaf->count && !comp(key, leaf->keys[i]))
+        {
+            return &leaf->values[i];
+        }
+        return nullptr;
+    }
+
+    // 第一个不小于key的位置，用于范围扫描
+    iterator lowerBound(const K &key) const
+    {
+        Leaf *leaf = findLeaf(key);
+        int i = lowerBound(leaf->keys, leaf->count, key);
+        if (i == leaf->count)
+        {
+            return iterator(leaf->next, 0);
+        }
+        return iterator(leaf, i);
+    }
+
+    iterator begin() const
+    {
+        return head->count == 0 ? end() : iterator(head, 0);
+    }
+    iterator end() const
+    {
+        return iterator(nullptr, 0);
+    }
+
+    size_t size() const
+    {
+        return elementCount;
+    }
+
+private:
+    NodeBase *root;
+    Leaf *head; // 最左边的叶子
+    NodePool<Leaf, Alloc> leafPool;
+    NodePool<Inner, Alloc> innerPool;
+    size_t elementCount;
+    Compare comp;
+
+    Leaf *createLeaf()
+    {
+        Leaf *leaf = new (leafPool.allocate()) Leaf();
+        leaf->leaf = true;
+        leaf->count = 0;
+        leaf->prev = leaf->next = nullptr;
+        return leaf;
+    }
+    Inner *createInner()
+    {
+        Inner *inner = new (innerPool.allocate()) Inner();
+        inner->leaf = false;
+        inner->count = 0;
+        return inner;
+    }
+    void destroyLeaf(Leaf *leaf)
+    {
+        leaf->~Leaf();
+        leafPool.deallocate(leaf);
+    }
+    void destroyInner(Inner *inner)
+    {
+        inner->~Inner();
+        innerPool.deallocate(inner);
+    }
+
+    // 只在键值需要析构时调用，节点内存由节点池统一释放
+    void destroy(NodeBase *node)
+    {
+        if (node->leaf)
+        {
+            static_cast<Leaf *>(node)->~Leaf();
+            return;
+        }
+        Inner *inner = static_cast<Inner *>(node);
+        for (int i = 0; i <= inner->count; i++)
+        {
+            destroy(inner->children[i]);
+        }
+        inner->~Inner();
+    }
+
+    int lowerBound(const K *keys, int count, const K &key) const
+    {
+        return std::lower_bound(keys, keys + count, key, comp) - keys;
+    }
+    int upperBound(const K *keys, int count, const K &key) const
+    {
+        return std::upper_bound(keys, keys + count, key, comp) - keys;
+    }
+
+    Leaf *findLeaf(const K &key) const
+    {
+        NodeBase *node = root;
+        while (!node->leaf)
+        {
+            Inner *inner = static_cast<Inner *>(node);
+            node = inner->children[upperBound(inner->keys, inner->count, key)];
+        }
+        return static_cast<Leaf *>(node);
+    }
+
+    // 递归插入；节点分裂时通过 splitKey/splitNode 把新的右兄弟交给父节点
+    bool insert(NodeBase *node, const K &key, const V &value, K &splitKey, NodeBase *&splitNode)
+    {
+        if (node->leaf)
+        {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            int i = lowerBound(leaf->keys, leaf->count, key);
+            if (i < leaf->count && !comp(key, leaf->keys[i]))
+            {
+                return false; // 键已存在
+            }
+            if (leaf->count < LEAF_SLOTS)
+            {
+                insertAt(leaf, i, key, value);
+            }
+            else
+            {
+                splitLeaf(leaf, i, key, value, splitKey, splitNode);
+            }
+            return true;
+        }
+
+        Inner *inner = static_cast<Inner *>(node);
+        int idx = upperBound(inner->keys, inner->count, key);
+        K childKey;
+        NodeBase *childSplit = nullptr;
+        if (!insert(inner->children[idx], key, value, childKey, childSplit))
+        {
+            return false;
+        }
+        if (childSplit != nullptr)
+        {
+            if (inner->count < INNER_SLOTS)
+            {
+                insertAt(inner, idx, childKey, childSplit);
+            }
+            else
+            {
+                splitInner(inner, idx, childKey, childSplit, splitKey, splitNode);
+            }
+        }
+        return true;
+    }
+
+    void insertAt(Leaf *leaf, int i, const K &key, const V &value)
+    {
+        for (int j = leaf->count; j > i; j--)
+        {
+            leaf->keys[j] = std::move(leaf->keys[j - 1]);
+            leaf->values[j] = std::move(leaf->values[j - 1]);
+        }
+        leaf->keys[i] = key;
+        leaf->values[i] = value;
+        leaf->count++;
+    }
+
+    // 在 keys[i] 处插入分隔键，新孩子放在它右边
+    void insertAt(Inner *inner, int i, const K &key, NodeBase *child)
+    {
+        for (int j = inner->count; j > i; j--)
+        {
+            inner->keys[j] = std::move(inner->keys[j - 1]);
+            inner->children[j + 1] = inner->children[j];
+        }
+        inner->keys[i] = key;
+        inner->children[i + 1] = child;
+        inner->count++;
+    }
+
+    // 把 from 的 [first, last) 搬到 to 从 dst 开始的位置
+    static void moveRange(Leaf *from, int first, int last, Leaf *to, int dst)
+    {
+        std::move(from->keys + first, from->keys + last, to->keys + dst);
+        std::move(from->values + first, from->values + last, to->values + dst);
+    }
+
+    // 满叶子加上新元素共 LEAF_SLOTS+1 个，左边留一半，其余搬到新的右叶子
+    void splitLeaf(Leaf *leaf, int i, const K &key, const V &value, K &splitKey, NodeBase *&splitNode)
+    {
+        const int total = LEAF_SLOTS + 1;
+        const int leftCount = total / 2;
+        Leaf *right = createLeaf();
+        right->count = total - leftCount;
+        // 合并后的序列是 leaf[0, i)、新元素、leaf[i, LEAF_SLOTS)，右叶子拿走逻辑位置 [leftCount, total)；
+        // 按新元素落在哪一边分成整段搬运，下标范围一眼可见
+        if (i < leftCount)
+        {
+            moveRange(leaf, leftCount - 1, LEAF_SLOTS, right, 0);
+            leaf->count = leftCount - 1;
+            insertAt(leaf, i, key, value);
+        }
+        else
+        {
+            int at = i - leftCount;
+            moveRange(leaf, leftCount, i, right, 0);
+            right->keys[at] = key;
+            right->values[at] = value;
+            moveRange(leaf, i, LEAF_SLOTS, right, at + 1);
+            leaf->count = leftCount;
+        }
+
+        right->next = leaf->next;
+        right->prev = leaf;
+        if (leaf->next != nullptr)
+        {
+            leaf->next->prev = right;
+        }
+        leaf->next = right;
+
+        splitKey = right->keys[0];
+        splitNode = right;
+    }
+
+    // 满内部节点加上新分隔键共 INNER_SLOTS+1 个键，中间的键上提给父节点
+    void splitInner(Inner *inner, int idx, const K &key, NodeBase *child, K &splitKey, NodeBase *&splitNode)
+    {
+        const int total = INNER_SLOTS + 1;
+        K keys[total];
+        NodeBase *children[total + 1];
+        for (int j = 0, src = 0; j < total; j++)
+        {
+            keys[j] = j == idx ? key : std::move(inner->keys[src++]);
+        }
+        for (int j = 0, src = 0; j <= total; j++)
+        {
+            children[j] = j == idx + 1 ? child : inner->children[src++];
+        }
+
+        const int mid = total / 2;
+        Inner *right = createInner();
+        inner->count = mid;
+        for (int j = 0; j < mid; j++)
+        {
+            inner->keys[j] = std::move(keys[j]);
+            inner->children[j] = children[j];
+        }
+        inner->children[mid] = children[mid];
+        right->count = total - mid - 1;
+        for (int j = 0; j < right->count; j++)
+        {
+            right->keys[j] = std::move(keys[mid + 1 + j]);
+            right->children[j] = children[mid + 1 + j];
+        }
+        right->children[right->count] = children[total];
+
+        splitKey = std::move(keys[mid]);
+        splitNode = right;
+    }
+
+    // 递归删除；孩子元素数低于下限时由父节点借位或合并
+    bool remove(NodeBase *node, const K &key)
+    {
+        if (node->leaf)
+        {
+            Leaf *leaf = static_cast<Leaf *>(node);
+            int i = lowerBound(leaf->keys, leaf->count, key);
+            if (i == leaf->count || comp(key, leaf->keys[i]))
+            {
+                return false;
+            }
+            for (int j = i; j < leaf->count - 1; j++)
+            {
+                leaf->keys[j] = std::move(leaf->keys[j + 1]);
+                leaf->values[j] = std::move(leaf->values[j + 1]);
+            }
+            leaf->count--;
+            return true;
+        }
+
+        Inner *inner = static_cast<Inner *>(node);
+        int idx = upperBound(inner->keys, inner->count, key);
+        NodeBase *child = inner->children[idx];
+        if (!remove(child, key))
+        {
+            return false;
+        }
+        if (child->count < (child->leaf ? LEAF_MIN : INNER_MIN))
+        {
+            fixUnderflow(inner, idx);
+        }
+        return true;
+    }
+
+    // 先尝试从左右兄弟借一个，兄弟也只剩下限时就合并
+    void fixUnderflow(Inner *parent, int idx)
+    {
+        NodeBase *child = parent->children[idx];
+        NodeBase *left = idx > 0 ? parent->children[idx - 1] : nullptr;
+        NodeBase *right = idx < parent->count ? parent->children[idx + 1] : nullptr;
+        int minCount = child->leaf ? LEAF_MIN : INNER_MIN;
+
+        if (left != nullptr && left->count > minCount)
+        {
+            borrowFromLeft(parent, idx);
+        }
+        else if (right != nullptr && right->count > minCount)
+        {
+            borrowFromRight(parent, idx);
+        }
+        else if (left != nullptr)
+        {
+            merge(parent, idx - 1);
+        }
+        else
+        {
+            merge(parent, idx);
+        }
+    }
+
+    void borrowFromLeft(Inner *parent, int idx)
+    {
+        if (parent->children[idx]->leaf)
+        {
+            Leaf *child = static_cast<Leaf *>(parent->children[idx]);
+            Leaf *left = static_cast<Leaf *>(parent->children[idx - 1]);
+            insertAt(child, 0, left->keys[left->count - 1], left->values[left->count - 1]);
+            left->count--;
+            parent->keys[idx - 1] = child->keys[0];
+        }
+        else
+        {
+            Inner *child = static_cast<Inner *>(parent->children[idx]);
+            Inner *left = static_cast<Inner *>(parent->children[idx - 1]);
+            for (int j = child->count; j > 0; j--)
+            {
+                child->keys[j] = std::move(child->keys[j - 1]);
+            }
+            for (int j = child->count + 1; j > 0; j--)
+            {
+                child->children[j] = child->children[j - 1];
+            }
+            child->keys[0] = std::move(parent->keys[idx - 1]);
+            child->children[0] = left->children[left->count];
+            child->count++;
+            parent->keys[idx - 1] = std::move(left->keys[left->count - 1]);
+            left->count--;
+        }
+    }
+
+    void borrowFromRight(Inner *parent, int idx)
+    {
+        if (parent->children[idx]->leaf)
+        {
+            Leaf *child = static_cast<Leaf *>(parent->children[idx]);
+            Leaf *right = static_cast<Leaf *>(parent->children[idx + 1]);
+            child->keys[child->count] = std::move(right->keys[0]);
+            child->values[child->count] = std::move(right->values[0]);
+            child->count++;
+            for (int j = 0; j < right->count - 1; j++)
+            {
+                right->keys[j] = std::move(right->keys[j + 1]);
+                right->values[j] = std::move(right->values[j + 1]);
+            }
+            right->count--;
+            parent->keys[idx] = right->keys[0];
+        }
+        else
+        {
+            Inner *child = static_cast<Inner *>(parent->children[idx]);
+            Inner *right = static_cast<Inner *>(parent->children[idx + 1]);
+            child->keys[child->count] = std::move(parent->keys[idx]);
+            child->children[child->count + 1] = right->children[0];
+            child->count++;
+            parent->keys[idx] = std::move(right->keys[0]);
+            for (int j = 0; j < right->count - 1; j++)
+            {
+                right->keys[j] = std::move(right->keys[j + 1]);
+            }
+            for (int j = 0; j < right->count; j++)
+            {
+                right->children[j] = right->children[j + 1];
+            }
+            right->count--;
+        }
+    }
+
+    // 把 children[i+1] 合并进 children[i]，并删掉它们之间的分隔键
+    void merge(Inner *parent, int i)
+    {
+        if (parent->children[i]->leaf)
+        {
+            Leaf *left = static_cast<Leaf *>(parent->children[i]);
+            Leaf *right = static_cast<Leaf *>(parent->children[i + 1]);
+            for (int j = 0; j < right->count; j++)
+            {
+                left->keys[left->count + j] = std::move(right->keys[j]);
+                left->values[left->count + j] = std::move(right->values[j]);
+            }
+            left->count += right->count;
+            left->next = right->next;
+            if (right->next != nullptr)
+            {
+                right->next->prev = left;
+            }
+            destroyLeaf(right);
+        }
+        else
+        {
+            Inner *left = static_cast<Inner *>(parent->children[i]);
+            Inner *right = static_cast<Inner *>(parent->children[i + 1]);
+            left->keys[left->count] = std::move(parent->keys[i]);
+            for (int j = 0; j < right->count; j++)
+            {
+                left->keys[left->count + 1 + j] = std::move(right->keys[j]);
+            }
+            for (int j = 0; j <= right->count; j++)
+            {
+                left->children[left->count + 1 + j] = right->children[j];
+            }
+            left->count += right->count + 1;
+            destroyInner(right);
+        }
+        for (int j = i; j < parent->count - 1; j++)
+        {
+            parent->keys[j] = std::move(parent->keys[j + 1]);
+        }
+        for (int j = i + 1; j < parent->count; j++)
+        {
+            parent->children[j] = parent->children[j + 1];
+        }
+        parent->count--;
+    }
+};
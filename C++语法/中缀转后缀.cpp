@@ -1,9 +1,21 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <stack>
+#include <stdexcept>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "分段栈.h"
 using namespace std;
-// 中缀转后缀表达式
+// 中缀转后缀表达式，并把后缀式编译成字节码求值
+//   1. 词法分析：多位整数、小数和科学计数法（交给 strtod）、变量名、一元负号；
+//   2. 调度场算法一遍扫描，直接产出后缀字节码，常量子表达式在编译时折叠掉；
+//   3. 编译时算出求值栈的最大深度，求值用定长数组做栈，不分配内存；
+//   4. 批量模式按列给输入，每条指令对一批行做完再执行下一条，解释分派的开销均摊到整批上。
 
 int priority(char c)
 {
@@ -15,6 +27,10 @@ int priority(char c)
     {
         return 2;
     }
+    else if (c == 'u') // 一元负号
+    {
+        return 3;
+    }
     else if (c == '(')
     {
         return 0;
@@ -24,58 +40,526 @@ int priority(char c)
         return 0;
     }
 }
-string infixToSuffix(string infix)
+
+struct Token
 {
-    string suffix;
-    stack<char> st;
+    enum Kind
+    {
+        NUMBER,
+        VARIABLE,
+        OPERATOR,
+        LEFT_PAREN,
+        RIGHT_PAREN
+    };
+    Kind kind;
+    double value; // NUMBER
+    string name;  // VARIABLE
+    char op;      // OPERATOR：+ - * / 以及一元负号 u
+};
 
-    for (char c : infix)
+vector<Token> tokenize(const string &infix)
+{
+    vector<Token> tokens;
+    // 开头、运算符和左括号之后等的是操作数，此时 + - 是一元的；操作数和右括号之后等的是二元运算符或右括号
+    bool expectOperand = true;
+    size_t i = 0;
+    while (i < infix.size())
     {
+        char c = infix[i];
+        bool unaryPosition = expectOperand;
+        Token t;
         if (c == ' ')
+        {
+            i++;
             continue;
-
-        if (isdigit(c))
+        }
+        if (isdigit((unsigned char)c) || c == '.')
         {
-            suffix += c;
+            char *end;
+            t.kind = Token::NUMBER;
+            t.value = strtod(infix.c_str() + i, &end);
+            size_t used = end - (infix.c_str() + i);
+            if (used == 0)
+            {
+                throw invalid_argument("无法解析的数字: " + infix.substr(i));
+            }
+            i += used;
         }
-        else if (c == '(')
+        else if (isalpha((unsigned char)c) || c == '_')
         {
-            st.push(c);
+            size_t j = i + 1;
+            while (j < infix.size() && (isalnum((unsigned char)infix[j]) || infix[j] == '_'))
+            {
+                j++;
+            }
+            t.kind = Token::VARIABLE;
+            t.name = infix.substr(i, j - i);
+            i = j;
         }
-        else if (c == ')')
+        else if (c == '+' || c == '-' || c == '*' || c == '/')
         {
-            while (!st.empty() && st.top() != '(')
+            i++;
+            if (unaryPosition && c == '+')
             {
-                suffix += st.top();
-                st.pop();
+                continue; // 一元正号什么也不做
             }
-            if (!st.empty())
-                st.pop(); // 弹出左括号
+            if (unaryPosition && c != '-')
+            {
+                throw invalid_argument(string("运算符缺少左操作数: ") + c);
+            }
+            t.kind = Token::OPERATOR;
+            t.op = unaryPosition ? 'u' : c;
+        }
+        else if (c == '(' || c == ')')
+        {
+            t.kind = c == '(' ? Token::LEFT_PAREN : Token::RIGHT_PAREN;
+            i++;
         }
         else
-        { // 运算符
-            while (!st.empty() && priority(c) <= priority(st.top()))
+        {
+            throw invalid_argument(string("非法字符: ") + c);
+        }
+        // 两个操作数挨着（"3 4 +"、"(x) y"）或操作数后面跟左括号，中间少了运算符
+        if ((t.kind == Token::NUMBER || t.kind == Token::VARIABLE || t.kind == Token::LEFT_PAREN) && !expectOperand)
+        {
+            throw invalid_argument("操作数之间缺少运算符: " + infix.substr(0, i));
+        }
+        expectOperand = t.kind == Token::OPERATOR || t.kind == Token::LEFT_PAREN;
+        tokens.push_back(t);
+    }
+    return tokens;
+}
+
+// 编译好的表达式：一段后缀字节码，常量和变量名各放一张表，指令里只存下标
+class Expression
+{
+public:
+    static const int MAX_STACK = 64; // 求值栈的最大深度，编译时超过就报错
+
+    // fold 为 false 时不做常量折叠，后缀式和原式一一对应
+    explicit Expression(const string &infix, bool fold = true) : depth_(0), fold_(fold)
+    {
+        compile(tokenize(infix));
+    }
+
+    // eval 的参数按这个顺序给出变量的值
+    const vector<string> &variables() const
+    {
+        return vars_;
+    }
+
+    double eval(const double *values) const
+    {
+        double stack[MAX_STACK];
+        int sp = 0;
+        for (const Instr &in : code_)
+        {
+            switch (in.op)
+            {
+            case PUSH_CONST:
+                stack[sp++] = consts_[in.index];
+                break;
+            case PUSH_VAR:
+                stack[sp++] = values[in.index];
+                break;
+            case ADD:
+                sp--;
+                stack[sp - 1] += stack[sp];
+                break;
+            case SUB:
+                sp--;
+                stack[sp - 1] -= stack[sp];
+                break;
+            case MUL:
+                sp--;
+                stack[sp - 1] *= stack[sp];
+                break;
+            case DIV:
+                sp--;
+                stack[sp - 1] /= stack[sp];
+                break;
+            case NEG:
+                stack[sp - 1] = -stack[sp - 1];
+                break;
+            }
+        }
+        return stack[0];
+    }
+
+    // 批量求值：columns[k] 是第 k 个变量的一整列，共 rows 行，结果写到 out
+    void evalBatch(const double *const *columns, size_t rows, double *out) const
+    {
+        const size_t BLOCK = 256;
+        vector<double> buffer(depth_ * BLOCK);
+        for (size_t base = 0; base < rows; base += BLOCK)
+        {
+            size_t n = min(BLOCK, rows - base);
+            int sp = 0;
+            for (const Instr &in : code_)
+            {
+                double *top = buffer.data() + sp * BLOCK; // 栈顶之上的第一层，每层 BLOCK 行
+                switch (in.op)
+                {
+                case PUSH_CONST:
+                    fill(top, top + n, consts_[in.index]);
+                    sp++;
+                    break;
+                case PUSH_VAR:
+                    copy(columns[in.index] + base, columns[in.index] + base + n, top);
+                    sp++;
+                    break;
+                case NEG:
+                    negate(buffer.data() + (sp - 1) * BLOCK, n);
+                    break;
+                default:
+                    sp--;
+                    binary(in.op, buffer.data() + (sp - 1) * BLOCK, buffer.data() + sp * BLOCK, n);
+                    break;
+                }
+            }
+            copy(buffer.data(), buffer.data() + n, out + base);
+        }
+    }
+
+    // 以空格分隔的后缀式，一元负号写成 neg
+    string toPostfix() const
+    {
+        string s;
+        for (const Instr &in : code_)
+        {
+            if (!s.empty())
             {
-                suffix += st.top();
-                st.pop();
+                s += ' ';
             }
-            st.push(c);
+            switch (in.op)
+            {
+            case PUSH_CONST:
+            {
+                char buf[32];
+                snprintf(buf, sizeof(buf), "%g", consts_[in.index]);
+                s += buf;
+                break;
+            }
+            case PUSH_VAR:
+                s += vars_[in.index];
+                break;
+            case ADD:
+                s += '+';
+                break;
+            case SUB:
+                s += '-';
+                break;
+            case MUL:
+                s += '*';
+                break;
+            case DIV:
+                s += '/';
+                break;
+            case NEG:
+                s += "neg";
+                break;
+            }
+        }
+        return s;
+    }
+
+private:
+    enum Op : uint8_t
+    {
+        PUSH_CONST,
+        PUSH_VAR,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        NEG
+    };
+
+    struct Instr
+    {
+        Op op;
+        uint32_t index; // PUSH_CONST / PUSH_VAR 的表下标
+    };
+
+    vector<Instr> code_;
+    vector<double> consts_;
+    vector<string> vars_;
+    int depth_; // 求值栈的最大深度
+    bool fold_;
+
+    // a[r] = a[r] op b[r]：每种运算一个紧凑的循环，编译器可以向量化
+    static void binary(Op op, double *a, const double *b, size_t n)
+    {
+        switch (op)
+        {
+        case ADD:
+            for (size_t r = 0; r < n; r++)
+                a[r] += b[r];
+            break;
+        case SUB:
+            for (size_t r = 0; r < n; r++)
+                a[r] -= b[r];
+            break;
+        case MUL:
+            for (size_t r = 0; r < n; r++)
+                a[r] *= b[r];
+            break;
+        default:
+            for (size_t r = 0; r < n; r++)
+                a[r] /= b[r];
+            break;
         }
     }
 
-    while (!st.empty())
+    static void negate(double *a, size_t n)
     {
-        suffix += st.top();
-        st.pop();
+        for (size_t r = 0; r < n; r++)
+            a[r] = -a[r];
     }
-    return suffix;
+
+    // 调度场算法：操作数直接输出，运算符按优先级在栈里等待
+    void compile(const vector<Token> &tokens)
+    {
+        SegmentedStack<char> ops;
+        int sp = 0;
+        for (const Token &t : tokens)
+        {
+            if (t.kind == Token::NUMBER)
+            {
+                pushConst(t.value, sp);
+            }
+            else if (t.kind == Token::VARIABLE)
+            {
+                size_t k = find(vars_.begin(), vars_.end(), t.name) - vars_.begin();
+                if (k == vars_.size())
+                {
+                    vars_.push_back(t.name);
+                }
+                code_.push_back({PUSH_VAR, (uint32_t)k});
+                grow(sp);
+            }
+            else if (t.kind == Token::LEFT_PAREN)
+            {
+                ops.push('(');
+            }
+            else if (t.kind == Token::RIGHT_PAREN)
+            {
+                while (!ops.empty() && ops.top() != '(')
+                {
+                    emit(ops.top(), sp);
+                    ops.pop();
+                }
+                if (ops.empty())
+                {
+                    throw invalid_argument("右括号没有匹配的左括号");
+                }
+                ops.pop(); // 弹出左括号
+            }
+            else
+            {
+                // 一元负号右结合，遇到同级的不弹出；二元运算符左结合
+                while (!ops.empty() && ops.top() != '(' &&
+                       (t.op == 'u' ? priority(t.op) < priority(ops.top()) : priority(t.op) <= priority(ops.top())))
+                {
+                    emit(ops.top(), sp);
+                    ops.pop();
+                }
+                ops.push(t.op);
+            }
+        }
+        while (!ops.empty())
+        {
+            if (ops.top() == '(')
+            {
+                throw invalid_argument("左括号没有闭合");
+            }
+            emit(ops.top(), sp);
+            ops.pop();
+        }
+        if (sp != 1)
+        {
+            throw invalid_argument("表达式不完整");
+        }
+    }
+
+    void grow(int &sp)
+    {
+        if (++sp > MAX_STACK)
+        {
+            throw invalid_argument("表达式嵌套太深");
+        }
+        depth_ = max(depth_, sp);
+    }
+
+    void pushConst(double value, int &sp)
+    {
+        consts_.push_back(value);
+        code_.push_back({PUSH_CONST, (uint32_t)(consts_.size() - 1)});
+        grow(sp);
+    }
+
+    static double apply(char op, double a, double b)
+    {
+        switch (op)
+        {
+        case '+':
+            return a + b;
+        case '-':
+            return a - b;
+        case '*':
+            return a * b;
+        default:
+            return a / b;
+        }
+    }
+
+    // 输出一个运算符；操作数都是常量时直接算出结果替换掉（常量折叠）
+    void emit(char op, int &sp)
+    {
+        int arity = op == 'u' ? 1 : 2;
+        if (sp < arity)
+        {
+            throw invalid_argument(string("运算符缺少操作数: ") + (op == 'u' ? '-' : op));
+        }
+        size_t n = code_.size();
+        if (fold_ && op == 'u' && code_[n - 1].op == PUSH_CONST)
+        {
+            consts_[code_[n - 1].index] = -consts_[code_[n - 1].index];
+            return;
+        }
+        if (fold_ && arity == 2 && code_[n - 1].op == PUSH_CONST && code_[n - 2].op == PUSH_CONST)
+        {
+            double value = apply(op, consts_[code_[n - 2].index], consts_[code_[n - 1].index]);
+            code_.resize(n - 2);
+            consts_.resize(consts_.size() - 2); // 两个常量一定是常量表里最后两个
+            sp -= 2;
+            pushConst(value, sp);
+            return;
+        }
+        switch (op)
+        {
+        case '+':
+            code_.push_back({ADD, 0});
+            break;
+        case '-':
+            code_.push_back({SUB, 0});
+            break;
+        case '*':
+            code_.push_back({MUL, 0});
+            break;
+        case '/':
+            code_.push_back({DIV, 0});
+            break;
+        default:
+            code_.push_back({NEG, 0});
+            break;
+        }
+        sp -= arity - 1;
+    }
+};
+
+// 中缀转后缀：操作数和运算符之间用空格分开，多位数、小数、变量都能原样保留
+string infixToSuffix(string infix)
+{
+    return Expression(infix, false).toPostfix();
 }
 
-int main()
+// 压测：./a.out bench [rows]，同一个公式对 rows 组输入求值
+void bench(size_t rows)
 {
+    const string formula = "(x + 1.5) * (y - 2) / 3 + x * x - -y";
+    vector<double> xs(rows), ys(rows), out(rows);
+    mt19937 rng(12345);
+    for (size_t r = 0; r < rows; r++)
+    {
+        xs[r] = (double)(rng() % 1000) / 10;
+        ys[r] = (double)(rng() % 1000) / 10;
+    }
+    auto native = [](double x, double y)
+    {
+        return (x + 1.5) * (y - 2) / 3 + x * x - -y;
+    };
+
+    auto start = chrono::steady_clock::now();
+    double sumParse = 0;
+    size_t parseRows = rows / 100; // 每次都重新编译太慢，只跑 1%
+    for (size_t r = 0; r < parseRows; r++)
+    {
+        double values[2] = {xs[r], ys[r]};
+        sumParse += Expression(formula).eval(values);
+    }
+    double parseTime = chrono::duration<double>(chrono::steady_clock::now() - start).count() * 100;
+
+    Expression expr(formula);
+    start = chrono::steady_clock::now();
+    double sumEval = 0;
+    for (size_t r = 0; r < rows; r++)
+    {
+        double values[2] = {xs[r], ys[r]};
+        sumEval += expr.eval(values);
+    }
+    double evalTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const double *columns[2] = {xs.data(), ys.data()};
+    start = chrono::steady_clock::now();
+    expr.evalBatch(columns, rows, out.data());
+    double batchTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    double sumNative = 0;
+    for (size_t r = 0; r < rows; r++)
+    {
+        sumNative += native(xs[r], ys[r]);
+    }
+    double nativeTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    bool ok = true;
+    for (size_t r = 0; r < rows; r++)
+    {
+        ok = ok && out[r] == native(xs[r], ys[r]);
+    }
+    cout << formula << "  ->  " << expr.toPostfix() << endl;
+    cout << rows << " 组输入 (每秒百万次)" << endl;
+    cout << "  每次重新编译    " << rows / parseTime / 1e6 << endl;
+    cout << "  编译一次逐行求值 " << rows / evalTime / 1e6 << endl;
+    cout << "  按列批量求值     " << rows / batchTime / 1e6 << endl;
+    cout << "  原生 C++         " << rows / nativeTime / 1e6 << endl;
+    if (!ok || sumEval != sumNative)
+    {
+        cout << "  结果错误" << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000000);
+        return 0;
+    }
     string infix = "(2+1)*(3-4)-9/3";
     string suffix = infixToSuffix(infix);
     cout << suffix << endl;
 
+    Expression expr("rate * (price - 12.5) / -qty + 2 * 3");
+    cout << expr.toPostfix() << endl; // 2 * 3 在编译时折叠成 6
+    double values[3] = {0.2, 100, 4}; // 顺序同 expr.variables(): rate price qty
+    cout << expr.eval(values) << endl;
+
+    // 不合法的表达式都应当在编译时报错
+    const char *bad[] = {"3 * (x + ", "3 4 +", "x y *", "(1 + 2) 3", "x (y)", "2 * / 3", "(1))", ""};
+    for (const char *infix : bad)
+    {
+        try
+        {
+            Expression e(infix);
+            cout << "应当编译失败却成功了: " << infix << endl;
+        }
+        catch (const invalid_argument &e)
+        {
+            cout << "编译失败: " << e.what() << endl;
+        }
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -2,6 +2,12 @@
 #include <vector>
 #include <string>
 #include <stack>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "二分查找.h"
 using namespace std;
 
 int BinarySearch(vector<int> &nums, int target)
@@ -28,11 +34,102 @@ int BinarySearch(vector<int> &nums, int target)
     return -1;
 }
 
-int main()
+template <typename F>
+static double nsPerQuery(size_t queries, F f)
+{
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / queries;
+}
+
+// 数组从 4KB（L1）到 64MB（内存）逐级放大，每种规模查 queries 次随机键，输出每次查询的纳秒数
+// 数组里是 0, 2, 4, ...，键在 [0, 2n) 里均匀取，一半命中一半落在两个元素之间
+static void bench(size_t maxN, size_t queries)
+{
+    mt19937 rng(1);
+    // 中文占两列，表头手工对齐
+    cout << "         n        KB  分支二分std::lower    无分支无分支批量 Eytzinger  Eytz批量" << endl;
+    for (size_t n = 1024; n <= maxN; n *= 4)
+    {
+        vector<int> nums(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            nums[i] = (int)(2 * i);
+        }
+        vector<int> keys(queries);
+        for (int &key : keys)
+        {
+            key = (int)(rng() % (2 * n));
+        }
+        searching::Eytzinger<int> tree(nums.data(), n);
+        vector<size_t> expect(queries), got(queries);
+        long long sink = 0;
+        double times[6];
+        times[0] = nsPerQuery(queries, [&]
+                              {
+                                  for (int key : keys)
+                                  {
+                                      sink += BinarySearch(nums, key);
+                                  }
+                              });
+        times[1] = nsPerQuery(queries, [&]
+                              {
+                                  for (size_t i = 0; i < queries; i++)
+                                  {
+                                      expect[i] = lower_bound(nums.begin(), nums.end(), keys[i]) - nums.begin();
+                                  }
+                              });
+        bool ok = true;
+        auto check = [&]
+        {
+            ok = ok && got == expect;
+            fill(got.begin(), got.end(), 0);
+        };
+        times[2] = nsPerQuery(queries, [&]
+                              {
+                                  for (size_t i = 0; i < queries; i++)
+                                  {
+                                      got[i] = searching::lowerBound(nums.data(), n, keys[i]);
+                                  }
+                              });
+        check();
+        times[3] = nsPerQuery(queries, [&]
+                              { searching::lowerBoundBatch(nums.data(), n, keys.data(), queries, got.data()); });
+        check();
+        times[4] = nsPerQuery(queries, [&]
+                              {
+                                  for (size_t i = 0; i < queries; i++)
+                                  {
+                                      got[i] = tree.lowerBound(keys[i]);
+                                  }
+                              });
+        check();
+        times[5] = nsPerQuery(queries, [&]
+                              { tree.lowerBoundBatch(keys.data(), queries, got.data()); });
+        check();
+        cout << setw(10) << n << setw(10) << n * sizeof(int) / 1024 << fixed << setprecision(1);
+        for (double t : times)
+        {
+            cout << setw(10) << t;
+        }
+        cout << (ok ? "" : "  结果错误") << (sink == 0 ? " " : "") << endl; // 用一下 sink，分支二分那一轮不会被优化掉
+    }
+}
+
+int main(int argc, char *argv[])
 {
     vector<int> nums = {1, 2, 3, 4, 5, 6, 7, 8, 9};
     int target = 9;
     cout << BinarySearch(nums, target) << endl;
 
+    // lower_bound 语义：第一个不小于 key 的位置
+    searching::Eytzinger<int> tree(nums.data(), nums.size());
+    cout << searching::lowerBound(nums.data(), nums.size(), target) << " " << tree.lowerBound(target) << " "
+         << tree.lowerBound(100) << endl;
+
+    // 用法: ./a.out [最大元素个数] [查询次数]
+    size_t maxN = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t)1 << 24;
+    size_t queries = argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000000;
+    bench(maxN, queries);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+// 静态有序数组上的批量查找，返回值都是 lower_bound 语义：第一个不小于 key 的位置，找不到时是 n。
+//   searching::lowerBound       无分支二分：每步只做一次比较，比较结果直接算出下一半的起点，循环次数只和 n 有关，
+//                               不会因为分支预测失败而清空流水线；
+//   searching::lowerBoundBatch  同一批 BATCH 个查询按步同步推进，每步的 BATCH 次访存互不依赖，
+//                               CPU 可以同时发出，数组超出缓存后主要靠它掩盖内存延迟；
+//   searching::Eytzinger        把有序数组按二叉树的层序（BFS）重新摆放，节点 k 的孩子是 2k 和 2k+1，
+//                               往下 4 层的 16 个后代正好挨在一条缓存行里，可以提前预取，
+//                               树的上面几层也总在缓存里；lowerBoundBatch 同样按批交错推进。
+// 比较器是模板参数，元素类型要能默认构造和拷贝。
+namespace searching
+{
+    const int BATCH = 16;          // 同时在途的查询数，再多就超过一个核能同时挂起的缓存缺失数了
+    const size_t CACHE_LINE = 64;
+
+    inline void prefetch(const void *p)
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    template <typename T, typename Compare = std::less<T>>
+    size_t lowerBound(const T *data, size_t n, const T &key, Compare comp = Compare())
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        const T *base = data;
+        while (n > 1)
+        {
+            size_t half = n / 2;
+            // 没有分支就没有预测执行替我们提前取数，两个可能的下一步探测点都先预取
+            prefetch(base + half / 2);
+            prefetch(base + half + half / 2);
+            base += comp(base[half - 1], key) * half; // 比较结果当作 0/1 参与算术，编译器不会生成跳转
+            n -= half;
+        }
+        return (size_t)(base - data) + comp(*base, key);
+    }
+
+    // out[i] = lowerBound(data, n, keys[i])
+    template <typename T, typename Compare = std::less<T>>
+    void lowerBoundBatch(const T *data, size_t n, const T *keys, size_t count, size_t *out, Compare comp = Compare())
+    {
+        size_t i = 0;
+        for (; n > 0 && i + BATCH <= count; i += BATCH)
+        {
+            const T *base[BATCH];
+            for (int j = 0; j < BATCH; j++)
+            {
+                base[j] = data;
+            }
+            for (size_t len = n; len > 1; len -= len / 2)
+            {
+                size_t half = len / 2;
+                for (int j = 0; j < BATCH; j++)
+                {
+                    base[j] += comp(base[j][half - 1], keys[i + j]) * half;
+                }
+            }
+            for (int j = 0; j < BATCH; j++)
+            {
+                out[i + j] = (size_t)(base[j] - data) + comp(*base[j], keys[i + j]);
+            }
+        }
+        for (; i < count; i++)
+        {
+            out[i] = lowerBound(data, n, keys[i], comp);
+        }
+    }
+
+    template <typename T, typename Compare = std::less<T>>
+    class Eytzinger
+    {
+    public:
+        // sorted 必须已按 comp 升序排好
+        Eytzinger(const T *sorted, size_t n, Compare comp = Compare())
+            : n_(n), tree_(allocate(n + 1)), rank_(n + 1, n), comp_(comp)
+        {
+            size_t next = 0;
+            build(sorted, next, 1);
+            for (levels_ = 0; ((size_t)1 << levels_) <= n_; levels_++)
+            {
+            }
+        }
+
+        ~Eytzinger()
+        {
+            for (size_t i = 0; i <= n_; i++)
+            {
+                tree_[i].~T();
+            }
+            ::operator delete(tree_, std::align_val_t(CACHE_LINE));
+        }
+
+        Eytzinger(const Eytzinger &) = delete;
+        Eytzinger &operator=(const Eytzinger &) = delete;
+
+        size_t size() const { return n_; }
+
+        // 返回在原有序数组里的下标
+        size_t lowerBound(const T &key) const
+        {
+            size_t k = 1;
+            while (k <= n_)
+            {
+                prefetchDescendants(k); // 4 层之后要访问的那条缓存行
+                k = 2 * k + comp_(tree_[k], key);
+            }
+            return rank_[resolve(k)];
+        }
+
+        void lowerBoundBatch(const T *keys, size_t count, size_t *out) const
+        {
+            // 整批的上界先算好，循环条件里没有可能回绕的 i + BATCH
+            size_t full = count - count % BATCH;
+            size_t i = 0;
+            for (; i < full; i += BATCH)
+            {
+                size_t k[BATCH];
+                for (int j = 0; j < BATCH; j++)
+                {
+                    k[j] = 1;
+                }
+                // 走满层数，已经落到树外的查询原地不动，循环里没有依赖数据的跳出
+                for (int level = 0; level < levels_; level++)
+                {
+                    for (int j = 0; j < BATCH; j++)
+                    {
+                        bool inside = k[j] <= n_;
+                        size_t node = inside ? k[j] : 0; // 树外的查询读 tree_[0]，结果丢掉
+                        prefetchDescendants(node);
+                        size_t child = 2 * k[j] + comp_(tree_[node], keys[i + j]);
+                        k[j] = inside ? child : k[j];
+                    }
+                }
+                for (int j = 0; j < BATCH; j++)
+                {
+                    out[i + j] = rank_[resolve(k[j])];
+                }
+            }
+            for (; i < count; i++)
+            {
+                out[i] = lowerBound(keys[i]);
+            }
+        }
+
+    private:
+        // 一条缓存行放得下的元素个数；节点 k 往下 log2(PREFETCH_STRIDE) 层的后代从 k * PREFETCH_STRIDE 开始连续存放
+        static const size_t PREFETCH_STRIDE = CACHE_LINE / sizeof(T) > 0 ? CACHE_LINE / sizeof(T) : 1;
+
+        size_t n_;
+        T *tree_;                  // tree_[1..n]，tree_[0] 只给批量查询里已经出树的查询占位；首地址按缓存行对齐，同一组后代不跨行
+        std::vector<size_t> rank_; // tree_[k] 在原数组里的下标，rank_[0] == n 表示没找到
+        Compare comp_;
+        int levels_;               // 树的层数
+
+        // 下标越过 n_ 时地址落在数组之外，预取本身不会出错，但 tree_ + k 这样的指针运算是未定义行为，
+        // 所以按整数算地址
+        void prefetchDescendants(size_t k) const
+        {
+            prefetch(reinterpret_cast<const void *>(reinterpret_cast<uintptr_t>(tree_) + k * PREFETCH_STRIDE * sizeof(T)));
+        }
+
+        static T *allocate(size_t count)
+        {
+            // 预取越过末尾也不会出错，不用为它多分配
+            T *p = static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(CACHE_LINE)));
+            for (size_t i = 0; i < count; i++)
+            {
+                new (p + i) T();
+            }
+            return p;
+        }
+
+        // 中序遍历树的下标，依次填入有序数组的元素；深度只有 log2(n)，递归不会溢出
+        void build(const T *sorted, size_t &next, size_t k)
+        {
+            if (k > n_)
+            {
+                return;
+            }
+            build(sorted, next, 2 * k);
+            tree_[k] = sorted[next];
+            rank_[k] = next;
+            next++;
+            build(sorted, next, 2 * k + 1);
+        }
+
+        // 最后一次向左走的节点就是答案：去掉末尾连续的 1 和再后面的一个 0；一直向右走时得到 0
+        static size_t resolve(size_t k)
+        {
+#if defined(__GNUC__)
+            return k >> (__builtin_ctzll(~(unsigned long long)k) + 1);
+#else
+            while (k & 1)
+            {
+                k >>= 1;
+            }
+            return k >> 1;
+#endif
+        }
+    };
+}
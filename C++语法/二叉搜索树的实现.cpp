@@ -2,19 +2,101 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
-#include <stack>
+#include "分段栈.h"
+#include <iterator>
 #include <queue>
-template <typename T, typename Compare = std::less<T>>
+#include <memory>
+#include <type_traits>
+#include "节点池.h"
+#include "树校验.h"
+// 节点从 NodePool 分配，T 可平凡析构时整棵树随节点池整块释放
+template <typename T, typename Compare = std::less<T>, typename Alloc = std::allocator<T>>
 class BSTree
 {
+    struct Node;
+
 public:
-    BSTree() : root(nullptr) {}
+    explicit BSTree(const Alloc &alloc = Alloc()) : root(nullptr), pool(alloc) {}
+    ~BSTree()
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            destroy(root);
+        }
+    }
+    BSTree(const BSTree &) = delete;
+    BSTree &operator=(const BSTree &) = delete;
+
+    // 中序前向迭代器：沿父指针走到后继，不分配内存，可以直接交给 <algorithm>
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() : node(nullptr) {}
+
+        reference operator*() const { return node->data; }
+        pointer operator->() const { return &node->data; }
+
+        const_iterator &operator++()
+        {
+            if (node->right != nullptr)
+            {
+                node = leftmost(node->right);
+            }
+            else
+            {
+                // 从左子树上来的第一个祖先就是后继
+                Node *parent = node->parent;
+                while (parent != nullptr && node == parent->right)
+                {
+                    node = parent;
+                    parent = parent->parent;
+                }
+                node = parent;
+            }
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator &other) const { return node == other.node; }
+        bool operator!=(const const_iterator &other) const { return node != other.node; }
+
+    private:
+        friend class BSTree;
+        Node *node;
+        explicit const_iterator(Node *n) : node(n) {}
+    };
+    using iterator = const_iterator; // 元素决定树的形状，不允许通过迭代器修改
+
+    const_iterator begin() const
+    {
+        return const_iterator(root == nullptr ? nullptr : leftmost(root));
+    }
+    const_iterator end() const
+    {
+        return const_iterator(nullptr);
+    }
 
     void insert(const T &value)
     {
         if (root == nullptr)
         {
-            root = new Node(value);
+            root = createNode(value);
+            return;
+        }
+        if (find(value))
+        {
+            // Value already exists in the tree, do not insert duplicates
             return;
         }
         Node *current = root;
@@ -22,65 +104,64 @@ public:
         while (current != nullptr)
         {
             parent = current;
+            current->size++; // 沿途每棵子树都多一个节点
             if (Compare()(value, current->data))
             {
                 current = current->left;
             }
-            else if (Compare()(current->data, value))
-            {
-                current = current->right;
-            }
             else
             {
-                // Value already exists in the tree, do not insert duplicates
-                return;
+                current = current->right;
             }
         }
 
         if (Compare()(value, parent->data))
         {
-            parent->left = new Node(value);
+            parent->left = createNode(value);
+            parent->left->parent = parent;
         }
         else
         {
-            parent->right = new Node(value);
+            parent->right = createNode(value);
+            parent->right->parent = parent;
         }
     }
 
     void remove(const T &value)
     {
-        if (root == nullptr)
-            return;
+        if (!find(value))
+            return; // Value not found
+        // 值一定存在，沿途每棵子树都少一个节点
         Node *current = root;
         Node *parent = nullptr;
-        while (current != nullptr && current->data != value)
+        while (true)
         {
-            parent = current;
+            current->size--;
             if (Compare()(value, current->data))
             {
+                parent = current;
                 current = current->left;
             }
             else if (Compare()(current->data, value))
             {
+                parent = current;
                 current = current->right;
             }
             else
             {
-                // Value found, proceed to remove it
                 break;
             }
         }
-        if (current == nullptr)
-            return; // Value not found
 
         if (current->left != nullptr && current->right != nullptr)
         {
 
             Node *pre = current->left;
-            Node *parent = current;
+            parent = current;
 
             while (pre->right != nullptr)
             {
+                pre->size--;
                 parent = pre;
                 pre = pre->right;
             }
@@ -89,6 +170,10 @@ public:
         }
 
         Node *child = (current->left != nullptr) ? current->left : current->right;
+        if (child != nullptr)
+        {
+            child->parent = parent;
+        }
 
         if (current == root)
         {
@@ -102,9 +187,10 @@ public:
         {
             parent->right = child;
         }
+        destroyNode(current);
     }
 
-    bool find(const T &value)
+    bool find(const T &value) const
     {
         Node *current = root;
         while (current != nullptr)
@@ -125,17 +211,79 @@ public:
         return false; // Value not found
     }
 
+    size_t size() const
+    {
+        return getSize(root);
+    }
+
+    // 顺序统计：每个节点记录子树大小，以下查询都只走一条根到叶的路径，O(h)
+    // 第k小的元素（k从0开始），越界时返回nullptr；倒数第k个就是 select(size() - k)
+    const T *select(size_t k) const
+    {
+        Node *current = root;
+        while (current != nullptr)
+        {
+            size_t leftSize = getSize(current->left);
+            if (k < leftSize)
+            {
+                current = current->left;
+            }
+            else if (k == leftSize)
+            {
+                return &current->data;
+            }
+            else
+            {
+                k -= leftSize + 1;
+                current = current->right;
+            }
+        }
+        return nullptr;
+    }
+
+    // 小于 value 的元素个数
+    size_t rank(const T &value) const
+    {
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
+        {
+            if (Compare()(current->data, value))
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
+            else
+            {
+                current = current->left;
+            }
+        }
+        return n;
+    }
+
+    // 落在闭区间 [lo, hi] 内的元素个数
+    size_t countRange(const T &lo, const T &hi) const
+    {
+        if (Compare()(hi, lo))
+        {
+            return 0;
+        }
+        return rankUpper(hi) - rank(lo);
+    }
+
     // 递归前序操作
-    void preOrder1(std::function<void(T)> func)
+    template <typename F>
+    void preOrder1(F func) const
     {
         preOrder(root, func);
     }
 
-    void preOrder2(std::function<void(T)> func) // 前序遍历非递归
+    template <typename F>
+    void preOrder2(F func) const // 前序遍历非递归
     {
         if (root == nullptr)
             return;
-        std::stack<Node *> stack;
+        SegmentedStack<Node *> stack;
         stack.push(root);
         while (!stack.empty())
         {
@@ -150,16 +298,18 @@ public:
     }
 
     // 递归中序操作
-    void inOrder1(std::function<void(T)> func)
+    template <typename F>
+    void inOrder1(F func) const
     {
 
         inOrder(root, func);
     }
 
-    void inOrder2(std::function<void(T)> func) // 中序遍历非递归
+    template <typename F>
+    void inOrder2(F func) const // 中序遍历非递归
     {
 
-        std::stack<Node *> stack;
+        SegmentedStack<Node *> stack;
         Node *current = root;
         while (current != nullptr || !stack.empty())
         {
@@ -178,19 +328,21 @@ public:
         }
     }
     // 递归后序操作
-    void postOrder1(std::function<void(T)> func)
+    template <typename F>
+    void postOrder1(F func) const
     {
 
         postOrder(root, func);
     }
 
-    void postOrder2(std::function<void(T)> func) // 后序遍历非递归
+    template <typename F>
+    void postOrder2(F func) const // 后序遍历非递归
     {
 
         if (root == nullptr)
             return;
-        std::stack<Node *> stack;
-        std::stack<Node *> outputStack;
+        SegmentedStack<Node *> stack;
+        SegmentedStack<Node *> outputStack;
         Node *current = root;
 
         stack.push(current);
@@ -213,16 +365,31 @@ public:
         }
     }
 
-    void levelOrder1(std::function<void(T)> func)
+    // 逐层遍历：当前层的节点放一个数组，依次展开出下一层，每个节点只访问一次，O(n)
+    template <typename F>
+    void levelOrder1(F func) const
     {
-        int height = getheight(root);
-        for (int i = 0; i < height; i++)
+        std::vector<Node *> level;
+        std::vector<Node *> next;
+        if (root != nullptr)
+            level.push_back(root);
+        while (!level.empty())
         {
-            levelOrder(root, func, i);
+            for (Node *node : level)
+            {
+                func(node->data);
+                if (node->left != nullptr)
+                    next.push_back(node->left);
+                if (node->right != nullptr)
+                    next.push_back(node->right);
+            }
+            level.swap(next);
+            next.clear();
         }
     }
 
-    void levelOrder2(std::function<void(T)> func)
+    template <typename F>
+    void levelOrder2(F func) const
     {
         if (root == nullptr)
             return;
@@ -245,7 +412,7 @@ public:
         root = remove(root, value);
     }
 
-    bool ischildtree(BSTree<T, Compare> &tree)
+    bool ischildtree(BSTree<T, Compare, Alloc> &tree)
     {
         if (tree.root == nullptr)
         {
@@ -273,15 +440,95 @@ public:
         return childtree(current, tree.root);
     }
 
+    // 一次遍历同时检查有序性、每个节点的 size 和 parent，结果里带上节点数和高度
+    treecheck::TreeReport<Node> validate(bool requireBalanced = false) const
+    {
+        return treecheck::validateTree(static_cast<const Node *>(root), requireBalanced, Compare(), LinkCheck());
+    }
+
+    // 同上，子树拆给任务池并行检查，发现第一处违规后所有任务尽快退出
+    treecheck::TreeReport<Node> validate(TaskPool &pool, bool requireBalanced = false) const
+    {
+        return treecheck::validateTreeParallel(static_cast<const Node *>(root), pool, requireBalanced, Compare(),
+                                               LinkCheck());
+    }
+
+    bool isbstree() const
+    {
+        return validate().ok();
+    }
+
+    bool isbalance() const
+    {
+        return validate(true).ok();
+    }
+
+    // 树的高度：逐层往下数，和 levelOrder1 一样每个节点只访问一次
+    int getheight() const
+    {
+        int height = 0;
+        std::vector<Node *> level;
+        std::vector<Node *> next;
+        if (root != nullptr)
+            level.push_back(root);
+        while (!level.empty())
+        {
+            height++;
+            for (Node *node : level)
+            {
+                if (node->left != nullptr)
+                    next.push_back(node->left);
+                if (node->right != nullptr)
+                    next.push_back(node->right);
+            }
+            level.swap(next);
+            next.clear();
+        }
+        return height;
+    }
+
 private:
     struct Node
     {
         T data;
         Node *left;
         Node *right;
-        Node(T value = T()) : data(value), left(nullptr), right(nullptr) {}
+        Node *parent; // 迭代器靠它找后继
+        size_t size;  // 子树节点数，用于顺序统计
+        Node(T value = T()) : data(value), left(nullptr), right(nullptr), parent(nullptr), size(1) {}
     };
     Node *root;
+    NodePool<Node, Alloc> pool; // 所有节点都从这里分配
+
+    Node *createNode(const T &value)
+    {
+        return new (pool.allocate()) Node(value);
+    }
+
+    static Node *leftmost(Node *node)
+    {
+        while (node->left != nullptr)
+        {
+            node = node->left;
+        }
+        return node;
+    }
+
+    void destroyNode(Node *node)
+    {
+        node->~Node();
+        pool.deallocate(node);
+    }
+
+    // 后序析构整棵树的元素，节点内存由节点池统一释放
+    void destroy(Node *node)
+    {
+        if (node == nullptr)
+            return;
+        destroy(node->left);
+        destroy(node->right);
+        node->~Node();
+    }
 
     Node *getLCA(Node *node, const T &value1, const T &value2)
     {
@@ -340,20 +587,24 @@ private:
     {
         if (node == nullptr)
         {
-            return new Node(value);
+            return createNode(value);
         }
         if (Compare()(value, node->data))
         {
             node->left = insert1(node->left, value);
+            node->left->parent = node;
         }
         else if (Compare()(node->data, value))
         {
             node->right = insert1(node->right, value);
+            node->right->parent = node;
         }
+        node->size = getSize(node->left) + getSize(node->right) + 1;
         return node;
     }
     // 递归前序操作
-    void preOrder(Node *node, std::function<void(T)> func)
+    template <typename F>
+    static void preOrder(Node *node, F &func)
     {
         if (node == nullptr)
             return;
@@ -362,7 +613,8 @@ private:
         preOrder(node->right, func);
     }
     // 递归中序操作
-    void inOrder(Node *node, std::function<void(T)> func)
+    template <typename F>
+    static void inOrder(Node *node, F &func)
     {
         if (node == nullptr)
             return;
@@ -371,7 +623,8 @@ private:
         inOrder(node->right, func);
     }
     // 递归后序操作
-    void postOrder(Node *node, std::function<void(T)> func)
+    template <typename F>
+    static void postOrder(Node *node, F &func)
     {
         if (node == nullptr)
             return;
@@ -380,32 +633,35 @@ private:
         func(node->data);
     }
 
-    // 计算树的高度
-    int getheight(Node *node)
+    // 计算节点数目：直接读子树大小，O(1)
+    int getnumber(Node *node)
     {
-        if (node == nullptr)
-            return 0;
-        return std::max(getheight(node->left), getheight(node->right)) + 1;
+        return (int)getSize(node);
     }
-    // 计算节点数目
-    int getnumber(Node *node)
+
+    size_t getSize(Node *node) const
     {
-        if (node == nullptr)
-            return 0;
-        return getnumber(node->left) + getnumber(node->right) + 1;
+        return node == nullptr ? 0 : node->size;
     }
 
-    // 层序遍历
-    void levelOrder(Node *node, std::function<void(T)> func, int i)
+    // 不大于 value 的元素个数
+    size_t rankUpper(const T &value) const
     {
-        if (node == nullptr)
-            return;
-        if (i == 0)
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
         {
-            func(node->data);
+            if (Compare()(value, current->data))
+            {
+                current = current->left;
+            }
+            else
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
         }
-        levelOrder(node->left, func, i - 1);
-        levelOrder(node->right, func, i - 1);
+        return n;
     }
 
     Node *remove(Node *node, const T &value)
@@ -435,37 +691,27 @@ private:
             else
             {
                 Node *child = (node->left != nullptr) ? node->left : node->right;
-                delete node;
+                if (child != nullptr)
+                {
+                    child->parent = node->parent; // 上一层只把返回值接到 left/right（或 root）上、不碰 parent，只能在这里改
+                }
+                destroyNode(node);
                 return child;
             }
         }
+        node->size = getSize(node->left) + getSize(node->right) + 1;
         return node;
     }
 
-    bool isbstree(Node *node, Node *pre)
-    {
-        if (node == nullptr)
-            return true;
-        if (pre != nullptr && Compare()(node->data, pre->data))
-            return false;
-        return isbstree(node->left, pre) && isbstree(node->right, node);
-    }
-
-    int isbalance(Node *node, bool &flag)
+    // 附加检查：节点缓存的子树大小和孩子的 parent 指针都要对得上，顺序统计和迭代器靠它们
+    struct LinkCheck
     {
-        if (node == nullptr || !flag)
-            return 0;
-
-        int left = isbalance(node->left, flag);
-        int right = isbalance(node->right, flag);
-
-        if (abs(left - right) > 1)
+        bool operator()(const Node *node, size_t size, int) const
         {
-            flag = false;
+            return node->size == size && (node->left == nullptr || node->left->parent == node) &&
+                   (node->right == nullptr || node->right->parent == node);
         }
-
-        return std::max(left, right) + 1;
-    }
+    };
 };
 
 int main()
@@ -504,5 +750,34 @@ int main()
     tree.levelOrder2(print);
     std::cout << std::endl;
 
+    // 顺序统计
+    std::cout << "2nd smallest: " << *tree.select(1) << std::endl; // 4
+    std::cout << "2nd from end: " << *tree.select(tree.size() - 2) << std::endl; // 7
+    std::cout << "rank(6): " << tree.rank(6) << std::endl; // 3
+    std::cout << "count in [4, 7]: " << tree.countRange(4, 7) << std::endl; // 4
+
+    // 迭代器可以直接用于标准算法
+    std::cout << "Iterator: ";
+    for (int value : tree)
+    {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+    std::vector<int> sorted(tree.begin(), tree.end());
+    auto greaterThan5 = [](int v)
+    { return v > 5; };
+    auto isEven = [](int v)
+    { return v % 2 == 0; };
+    std::cout << "Sorted copy size: " << sorted.size() << std::endl;                                  // 6
+    std::cout << "First > 5: " << *std::find_if(tree.begin(), tree.end(), greaterThan5) << std::endl; // 6
+    std::cout << "Count even: " << std::count_if(tree.begin(), tree.end(), isEven) << std::endl;      // 4
+
+    // 一遍校验
+    auto report = tree.validate();
+    std::cout << "isbstree: " << tree.isbstree() << ", isbalance: " << tree.isbalance() << ", height: " << tree.getheight()
+              << ", size: " << report.size << std::endl; // 1, 1, 3, 6
+    TaskPool pool(4);
+    std::cout << "parallel validate: " << tree.validate(pool, true).ok() << std::endl; // 1
+
     return 0;
 }
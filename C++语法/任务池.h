@@ -0,0 +1,188 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取任务池，给分治算法做 fork/join 用。
+// 每个工作线程一个双端队列：自己从尾部压入、弹出（后进先出，刚拆出来的子区间还在缓存里），
+// 空闲线程从别人的头部偷（先进先出，偷到的是最早拆出来的大块任务）。
+// wait() 不会阻塞等待，而是边等边执行队列里的任务，所以任务内部可以继续 spawn/wait，不会死锁。
+// 队列用互斥锁保护：任务粒度由调用方的阈值控制，每个任务至少处理上万个元素，锁开销可以忽略。
+class TaskPool
+{
+public:
+    // 一组任务，wait() 等这一组全部完成
+    class Group
+    {
+    public:
+        Group() : pending(0) {}
+
+    private:
+        friend class TaskPool;
+        std::atomic<size_t> pending;
+    };
+
+    explicit TaskPool(unsigned threads = std::thread::hardware_concurrency())
+        : queues(threads == 0 ? 1 : threads), queued(0), stopping(false)
+    {
+        for (auto &q : queues)
+        {
+            q.reset(new WorkQueue);
+        }
+        // 调用线程占 0 号队列，自己也参与计算，另外再开 threads - 1 个工作线程
+        for (size_t i = 1; i < queues.size(); i++)
+        {
+            workers.emplace_back(&TaskPool::workerLoop, this, i);
+        }
+    }
+    ~TaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (std::thread &t : workers)
+        {
+            t.join();
+        }
+    }
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    size_t threadCount() const
+    {
+        return queues.size();
+    }
+
+    template <typename F>
+    void spawn(Group &group, F func)
+    {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        WorkQueue &q = *queues[currentIndex()];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(Task{std::function<void()>(std::move(func)), &group});
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex); // 防止与正准备睡眠的线程错过通知
+        }
+        wakeup.notify_one();
+    }
+
+    // 等待 group 内任务全部完成，期间帮忙执行任务
+    void wait(Group &group)
+    {
+        size_t self = currentIndex();
+        while (group.pending.load(std::memory_order_acquire) != 0)
+        {
+            if (!runOne(self))
+            {
+                std::this_thread::yield(); // 剩下的任务都在别人手上执行
+            }
+        }
+    }
+
+private:
+    struct Task
+    {
+        std::function<void()> func;
+        Group *group;
+    };
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued; // 所有队列里的任务总数，用来决定是否睡眠
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    bool stopping;
+
+    // 当前线程对应的队列编号，非本池线程一律用 0 号
+    size_t currentIndex() const
+    {
+        return workerPool() == this ? workerIndex() : 0;
+    }
+    static const TaskPool *&workerPool()
+    {
+        thread_local const TaskPool *pool = nullptr;
+        return pool;
+    }
+    static size_t &workerIndex()
+    {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    bool popLocal(size_t self, Task &task)
+    {
+        WorkQueue &q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, Task &task)
+    {
+        for (size_t k = 1; k < queues.size(); k++)
+        {
+            WorkQueue &q = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty())
+            {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool runOne(size_t self)
+    {
+        Task task;
+        if (!popLocal(self, task) && !steal(self, task))
+        {
+            return false;
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        task.func();
+        task.group->pending.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void workerLoop(size_t index)
+    {
+        workerPool() = this;
+        workerIndex() = index;
+        while (true)
+        {
+            if (runOne(index))
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeup.wait(lock, [this]
+                        { return stopping || queued.load(std::memory_order_acquire) != 0; });
+            if (stopping)
+            {
+                return;
+            }
+        }
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <new>
+#include <utility>
+#include <cstddef>
+
+// 分段栈：前 N 个元素放在对象内部（浅栈完全不分配堆内存），超出后按 SEGMENT 个元素一段向后挂链表。
+//   1. 扩容只是挂一段新的，已有元素不搬动，也没有 vector 翻倍时那一次 O(n) 的拷贝，栈顶元素的地址一直有效；
+//   2. 每段是一块连续内存，push/pop 只是指针加减，比每个元素一个节点的链式栈少了 new/delete 和指针追逐；
+//   3. 一段弹空后不立即释放，留一段备用，栈深度在段边界来回抖动时不会反复分配。
+// 接口和 std::stack 一致（push/pop/top/empty/size），可以直接替换深度优先遍历里的 std::stack。
+template <typename T, int N = 32, int SEGMENT = 256>
+class SegmentedStack
+{
+    static_assert(N > 0 && SEGMENT > 0, "内联区和每段至少放一个元素");
+
+public:
+    SegmentedStack() : base_(inlineData()), cur_(base_), end_(base_ + N), segment_(nullptr), spare_(nullptr), size_(0)
+    {
+    }
+
+    ~SegmentedStack()
+    {
+        clear();
+        delete spare_;
+    }
+
+    SegmentedStack(const SegmentedStack &) = delete;
+    SegmentedStack &operator=(const SegmentedStack &) = delete;
+
+    void push(const T &value)
+    {
+        emplace(value);
+    }
+
+    void push(T &&value)
+    {
+        emplace(std::move(value));
+    }
+
+    template <typename... Args>
+    T &emplace(Args &&...args)
+    {
+        if (cur_ == end_)
+        {
+            grow();
+            try
+            {
+                return construct(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                shrink(); // 构造失败时退回上一段，不然新段空着而 pop 不会经过 shrink
+                throw;
+            }
+        }
+        return construct(std::forward<Args>(args)...);
+    }
+
+    void pop()
+    {
+        --cur_;
+        cur_->~T();
+        --size_;
+        if (cur_ == base_ && segment_ != nullptr)
+        {
+            shrink(); // 当前段空了，退回上一段，栈顶总在 cur_[-1]
+        }
+    }
+
+    T &top() { return cur_[-1]; }
+    const T &top() const { return cur_[-1]; }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    void clear()
+    {
+        while (size_ != 0)
+        {
+            pop();
+        }
+    }
+
+private:
+    struct Segment
+    {
+        Segment *prev;
+        alignas(T) unsigned char storage[SEGMENT * sizeof(T)];
+
+        T *data() { return reinterpret_cast<T *>(storage); }
+    };
+
+    T *inlineData() { return reinterpret_cast<T *>(inline_); }
+
+    template <typename... Args>
+    T &construct(Args &&...args)
+    {
+        T *p = new (cur_) T(std::forward<Args>(args)...);
+        ++cur_;
+        ++size_;
+        return *p;
+    }
+
+    void grow()
+    {
+        Segment *s = spare_ != nullptr ? spare_ : new Segment;
+        spare_ = nullptr;
+        s->prev = segment_;
+        segment_ = s;
+        base_ = s->data();
+        cur_ = base_;
+        end_ = base_ + SEGMENT;
+    }
+
+    void shrink()
+    {
+        Segment *s = segment_;
+        segment_ = s->prev;
+        delete spare_;
+        spare_ = s;
+        if (segment_ != nullptr)
+        {
+            base_ = segment_->data();
+            end_ = base_ + SEGMENT;
+        }
+        else
+        {
+            base_ = inlineData();
+            end_ = base_ + N;
+        }
+        cur_ = end_; // 上一块一定是满的
+    }
+
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+    T *base_;          // 当前块的起点
+    T *cur_;           // 当前块里下一个空位
+    T *end_;           // 当前块的终点
+    Segment *segment_; // 当前段，还在内联区时为空
+    Segment *spare_;   // 弹空后留着备用的一段
+    size_t size_;
+};
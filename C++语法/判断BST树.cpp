@@ -1,5 +1,11 @@
 #include <iostream>
 #include <climits>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include "树校验.h"
 
 template <typename T, typename Compare = std::less<T>>
 class BSTChecker
@@ -13,7 +19,26 @@ public:
         Node(T val) : data(val), left(nullptr), right(nullptr) {}
     };
 
+    // 非递归一遍校验，深度再大也不会爆栈
     bool isBST(Node *root)
+    {
+        return treecheck::validateTree(static_cast<const Node *>(root), false, comp).ok();
+    }
+
+    // 子树拆给任务池并行检查，发现第一处违规后所有任务尽快退出
+    bool isBST(Node *root, TaskPool &pool)
+    {
+        return treecheck::validateTreeParallel(static_cast<const Node *>(root), pool, false, comp).ok();
+    }
+
+    // 完整报告：节点数、高度、是否平衡，出错时给出第一个违规的节点
+    treecheck::TreeReport<Node> audit(Node *root, bool requireBalanced = false)
+    {
+        return treecheck::validateTree(static_cast<const Node *>(root), requireBalanced, comp);
+    }
+
+    // 原来的递归中序版本，留作对照
+    bool isBSTRecursive(Node *root)
     {
         Node *prev = nullptr; // 用于记录中序遍历的前驱节点
         return isBSTUtil(root, prev);
@@ -46,3 +71,96 @@ private:
         return isBSTUtil(node->right, prev);
     }
 };
+
+typedef BSTChecker<int> Checker;
+
+// 用 [lo, hi) 的值建一棵完全平衡的树，节点放在 arena 里；深度只有 log2(n)
+static Checker::Node *buildBalanced(std::vector<Checker::Node> &arena, int lo, int hi)
+{
+    if (lo >= hi)
+    {
+        return nullptr;
+    }
+    int mid = lo + (hi - lo) / 2;
+    arena.emplace_back(mid);
+    Checker::Node *node = &arena.back();
+    node->left = buildBalanced(arena, lo, mid);
+    node->right = buildBalanced(arena, mid + 1, hi);
+    return node;
+}
+
+template <typename F>
+static double timeMs(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[])
+{
+    Checker checker;
+    Checker::Node a(2), b(1), c(3);
+    a.left = &b;
+    a.right = &c;
+    std::cout << "2(1,3) 是 BST: " << checker.isBST(&a) << std::endl;
+    c.data = 0;
+    auto bad = checker.audit(&a);
+    std::cout << "2(1,0) 是 BST: " << bad.ok() << "，违规节点 " << bad.where->data << std::endl;
+
+    // 用法: ./a.out [节点数] [线程数]
+    int n = std::max(1, argc > 1 ? atoi(argv[1]) : 4000000);
+    unsigned threads = argc > 2 ? (unsigned)atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    TaskPool pool(threads);
+
+    std::vector<Checker::Node> arena;
+    arena.reserve(n); // 预留好，节点地址不会变
+    Checker::Node *root = buildBalanced(arena, 0, n);
+    bool ok = false;
+    std::cout << n << " 个节点的平衡树, " << pool.threadCount() << " 线程" << std::endl;
+    double ms = timeMs([&]
+                       { ok = checker.isBSTRecursive(root); });
+    std::cout << "  递归中序         " << ms << " ms  " << ok << std::endl;
+    ms = timeMs([&]
+                { ok = checker.isBST(root); });
+    std::cout << "  非递归一遍       " << ms << " ms  " << ok << std::endl;
+    ms = timeMs([&]
+                { ok = checker.isBST(root, pool); });
+    std::cout << "  并行             " << ms << " ms  " << ok << std::endl;
+    treecheck::TreeReport<Checker::Node> report;
+    ms = timeMs([&]
+                { report = checker.audit(root, true); });
+    std::cout << "  完整报告         " << ms << " ms  size " << report.size << " height " << report.height
+              << " 平衡 " << report.ok() << std::endl;
+
+    // 在树的最右端放一个错误的值：递归版本要走完整棵树才能发现，并行版本负责那棵子树的任务一发现就全部停下
+    Checker::Node *last = root;
+    while (last->right != nullptr)
+    {
+        last = last->right;
+    }
+    last->data = -1;
+    std::cout << "最右端的节点值错误" << std::endl;
+    ms = timeMs([&]
+                { ok = checker.isBSTRecursive(root); });
+    std::cout << "  递归中序         " << ms << " ms  " << ok << std::endl;
+    ms = timeMs([&]
+                { ok = checker.isBST(root, pool); });
+    std::cout << "  并行             " << ms << " ms  " << ok << std::endl;
+
+    // 退化成链：递归版本会爆栈，这里只跑非递归版本
+    std::vector<Checker::Node> chain;
+    chain.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+        chain.emplace_back(i);
+        if (i > 0)
+        {
+            chain[i - 1].right = &chain[i];
+        }
+    }
+    ms = timeMs([&]
+                { report = checker.audit(&chain[0]); });
+    std::cout << n << " 个节点的链  非递归 " << ms << " ms  height " << report.height << std::endl;
+    return 0;
+}
@@ -1,6 +1,12 @@
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "分段栈.h"
 
 using namespace std;
 
@@ -13,6 +19,16 @@ struct TreeNode
     TreeNode(int x) : val(x), left(nullptr), right(nullptr) {}
 };
 
+// 下标表示的二叉树：节点 i 就是前序遍历里的第 i 个节点，val 就是前序序列本身，-1 表示空孩子
+// 三个数组各自连续，没有指针，可以直接整块写盘或者发给别的进程
+struct IndexTree
+{
+    vector<int> val;
+    vector<int> left;
+    vector<int> right;
+    int root;
+};
+
 class Solution
 {
 public:
@@ -27,9 +43,73 @@ public:
                      inorder, 0, inorder.size() - 1);
     }
 
+    // 非递归版本：不用哈希表，所有节点放在 arena 里（按前序顺序连续存放），返回根节点
+    // arena 的生命周期就是整棵树的生命周期，不用再逐个 delete
+    TreeNode *buildTreeIterative(const vector<int> &preorder, const vector<int> &inorder, vector<TreeNode> &arena)
+    {
+        arena.clear();
+        arena.reserve(preorder.size()); // 先预留好，之后 emplace_back 不会搬家，节点地址一直有效
+        for (int v : preorder)
+        {
+            arena.emplace_back(v);
+        }
+        link(preorder, inorder, [&arena](int parent, int child, bool isRight)
+             { (isRight ? arena[parent].right : arena[parent].left) = &arena[child]; });
+        return arena.empty() ? nullptr : &arena[0];
+    }
+
+    // 同样的算法，结果直接写成下标数组
+    IndexTree buildIndexTree(const vector<int> &preorder, const vector<int> &inorder)
+    {
+        IndexTree tree;
+        tree.val = preorder;
+        tree.left.assign(preorder.size(), -1);
+        tree.right.assign(preorder.size(), -1);
+        tree.root = preorder.empty() ? -1 : 0;
+        link(preorder, inorder, [&tree](int parent, int child, bool isRight)
+             { (isRight ? tree.right : tree.left)[parent] = child; });
+        return tree;
+    }
+
 private:
     unordered_map<int, int> in_map; // 存储中序遍历的值和索引的映射
 
+    // 按前序顺序逐个处理节点，栈里是"左子树还没走完"的祖先链：
+    //   栈顶的值和中序当前位置不同，说明栈顶的左子树还没结束，新节点是它的左孩子；
+    //   相同，说明栈顶的左子树已经结束，沿中序往后弹出所有左子树已结束的祖先，新节点是最后弹出那个的右孩子。
+    // 每个节点进出栈各一次，整体 O(n)；栈是堆上的分段栈，退化成链的树也不会爆调用栈。要求节点值互不相同
+    template <typename Link>
+    static void link(const vector<int> &preorder, const vector<int> &inorder, Link linkChild)
+    {
+        int n = (int)preorder.size();
+        if (n == 0 || inorder.size() != preorder.size())
+        {
+            return;
+        }
+        SegmentedStack<int> stack;
+        stack.push(0);
+        size_t in = 0;
+        for (int i = 1; i < n; i++)
+        {
+            int parent = stack.top();
+            if (preorder[parent] != inorder[in])
+            {
+                linkChild(parent, i, false);
+            }
+            else
+            {
+                while (!stack.empty() && in < inorder.size() && preorder[stack.top()] == inorder[in])
+                {
+                    parent = stack.top();
+                    stack.pop();
+                    in++;
+                }
+                linkChild(parent, i, true);
+            }
+            stack.push(i);
+        }
+    }
+
     TreeNode *build(vector<int> &preorder, int pre_start, int pre_end,
                     vector<int> &inorder, int in_start, int in_end)
     {
@@ -82,7 +162,147 @@ void printInorder(TreeNode *root)
     printInorder(root->right);
 }
 
-int main()
+// 非递归的前序、中序遍历，用来验证百万节点、深度也是百万的树
+static bool sameTraversals(TreeNode *root, const vector<int> &preorder, const vector<int> &inorder)
+{
+    vector<int> pre, in;
+    SegmentedStack<TreeNode *> stack;
+    TreeNode *p = root;
+    while (p != nullptr || !stack.empty())
+    {
+        while (p != nullptr)
+        {
+            pre.push_back(p->val);
+            stack.push(p);
+            p = p->left;
+        }
+        p = stack.top();
+        stack.pop();
+        in.push_back(p->val);
+        p = p->right;
+    }
+    return pre == preorder && in == inorder;
+}
+
+static bool sameTree(const IndexTree &tree, TreeNode *root)
+{
+    SegmentedStack<pair<int, TreeNode *>> stack;
+    stack.push({tree.root, root});
+    while (!stack.empty())
+    {
+        pair<int, TreeNode *> top = stack.top();
+        stack.pop();
+        if ((top.first < 0) != (top.second == nullptr))
+        {
+            return false;
+        }
+        if (top.first < 0)
+        {
+            continue;
+        }
+        if (tree.val[top.first] != top.second->val)
+        {
+            return false;
+        }
+        stack.push({tree.left[top.first], top.second->left});
+        stack.push({tree.right[top.first], top.second->right});
+    }
+    return true;
+}
+
+static void deleteTree(TreeNode *root)
+{
+    if (!root)
+        return;
+    deleteTree(root->left);
+    deleteTree(root->right);
+    delete root;
+}
+
+// 生成 n 个节点的树的前序、中序序列，节点值是打乱的 0..n-1
+// skewed 时每个节点都是上一个的左孩子，深度为 n；否则每个新节点挂到随机一个还有空位的节点下，深度 O(log n)
+static void makeTraversals(int n, bool skewed, vector<int> &preorder, vector<int> &inorder)
+{
+    mt19937 rng(n);
+    vector<int> values(n);
+    iota(values.begin(), values.end(), 0);
+    shuffle(values.begin(), values.end(), rng);
+    vector<int> left(n, -1), right(n, -1);
+    for (int i = 1; i < n; i++)
+    {
+        if (skewed)
+        {
+            left[i - 1] = i;
+            continue;
+        }
+        while (true)
+        {
+            int p = (int)(rng() % i);
+            vector<int> &first = rng() & 1 ? left : right; // 随机先试左边还是右边
+            vector<int> &second = &first == &left ? right : left;
+            if (first[p] < 0 || second[p] < 0)
+            {
+                (first[p] < 0 ? first : second)[p] = i;
+                break;
+            }
+        }
+    }
+    preorder.clear();
+    inorder.clear();
+    SegmentedStack<int> stack;
+    int p = n > 0 ? 0 : -1;
+    while (p >= 0 || !stack.empty())
+    {
+        while (p >= 0)
+        {
+            preorder.push_back(values[p]);
+            stack.push(p);
+            p = left[p];
+        }
+        p = stack.top();
+        stack.pop();
+        inorder.push_back(values[p]);
+        p = right[p];
+    }
+}
+
+template <typename F>
+static double timeMs(F f)
+{
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static void bench(int n, bool skewed)
+{
+    vector<int> preorder, inorder;
+    makeTraversals(n, skewed, preorder, inorder);
+    cout << n << " 个节点" << (skewed ? "，退化成链" : "，随机形状") << endl;
+    if (!skewed) // 递归版本在链上会爆栈，只测随机形状
+    {
+        TreeNode *root = nullptr;
+        double ms = timeMs([&]
+                           {
+                               Solution solution;
+                               root = solution.buildTree(preorder, inorder);
+                           });
+        cout << "  递归 + 哈希表 + new   " << ms << " ms" << endl;
+        deleteTree(root);
+    }
+    Solution solution;
+    vector<TreeNode> arena;
+    TreeNode *root = nullptr;
+    double ms = timeMs([&]
+                       { root = solution.buildTreeIterative(preorder, inorder, arena); });
+    cout << "  非递归 + arena        " << ms << " ms" << (sameTraversals(root, preorder, inorder) ? "" : "  结果错误") << endl;
+    IndexTree tree;
+    ms = timeMs([&]
+                { tree = solution.buildIndexTree(preorder, inorder); });
+    cout << "  非递归 + 下标数组     " << ms << " ms" << (sameTree(tree, root) ? "" : "  结果错误") << endl;
+}
+
+int main(int argc, char *argv[])
 {
     vector<int> preorder = {3, 9, 20, 15, 7};
     vector<int> inorder = {9, 3, 15, 20, 7};
@@ -98,5 +318,23 @@ int main()
     printInorder(root);
     cout << endl;
 
+    vector<TreeNode> arena;
+    TreeNode *root2 = solution.buildTreeIterative(preorder, inorder, arena);
+    cout << "非递归重建后的前序遍历: ";
+    printPreorder(root2);
+    cout << endl;
+
+    IndexTree tree = solution.buildIndexTree(preorder, inorder);
+    cout << "下标数组 (值/左/右): ";
+    for (size_t i = 0; i < tree.val.size(); i++)
+    {
+        cout << tree.val[i] << "/" << tree.left[i] << "/" << tree.right[i] << " ";
+    }
+    cout << endl;
+    deleteTree(root);
+
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    bench(n, false);
+    bench(n, true);
     return 0;
 }
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <memory>
+#include "节点池.h"
 
 struct node
 {
@@ -7,33 +9,28 @@ struct node
     struct node *next;
 };
 
+// 节点从 NodePool 分配，同一批插入的节点在内存里连续，删除的节点会被复用
 class list
 {
 
 public:
     list()
     {
-        head = new node;
+        head = createNode();
 
         tail = head;
         head->next = head;
     };
     ~list()
     {
-        node *p = head->next;
-        while (p != head)
-        {
-            node *q = p->next;
-            delete p;
-            p = q;
-        }
+        // node 可平凡析构，所有节点（包括头结点）随节点池整块释放
         head = nullptr;
         tail = nullptr;
     };
 
     void inserttail(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         p->next = head;
         tail->next = p;
         tail = p;
@@ -41,7 +38,7 @@ public:
 
     void inserthead(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         p->next = head->next;
         head->next = p;
         if (tail == head)
@@ -59,7 +56,7 @@ public:
             if (q->data == a)
             {
                 p->next = q->next;
-                delete q;
+                freeNode(q);
                 if (p->next == head)
                 {
                     tail = p;
@@ -101,10 +98,21 @@ public:
         std::cout << std::endl;
     }
 
-public:
 private:
+    NodePool<node, std::allocator<node>> pool; // 所有节点都从这里分配
     struct node *head;
     struct node *tail;
+
+    node *createNode(int a = 0)
+    {
+        return new (pool.allocate()) node(a);
+    }
+
+    void freeNode(node *p)
+    {
+        p->~node();
+        pool.deallocate(p);
+    }
 };
 
 int main()
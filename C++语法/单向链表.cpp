@@ -1,4 +1,7 @@
 #include <iostream>
+#include <memory>
+#include <chrono>
+#include "节点池.h"
 
 struct node
 {
@@ -7,40 +10,36 @@ struct node
     struct node *next;
 };
 
+// 节点从 NodePool 分配：同一批插入的节点在内存里连续，遍历更容易命中缓存，删除的节点也会被复用
+// tail 指向最后一个节点（空表时指向头结点），尾插是 O(1)，不用每次从头走到尾
 class list
 {
 
 public:
-    list() : head(new node()) {};
+    list() : head(createNode()), tail(head) {};
     ~list()
     {
-        node *p = head;
-        while (p != nullptr)
-        {
-            node *q = p->next;
-            delete p;
-            p = q;
-        }
+        // node 可平凡析构，所有节点随节点池整块释放
         head = nullptr;
+        tail = nullptr;
     };
 
 public:
     void inserttail(int a)
     {
-        node *p = head;
-
-        while (p->next != nullptr)
-        {
-            p = p->next;
-        }
-        p->next = new node(a);
+        tail->next = createNode(a);
+        tail = tail->next;
     }
 
     void inserthead(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         p->next = head->next;
         head->next = p;
+        if (tail == head)
+        {
+            tail = p;
+        }
     }
 
     void Remove(int a)
@@ -52,7 +51,11 @@ public:
             {
                 node *q = p->next;
                 p->next = q->next;
-                delete q;
+                if (q == tail)
+                {
+                    tail = p;
+                }
+                freeNode(q);
                 break;
             }
             else
@@ -70,7 +73,11 @@ public:
             {
                 node *q = p->next;
                 p->next = q->next;
-                delete q;
+                if (q == tail)
+                {
+                    tail = p;
+                }
+                freeNode(q);
             }
             else
             {
@@ -98,6 +105,10 @@ public:
     void reverse1()
     {
         node *p = head->next;
+        if (p != nullptr)
+        {
+            tail = p; // 原来的第一个节点变成最后一个
+        }
         node *q = nullptr;
         while (p != nullptr)
         {
@@ -117,6 +128,7 @@ public:
             return;
         }
 
+        tail = p;
         head->next = nullptr;
         while (p != nullptr)
         {
@@ -139,7 +151,20 @@ public:
     }
 
 private:
+    NodePool<node, std::allocator<node>> pool; // 先于 head 构造，所有节点都从这里分配
     struct node *head;
+    struct node *tail;
+
+    node *createNode(int a = 0)
+    {
+        return new (pool.allocate()) node(a);
+    }
+
+    void freeNode(node *p)
+    {
+        p->~node();
+        pool.deallocate(p);
+    }
 };
 
 int main()
@@ -154,6 +179,21 @@ int main()
     l.reverse2();
 
     l.showlist();
+    l.inserttail(6); // 反转后 tail 指向原来的第一个节点
+    l.showlist();
+
+    // 尾插 n 个节点：n 翻倍时用时也大致翻倍
+    for (int n = 1000000; n <= 4000000; n *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        list big;
+        for (int i = 0; i < n; i++)
+        {
+            big.inserttail(i);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "尾插 " << n << " 个节点: " << ms << " ms" << std::endl;
+    }
 
     std::cout << "---------E-N-D---------" << std::endl;
     return 0;
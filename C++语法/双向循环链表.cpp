@@ -1,4 +1,6 @@
 #include <iostream>
+#include <memory>
+#include "节点池.h"
 
 struct node
 {
@@ -9,44 +11,34 @@ struct node
     struct node *prev;
 };
 
+// 节点从 NodePool 分配；尾节点就是 head->prev，尾插本来就是 O(1)
 class DoubeleList
 {
 public:
     DoubeleList()
     {
-        head = new node;
+        head = createNode();
         head->next = head;
         head->prev = head;
     }
     ~DoubeleList()
     {
-        node *p = head->next;
-        while (p != head)
-        {
-            node *q = p->next;
-            if (q != nullptr)
-            {
-                q->prev = head;
-            }
-            delete p;
-            p = q;
-        }
-        delete head;
+        // node 可平凡析构，所有节点（包括头结点）随节点池整块释放
         head = nullptr;
     }
 
 public:
     void inserthead(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         p->next = head->next;
         head->next = p;
-        head->next->prev = p;
+        p->next->prev = p; // 原来的第一个节点（空表时是头结点）的 prev 指向新节点
         p->prev = head;
     }
     void inserttail(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         node *q = head->prev;
         q->next = p;
         p->prev = q;
@@ -62,7 +54,7 @@ public:
             {
                 p->prev->next = p->next;
                 p->next->prev = p->prev;
-                delete p;
+                freeNode(p);
                 return;
             }
             else
@@ -84,7 +76,19 @@ public:
     }
 
 private:
+    NodePool<node, std::allocator<node>> pool; // 所有节点都从这里分配
     struct node *head;
+
+    node *createNode(int a = 0)
+    {
+        return new (pool.allocate()) node(a);
+    }
+
+    void freeNode(node *p)
+    {
+        p->~node();
+        pool.deallocate(p);
+    }
 };
 
 int main()
@@ -96,6 +100,8 @@ int main()
     }
 
     l.erase(0);
+    l.inserthead(-1);
+    l.inserttail(10);
 
     l.show();
     std::cout << "---------E-N-D---------" << std::endl;
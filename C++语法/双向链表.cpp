@@ -1,4 +1,6 @@
 #include <iostream>
+#include <memory>
+#include "节点池.h"
 
 struct node
 {
@@ -9,48 +11,45 @@ struct node
     struct node *prev;
 };
 
+// 节点从 NodePool 分配，tail 指向最后一个节点（空表时指向头结点），尾插是 O(1)
 class DoubeleList
 {
 public:
     DoubeleList()
     {
-        head = new node;
+        head = createNode();
+        tail = head;
     }
     ~DoubeleList()
     {
-        node *p = head->next;
-        while (p != nullptr)
-        {
-            node *q = p->next;
-            delete p;
-            p = q;
-        }
+        // node 可平凡析构，所有节点随节点池整块释放
         head = nullptr;
+        tail = nullptr;
     }
 
 public:
     void inserthead(int a)
     {
-        node *p = new node(a);
+        node *p = createNode(a);
         p->next = head->next;
         head->next = p;
         if (p->next != nullptr)
         {
             p->next->prev = p;
         }
+        else
+        {
+            tail = p;
+        }
         p->prev = head;
     }
 
     void inserttail(int a)
     {
-        node *p = new node(a);
-        node *q = head;
-        while (q->next != nullptr)
-        {
-            q = q->next;
-        }
-        q->next = p;
-        p->prev = q;
+        node *p = createNode(a);
+        tail->next = p;
+        p->prev = tail;
+        tail = p;
     }
     void erase(int a)
     {
@@ -65,7 +64,11 @@ public:
                 {
                     p->next->prev = q;
                 }
-                delete p;
+                else
+                {
+                    tail = q;
+                }
+                freeNode(p);
 
                 return;
             }
@@ -89,7 +92,20 @@ public:
     }
 
 private:
+    NodePool<node, std::allocator<node>> pool; // 所有节点都从这里分配
     struct node *head;
+    struct node *tail;
+
+    node *createNode(int a = 0)
+    {
+        return new (pool.allocate()) node(a);
+    }
+
+    void freeNode(node *p)
+    {
+        p->~node();
+        pool.deallocate(p);
+    }
 };
 
 int main()
@@ -102,6 +118,7 @@ int main()
     l.inserttail(5);
 
     l.erase(5);
+    l.inserttail(6); // 删掉尾节点后 tail 退回前一个
 
     l.show();
 
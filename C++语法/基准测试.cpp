@@ -0,0 +1,477 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "微基准.h"
+#include "排序.h"
+#include "堆排序.h"
+#include "基数排序算法.h"
+#include "二分查找.h"
+#include "链式哈希表.h"
+#include "线性哈希表.h"
+#include "红黑树.h"
+#include "AVL树.h"
+#include "大根堆小根队.h"
+#include "数组环形队列.h"
+#include "运行统计.h"
+
+// 仓库里各个数据结构和排序的统一微基准，每组都和标准库的对应实现放在一起比较。
+// 参数是 /元素个数/分布，分布的名字在最后一列；计数器一列是每个元素（每次查询）平均下来的值。
+// 用法: ./microbench [--filter=子串] [--min-time=秒] [--csv]，例如 --filter=Sort/1048576 只跑百万元素的排序
+//       cmake 构建时 `cmake --build build --target bench` 直接跑全部；-DNOTES_STATS=ON 构建的版本跑完还会输出运行统计
+
+using microbench::State;
+using microbench::doNotOptimize;
+
+enum Distribution
+{
+    RANDOM,     // 均匀随机，可能有重复
+    SORTED,     // 已经升序
+    REVERSED,   // 降序
+    FEW_UNIQUE  // 只有 16 种取值
+};
+
+static const char *distributionName(int64_t d)
+{
+    static const char *names[] = {"random", "sorted", "reversed", "few-unique"};
+    return names[d];
+}
+
+static std::vector<int> makeData(size_t n, int64_t dist, unsigned seed = 42)
+{
+    std::mt19937 rng(seed);
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        switch (dist)
+        {
+        case SORTED:
+            data[i] = (int)i;
+            break;
+        case REVERSED:
+            data[i] = (int)(n - i);
+            break;
+        case FEW_UNIQUE:
+            data[i] = (int)(rng() % 16);
+            break;
+        default:
+            data[i] = (int)rng();
+            break;
+        }
+    }
+    return data;
+}
+
+// 哈希表和树用的互不相同的键：SEQUENTIAL 是 0..n-1 顺序插入，SCATTERED 乘一个奇数打散到整个 int 范围再打乱顺序
+enum KeyOrder
+{
+    SEQUENTIAL,
+    SCATTERED
+};
+
+static std::vector<int> makeKeys(size_t n, int64_t order)
+{
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        keys[i] = order == SEQUENTIAL ? (int)i : (int)((uint32_t)i * 2654435761u);
+    }
+    if (order == SCATTERED)
+    {
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    }
+    return keys;
+}
+
+// 查找时换一个顺序，不让查找顺序和插入顺序一样沾插入时的缓存局部性
+static std::vector<int> lookupOrder(std::vector<int> keys)
+{
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(99));
+    return keys;
+}
+
+static const char *keyOrderName(int64_t order)
+{
+    return order == SEQUENTIAL ? "sequential" : "scattered";
+}
+
+// ---------------- 排序 ----------------
+
+// 每轮先把原始数据拷回来（不计时），再排序
+template <typename Sort>
+static void runSort(State &state, Sort sort)
+{
+    size_t n = (size_t)state.range(0);
+    std::vector<int> input = makeData(n, state.range(1));
+    std::vector<int> work(n);
+    for (auto _ : state)
+    {
+        state.pauseTiming();
+        std::copy(input.begin(), input.end(), work.begin());
+        state.resumeTiming();
+        sort(work);
+        doNotOptimize(work.data());
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)n);
+    state.setLabel(distributionName(state.range(1)));
+}
+
+static void bmStdSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { std::sort(v.begin(), v.end()); });
+}
+
+static void bmSortingSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { sorting::sort(v.begin(), v.end()); });
+}
+
+static void bmIntroSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { sorting::introSort(v.begin(), v.end()); });
+}
+
+static void bmStdStableSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { std::stable_sort(v.begin(), v.end()); });
+}
+
+static void bmStableSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { sorting::stableSort(v.begin(), v.end()); });
+}
+
+static void bmHeapSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { heapSort(v.begin(), v.end()); });
+}
+
+static void bmRadixSort(State &state)
+{
+    runSort(state, [](std::vector<int> &v)
+            { radixSort(v); });
+}
+
+static const std::vector<std::vector<int64_t>> SORT_ARGS = {{1 << 10, 1 << 16, 1 << 20}, {RANDOM, SORTED, REVERSED, FEW_UNIQUE}};
+MICROBENCH(bmStdSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmSortingSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmIntroSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmStdStableSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmStableSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmHeapSort)->argsProduct(SORT_ARGS);
+MICROBENCH(bmRadixSort)->argsProduct(SORT_ARGS);
+
+// ---------------- 二分查找 ----------------
+
+// n 个偶数组成的有序数组，查询在 [0, 2n) 里均匀随机，命中和落空各占一半；每轮 QUERIES 次查询
+static const size_t QUERIES = 4096;
+
+template <typename Search>
+static void runSearch(State &state, Search search)
+{
+    size_t n = (size_t)state.range(0);
+    std::vector<int> sorted(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        sorted[i] = (int)(2 * i);
+    }
+    std::mt19937 rng(5);
+    std::vector<int> keys(QUERIES);
+    for (int &key : keys)
+    {
+        key = (int)(rng() % (2 * n));
+    }
+    std::vector<size_t> out(QUERIES);
+    auto prepared = search(sorted); // 需要预处理的（Eytzinger）在这里建好，不计时
+    for (auto _ : state)
+    {
+        prepared(keys.data(), out.data());
+        doNotOptimize(out.data());
+        microbench::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)QUERIES);
+}
+
+static void bmStdLowerBound(State &state)
+{
+    runSearch(state, [](const std::vector<int> &sorted)
+              {
+                  return [&sorted](const int *keys, size_t *out)
+                  {
+                      for (size_t i = 0; i < QUERIES; i++)
+                      {
+                          out[i] = std::lower_bound(sorted.begin(), sorted.end(), keys[i]) - sorted.begin();
+                      }
+                  };
+              });
+}
+
+static void bmLowerBound(State &state)
+{
+    runSearch(state, [](const std::vector<int> &sorted)
+              {
+                  return [&sorted](const int *keys, size_t *out)
+                  {
+                      for (size_t i = 0; i < QUERIES; i++)
+                      {
+                          out[i] = searching::lowerBound(sorted.data(), sorted.size(), keys[i]);
+                      }
+                  };
+              });
+}
+
+static void bmLowerBoundBatch(State &state)
+{
+    runSearch(state, [](const std::vector<int> &sorted)
+              {
+                  return [&sorted](const int *keys, size_t *out)
+                  { searching::lowerBoundBatch(sorted.data(), sorted.size(), keys, QUERIES, out); };
+              });
+}
+
+static void bmEytzingerBatch(State &state)
+{
+    runSearch(state, [](const std::vector<int> &sorted)
+              {
+                  std::shared_ptr<searching::Eytzinger<int>> tree =
+                      std::make_shared<searching::Eytzinger<int>>(sorted.data(), sorted.size());
+                  return [tree](const int *keys, size_t *out)
+                  { tree->lowerBoundBatch(keys, QUERIES, out); };
+              });
+}
+
+static const std::vector<int64_t> SEARCH_SIZES = {1 << 10, 1 << 16, 1 << 22};
+MICROBENCH(bmStdLowerBound)->argsProduct({SEARCH_SIZES});
+MICROBENCH(bmLowerBound)->argsProduct({SEARCH_SIZES});
+MICROBENCH(bmLowerBoundBatch)->argsProduct({SEARCH_SIZES});
+MICROBENCH(bmEytzingerBatch)->argsProduct({SEARCH_SIZES});
+
+// ---------------- 哈希表 ----------------
+
+// 每轮从空表开始插入 n 个键，表的析构也算在内
+template <typename Table, typename Insert>
+static void runInsert(State &state, Insert insert)
+{
+    std::vector<int> keys = makeKeys((size_t)state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        Table table;
+        for (int key : keys)
+        {
+            insert(table, key);
+        }
+        doNotOptimize(table);
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)keys.size());
+    state.setLabel(keyOrderName(state.range(1)));
+}
+
+// 建好表后每轮按打乱的顺序把 n 个键都查一遍，全部命中
+template <typename Table, typename Insert, typename Find>
+static void runFind(State &state, Insert insert, Find find)
+{
+    std::vector<int> keys = makeKeys((size_t)state.range(0), state.range(1));
+    Table table;
+    for (int key : keys)
+    {
+        insert(table, key);
+    }
+    std::vector<int> lookups = lookupOrder(keys);
+    for (auto _ : state)
+    {
+        size_t hits = 0;
+        for (int key : lookups)
+        {
+            hits += find(table, key);
+        }
+        doNotOptimize(hits);
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)keys.size());
+    state.setLabel(keyOrderName(state.range(1)));
+}
+
+static void insertUnordered(std::unordered_map<int, int> &table, int key) { table.emplace(key, key); }
+static bool findUnordered(const std::unordered_map<int, int> &table, int key) { return table.find(key) != table.end(); }
+static void insertChained(HashTable<int, int> &table, int key) { table.insert(key, key); }
+static bool findChained(HashTable<int, int> &table, int key) { return table.find(key) != nullptr; }
+static void insertLinear(LinearProbingHashTable &table, int key) { table.insert(key); }
+static bool findLinear(const LinearProbingHashTable &table, int key) { return table.find(key); }
+
+static void bmUnorderedMapInsert(State &state) { runInsert<std::unordered_map<int, int>>(state, insertUnordered); }
+static void bmHashTableInsert(State &state) { runInsert<HashTable<int, int>>(state, insertChained); }
+static void bmLinearProbingInsert(State &state) { runInsert<LinearProbingHashTable>(state, insertLinear); }
+static void bmUnorderedMapFind(State &state) { runFind<std::unordered_map<int, int>>(state, insertUnordered, findUnordered); }
+static void bmHashTableFind(State &state) { runFind<HashTable<int, int>>(state, insertChained, findChained); }
+static void bmLinearProbingFind(State &state) { runFind<LinearProbingHashTable>(state, insertLinear, findLinear); }
+
+static const std::vector<std::vector<int64_t>> TABLE_ARGS = {{1 << 10, 1 << 16, 1 << 20}, {SEQUENTIAL, SCATTERED}};
+MICROBENCH(bmUnorderedMapInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmHashTableInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmLinearProbingInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmUnorderedMapFind)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmHashTableFind)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmLinearProbingFind)->argsProduct(TABLE_ARGS);
+
+// ---------------- 平衡树 ----------------
+// RBTree 和 AVLTree 只存键，对照的是 std::set
+
+static void insertSet(std::set<int> &tree, int key) { tree.insert(key); }
+static bool findSet(const std::set<int> &tree, int key) { return tree.find(key) != tree.end(); }
+static void insertRB(RBTree<int> &tree, int key) { tree.insert(key); }
+static bool findRB(const RBTree<int> &tree, int key) { return tree.find(key); }
+static void insertAVL(AVLTree<int> &tree, int key) { tree.insert(key); }
+static bool findAVL(const AVLTree<int> &tree, int key) { return tree.find(key); }
+
+static void bmStdSetInsert(State &state) { runInsert<std::set<int>>(state, insertSet); }
+static void bmRBTreeInsert(State &state) { runInsert<RBTree<int>>(state, insertRB); }
+static void bmAVLTreeInsert(State &state) { runInsert<AVLTree<int>>(state, insertAVL); }
+static void bmStdSetFind(State &state) { runFind<std::set<int>>(state, insertSet, findSet); }
+static void bmRBTreeFind(State &state) { runFind<RBTree<int>>(state, insertRB, findRB); }
+static void bmAVLTreeFind(State &state) { runFind<AVLTree<int>>(state, insertAVL, findAVL); }
+
+MICROBENCH(bmStdSetInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmRBTreeInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmAVLTreeInsert)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmStdSetFind)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmRBTreeFind)->argsProduct(TABLE_ARGS);
+MICROBENCH(bmAVLTreeFind)->argsProduct(TABLE_ARGS);
+
+// ---------------- 优先队列 ----------------
+
+// 每轮压入 n 个随机数再全部弹出
+static void bmStdPriorityQueue(State &state)
+{
+    std::vector<int> data = makeData((size_t)state.range(0), RANDOM);
+    for (auto _ : state)
+    {
+        std::priority_queue<int> heap;
+        for (int x : data)
+        {
+            heap.push(x);
+        }
+        long long sum = 0;
+        while (!heap.empty())
+        {
+            sum += heap.top();
+            heap.pop();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)data.size());
+}
+
+static void bmPriorityQueue(State &state)
+{
+    std::vector<int> data = makeData((size_t)state.range(0), RANDOM);
+    for (auto _ : state)
+    {
+        PriorityQueue<int> heap;
+        for (int x : data)
+        {
+            heap.push(x);
+        }
+        long long sum = 0;
+        while (!heap.empty())
+        {
+            sum += heap.top();
+            heap.pop();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * (int64_t)data.size());
+}
+
+static const std::vector<int64_t> QUEUE_SIZES = {1 << 10, 1 << 16, 1 << 20};
+MICROBENCH(bmStdPriorityQueue)->argsProduct({QUEUE_SIZES});
+MICROBENCH(bmPriorityQueue)->argsProduct({QUEUE_SIZES});
+
+// ---------------- 环形队列 ----------------
+
+// 每轮入队 n 个再全部出队；队列在轮与轮之间复用，只有第一轮会扩容
+static void bmStdQueue(State &state)
+{
+    int n = (int)state.range(0);
+    std::queue<int> q;
+    for (auto _ : state)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            q.push(i);
+        }
+        long long sum = 0;
+        while (!q.empty())
+        {
+            sum += q.front();
+            q.pop();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+
+static void bmRingQueue(State &state)
+{
+    int n = (int)state.range(0);
+    Queue q(16);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            q.push(i);
+        }
+        long long sum = 0;
+        while (!q.isEmpty())
+        {
+            sum += q.pop();
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+
+// 无锁单生产者单消费者环形队列在单线程下的开销，容量固定为 n
+static void bmSpscRing(State &state)
+{
+    int n = (int)state.range(0);
+    SpscRing<int> q((size_t)n);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            q.tryPush(i);
+        }
+        long long sum = 0;
+        int x;
+        while (q.tryPop(x))
+        {
+            sum += x;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * n);
+}
+
+MICROBENCH(bmStdQueue)->argsProduct({QUEUE_SIZES});
+MICROBENCH(bmRingQueue)->argsProduct({QUEUE_SIZES});
+MICROBENCH(bmSpscRing)->argsProduct({QUEUE_SIZES});
+
+int main(int argc, char *argv[])
+{
+    int rc = microbench::runAll(argc, argv);
+    if (stats::enabled)
+    {
+        stats::dump(std::cerr); // 以 -DNOTES_STATS=ON 构建时，跑完后输出探测长度、链长、旋转次数等（走 stderr，不混进 CSV）
+    }
+    return rc;
+}
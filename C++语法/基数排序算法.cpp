@@ -1,50 +1,68 @@
 #include <iostream>
 #include <vector>
-#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <random>
+#include <chrono>
+#include "基数排序算法.h"
 using namespace std;
 
-// 实现基数排序
-void radixSort(vector<int> &arr)
+template <typename T, typename Sort>
+double timeSort(vector<T> data, const vector<T> &expect, Sort sortFunc)
 {
-    int maxNum = *max_element(arr.begin(), arr.end());
-    int minNum = *min_element(arr.begin(), arr.end()); // 计算最小值
-    int absMaxNum = abs(maxNum);                       // 计算最大值的绝对值
-    int absMinNum = abs(minNum);                       // 计算最小值的绝对值
-
-    int exp = 1; // 当前位数的权重
-
-    while (maxNum / exp > 0)
+    auto start = chrono::steady_clock::now();
+    sortFunc(data);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (data != expect)
     {
-        vector<int> output(arr.size()); // 输出数组
-        vector<int> count(20, 0);       // 计数数组
-
-        // 统计当前位数的出现次数
-        for (int i = 0; i < arr.size(); i++)
-        {
-            count[((arr[i] / exp) % 10) + 10]++;
-        }
-
-        // 累加计数数组
-        for (int i = 1; i < 20; i++)
-        {
-            count[i] += count[i - 1];
-        }
+        cout << "结果错误 ";
+    }
+    return seconds;
+}
 
-        // 构建输出数组
-        for (int i = arr.size() - 1; i >= 0; i--)
-        {
-            output[count[((arr[i] / exp) % 10) + 10] - 1] = arr[i];
-            count[((arr[i] / exp) % 10) + 10]--;
-        }
+template <typename T>
+void benchType(const char *name, const vector<T> &data)
+{
+    vector<T> expect(data);
+    stable_sort(expect.begin(), expect.end(), [](const T &a, const T &b)
+                { return a < b; });
+    double stdTime = timeSort(data, expect, [](vector<T> &v)
+                              { sort(v.begin(), v.end()); });
+    double radix8 = timeSort(data, expect, [](vector<T> &v)
+                             { radixSort<8>(v); });
+    double radix16 = timeSort(data, expect, [](vector<T> &v)
+                              { radixSort<16>(v); });
+    cout << name << "  std::sort " << stdTime << " s  radix8 " << radix8 << " s  radix16 " << radix16 << " s" << endl;
+}
 
-        // 将输出数组复制回原数组
-        arr = output;
-        exp *= 10; // 移动到下一个位数
+// 压测：./a.out bench [n]，默认 10000000 个元素
+void bench(size_t n)
+{
+    mt19937_64 rng(12345);
+    vector<int32_t> keys32(n);
+    vector<int64_t> keys64(n);
+    vector<pair<uint64_t, uint32_t>> pairs(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        keys32[i] = (int32_t)rng();
+        keys64[i] = (int64_t)rng();
+        pairs[i] = make_pair(rng() % 1000000, (uint32_t)i); // 键有重复，payload 是原始位置，顺带验证稳定性
     }
+    cout << n << " 个元素" << endl;
+    benchType("int32   ", keys32);
+    benchType("int64   ", keys64);
+    benchType("pair    ", pairs);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000000);
+        return 0;
+    }
     vector<int> arr = {170, 45, 75, 90, 802, 24, 2, 66, -1, -5, -3, 0, 100, 200, -100, -2000};
     radixSort(arr);
 
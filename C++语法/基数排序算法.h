@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include "排序网络.h"
+
+// 把整数键映射成无符号数并保持大小顺序：有符号数翻转符号位，负数就排到了正数前面
+template <typename Key>
+typename std::make_unsigned<Key>::type radixKey(Key key)
+{
+    typedef typename std::make_unsigned<Key>::type U;
+    U u = (U)key;
+    if (std::is_signed<Key>::value)
+    {
+        u ^= (U)1 << (sizeof(Key) * 8 - 1);
+    }
+    return u;
+}
+
+// 按字节（BITS 位一组）的 LSD 基数排序，keyOf 从元素里取出整数键；稳定排序，键相同的元素保持原顺序
+//   1. 一遍扫描同时统计每一位的直方图，不再每一趟都重新数一遍；
+//   2. 每一趟在 data 和 scratch 之间来回搬，不分配新数组，也不整体拷回；
+//   3. 所有元素在某一位上都相同（比如小整数的高字节）时，这一趟直接跳过；
+//   4. 取位只用移位和与运算，没有除法。
+template <int BITS, typename T, typename KeyOf>
+void radixSortBy(T *data, T *scratch, size_t n, KeyOf keyOf)
+{
+    if (n < 2)
+    {
+        return;
+    }
+    typedef decltype(radixKey(keyOf(*data))) U;
+    const int PASSES = (int)((sizeof(U) * 8 + BITS - 1) / BITS);
+    const size_t BUCKETS = (size_t)1 << BITS;
+    const U MASK = (U)(BUCKETS - 1);
+
+    std::vector<size_t> count(PASSES * BUCKETS, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        U k = radixKey(keyOf(data[i]));
+        for (int p = 0; p < PASSES; p++)
+        {
+            count[p * BUCKETS + ((k >> (p * BITS)) & MASK)]++;
+        }
+    }
+
+    T *src = data;
+    T *dst = scratch;
+    for (int p = 0; p < PASSES; p++)
+    {
+        size_t *c = &count[p * BUCKETS];
+        int shift = p * BITS;
+        if (c[(radixKey(keyOf(src[0])) >> shift) & MASK] == n)
+        {
+            continue; // 这一位全部相同，顺序不会变
+        }
+        // 计数变成每个桶的起始位置
+        size_t sum = 0;
+        for (size_t b = 0; b < BUCKETS; b++)
+        {
+            size_t t = c[b];
+            c[b] = sum;
+            sum += t;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            dst[c[(radixKey(keyOf(src[i])) >> shift) & MASK]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != data)
+    {
+        std::copy(src, src + n, data); // 趟数为奇数时结果在 scratch 里
+    }
+}
+
+// 实现基数排序：任意宽度的有符号/无符号整数，BITS 取 8 或 16
+// 16 位一组时 32 位键只要两趟，但 65536 个桶的直方图要占 L2 缓存，数据量大时才划算
+template <int BITS = 8, typename Key>
+void radixSort(std::vector<Key> &arr)
+{
+    if constexpr (std::is_same<Key, int>::value)
+    {
+        if (arr.size() <= SORT_NETWORK_MAX)
+        {
+            sortNetwork(arr.data(), (int)arr.size()); // 直方图的开销比排序本身还大
+            return;
+        }
+    }
+    std::vector<Key> scratch(arr.size());
+    radixSortBy<BITS>(arr.data(), scratch.data(), arr.size(), [](Key key)
+                      { return key; });
+}
+
+// 键值对版本：按 first 排序，second 跟着一起搬
+template <int BITS = 8, typename Key, typename Value>
+void radixSort(std::vector<std::pair<Key, Value>> &arr)
+{
+    std::vector<std::pair<Key, Value>> scratch(arr.size());
+    radixSortBy<BITS>(arr.data(), scratch.data(), arr.size(), [](const std::pair<Key, Value> &item)
+                      { return item.first; });
+}
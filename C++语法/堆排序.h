@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+// 在 [first, first + n) 组成的大顶堆里把下标 j 下沉；comp(a, b) 为真表示 a 排在 b 前面，堆顶是“最大”的元素
+template <typename RandomIt, typename Compare>
+void siftDown(RandomIt first, std::ptrdiff_t j, std::ptrdiff_t n, Compare comp)
+{
+    while (j * 2 + 1 < n)
+    {
+        std::ptrdiff_t k = j * 2 + 1; // 左子节点
+        if (k + 1 < n && comp(first[k], first[k + 1]))
+        {
+            k++; // 右子节点更大
+        }
+        if (comp(first[j], first[k]))
+        {
+            std::iter_swap(first + j, first + k);
+            j = k; // 下沉
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+// 对 [first, last) 做堆排序，快速排序递归过深时用它兜底；比较器是模板参数，比较调用可以内联
+template <typename RandomIt, typename Compare = std::less<>>
+void heapSort(RandomIt first, RandomIt last, Compare comp = Compare())
+{
+    std::ptrdiff_t n = last - first;
+    // 构建大顶堆
+    for (std::ptrdiff_t i = n / 2 - 1; i >= 0; i--)
+    {
+        siftDown(first, i, n, comp);
+    }
+    // 排序
+    for (std::ptrdiff_t i = n - 1; i > 0; i--)
+    {
+        std::iter_swap(first, first + i); // 交换堆顶和最后一个元素
+        siftDown(first, 0, i, comp);
+    }
+}
+
+// 对闭区间 [left, right] 做堆排序
+inline void HeapSort(std::vector<int> &arr, int left, int right)
+{
+    heapSort(arr.begin() + left, arr.begin() + right + 1);
+}
+
+// 实现堆排序
+inline void HeapSort(std::vector<int> &arr)
+{
+    heapSort(arr.begin(), arr.end());
+}
@@ -0,0 +1,430 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <future>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "归并排序算法.h"
+
+// 外部排序：对放不进内存的 int32 二进制文件排序
+//   1. 切块：按内存预算把输入切成若干块，每块在内存里用 mergeSortBottomUp 排好后写成一个有序段；
+//      读下一块与排序、写出当前块重叠进行（两块缓冲区轮流用）；
+//   2. 合并：所有有序段 mmap 进来顺序读，用败者树做 k 路归并，输出用两块缓冲区轮流写（每块占内存预算的 1/4），
+//      合并线程填一块的同时后台线程把另一块写盘；段数超过 MAX_FAN_IN 时先分组合并成更长的段再继续。
+// 输入文件的大小必须是 int32 的整数倍，末尾多出不成整数的字节时报错退出，不会悄悄丢掉。
+// 用法: ./a.out gen <file> <count>            生成 count 个随机 int32
+//       ./a.out sort <in> <out> [memMB] [tmpdir]  排序，默认内存 256MB、临时目录为当前目录
+//       ./a.out check <file>                  检查文件是否有序
+
+const int MAX_FAN_IN = 512;                 // 一次合并最多打开的段数
+const size_t WRITE_BUFFER_BYTES = 16 << 20; // 输出的每块缓冲区最大的大小
+const size_t MIN_WRITE_BUFFER_BYTES = 64 << 10;
+
+static void die(const char *what)
+{
+    perror(what);
+    exit(EXIT_FAILURE);
+}
+
+// 没有 errno 可报的错误
+static void fail(const std::string &what)
+{
+    std::cerr << what << std::endl;
+    exit(EXIT_FAILURE);
+}
+
+// 文件里的 int32 个数；大小不是 4 的整数倍说明文件被截断或不是这种格式
+static size_t intCount(int fd, const std::string &path)
+{
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+        die("fstat");
+    if ((size_t)st.st_size % sizeof(int) != 0)
+    {
+        fail(path + ": 文件大小 " + std::to_string((long long)st.st_size) + " 字节，末尾有 " +
+             std::to_string((size_t)st.st_size % sizeof(int)) + " 个字节凑不成一个 int32");
+    }
+    return (size_t)st.st_size / sizeof(int);
+}
+
+// 合并阶段的两块输出缓冲区合起来占内存预算的一半；切块用的缓冲区这时已经释放
+static size_t writeBufferBytes(size_t memoryBytes)
+{
+    return std::min(WRITE_BUFFER_BYTES, std::max(MIN_WRITE_BUFFER_BYTES, memoryBytes / 4));
+}
+
+// 读满 bytes 字节，文件结束时返回实际读到的字节数
+static size_t readFull(int fd, void *buf, size_t bytes)
+{
+    size_t done = 0;
+    while (done < bytes)
+    {
+        ssize_t n = read(fd, (char *)buf + done, bytes - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            die("read");
+        }
+        if (n == 0)
+            break;
+        done += (size_t)n;
+    }
+    return done;
+}
+
+static void writeFull(int fd, const void *buf, size_t bytes)
+{
+    size_t done = 0;
+    while (done < bytes)
+    {
+        ssize_t n = write(fd, (const char *)buf + done, bytes - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            die("write");
+        }
+        done += (size_t)n;
+    }
+}
+
+static int openWrite(const std::string &path)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        die(path.c_str());
+    return fd;
+}
+
+// 双缓冲写：一块缓冲区写满后交给后台线程写盘，调用方立即接着填另一块
+class BufferedWriter
+{
+public:
+    BufferedWriter(int fd, size_t bytes) : fd(fd), active(0), used(0)
+    {
+        buffers[0].resize(bytes / sizeof(int));
+        buffers[1].resize(bytes / sizeof(int));
+    }
+    ~BufferedWriter()
+    {
+        flush();
+    }
+
+    void push(int value)
+    {
+        buffers[active][used++] = value;
+        if (used == buffers[active].size())
+        {
+            submit();
+        }
+    }
+
+    void flush()
+    {
+        if (used != 0)
+        {
+            submit();
+        }
+        if (pending.valid())
+        {
+            pending.get();
+        }
+    }
+
+private:
+    int fd;
+    std::vector<int> buffers[2];
+    int active;
+    size_t used;
+    std::future<void> pending;
+
+    void submit()
+    {
+        if (pending.valid())
+        {
+            pending.get(); // 上一块必须先写完，它的缓冲区马上要被复用
+        }
+        const int *data = buffers[active].data();
+        size_t bytes = used * sizeof(int);
+        int out = fd;
+        pending = std::async(std::launch::async, [out, data, bytes]
+                             { writeFull(out, data, bytes); });
+        active ^= 1;
+        used = 0;
+    }
+};
+
+// 只读映射一个有序段，提示内核顺序预读
+class MappedRun
+{
+public:
+    explicit MappedRun(const std::string &path) : data(nullptr), count(0), pos(0)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            die(path.c_str());
+        count = intCount(fd, path);
+        if (count != 0)
+        {
+            void *p = mmap(nullptr, count * sizeof(int), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+                die("mmap");
+            madvise(p, count * sizeof(int), MADV_SEQUENTIAL);
+            data = (const int *)p;
+        }
+        close(fd);
+    }
+    ~MappedRun()
+    {
+        if (data != nullptr)
+        {
+            munmap((void *)data, count * sizeof(int));
+        }
+    }
+    MappedRun(const MappedRun &) = delete;
+    MappedRun &operator=(const MappedRun &) = delete;
+
+    bool empty() const { return pos == count; }
+    int head() const { return data[pos]; }
+    void next() { pos++; }
+
+private:
+    const int *data;
+    size_t count;
+    size_t pos;
+};
+
+// 败者树：内部节点记录比赛中的失败者，tree[0] 是总冠军。
+// 冠军被取走后，只需沿它的叶子到根重新比一遍，每次 log k 次比较，比堆的下沉少一半比较
+class LoserTree
+{
+public:
+    explicit LoserTree(std::vector<MappedRun *> &runs) : runs(runs), k((int)runs.size()), tree(k)
+    {
+        // 叶子编号 k..2k-1，自底向上算出每个内部节点的胜者和败者
+        std::vector<int> winner(k);
+        for (int t = k - 1; t >= 1; t--)
+        {
+            int a = childWinner(winner, 2 * t);
+            int b = childWinner(winner, 2 * t + 1);
+            if (beats(a, b))
+            {
+                winner[t] = a;
+                tree[t] = b;
+            }
+            else
+            {
+                winner[t] = b;
+                tree[t] = a;
+            }
+        }
+        tree[0] = k == 1 ? 0 : winner[1];
+    }
+
+    // 当前最小值所在的段，所有段都读完时返回 -1
+    int top() const
+    {
+        return runs[tree[0]]->empty() ? -1 : tree[0];
+    }
+
+    // 冠军所在的段前进一个元素后重新比赛
+    void replay()
+    {
+        int w = tree[0];
+        for (int t = (w + k) / 2; t > 0; t /= 2)
+        {
+            if (beats(tree[t], w))
+            {
+                std::swap(tree[t], w);
+            }
+        }
+        tree[0] = w;
+    }
+
+private:
+    std::vector<MappedRun *> &runs;
+    int k;
+    std::vector<int> tree;
+
+    int childWinner(const std::vector<int> &winner, int node) const
+    {
+        return node >= k ? node - k : winner[node];
+    }
+
+    // 读完的段永远输；值相同时编号小的赢，合并结果稳定
+    bool beats(int a, int b) const
+    {
+        if (runs[a]->empty())
+            return false;
+        if (runs[b]->empty())
+            return true;
+        return runs[a]->head() < runs[b]->head() || (runs[a]->head() == runs[b]->head() && a < b);
+    }
+};
+
+// 把若干有序段合并写入 outPath，合并完删除这些段
+static void mergeRuns(const std::vector<std::string> &paths, const std::string &outPath, size_t memoryBytes)
+{
+    std::vector<MappedRun *> runs;
+    for (const std::string &path : paths)
+    {
+        runs.push_back(new MappedRun(path));
+    }
+    int fd = openWrite(outPath);
+    {
+        BufferedWriter writer(fd, writeBufferBytes(memoryBytes));
+        LoserTree tree(runs);
+        int w;
+        while ((w = tree.top()) >= 0)
+        {
+            writer.push(runs[w]->head());
+            runs[w]->next();
+            tree.replay();
+        }
+    }
+    close(fd);
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        delete runs[i];
+        unlink(paths[i].c_str());
+    }
+}
+
+static std::string runPath(const std::string &tmpDir, int id)
+{
+    return tmpDir + "/extsort_" + std::to_string(getpid()) + "_" + std::to_string(id) + ".run";
+}
+
+// 第一阶段：切块排序，返回生成的有序段
+static std::vector<std::string> makeRuns(const std::string &inPath, size_t memoryBytes, const std::string &tmpDir, int &nextId)
+{
+    int fd = open(inPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        die(inPath.c_str());
+    intCount(fd, inPath);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // 两块数据缓冲区轮流读和排序，再加一块归并排序用的临时区
+    size_t chunkInts = memoryBytes / 3 / sizeof(int);
+    chunkInts = std::max<size_t>(chunkInts, 1 << 16);
+    std::vector<int> buffers[2] = {std::vector<int>(chunkInts), std::vector<int>(chunkInts)};
+    std::vector<int> scratch(chunkInts);
+    auto readChunk = [fd, chunkInts](int *dst)
+    {
+        return readFull(fd, dst, chunkInts * sizeof(int)) / sizeof(int);
+    };
+
+    std::vector<std::string> paths;
+    int cur = 0;
+    size_t count = readChunk(buffers[cur].data());
+    while (count != 0)
+    {
+        // 后台读下一块，同时排序、写出当前块
+        std::future<size_t> nextRead = std::async(std::launch::async, readChunk, buffers[cur ^ 1].data());
+        mergeSortBottomUp(buffers[cur].data(), scratch.data(), (std::ptrdiff_t)count);
+        std::string path = runPath(tmpDir, nextId++);
+        int out = openWrite(path);
+        writeFull(out, buffers[cur].data(), count * sizeof(int));
+        close(out);
+        paths.push_back(path);
+        count = nextRead.get();
+        cur ^= 1;
+    }
+    close(fd);
+    return paths;
+}
+
+static void externalSort(const std::string &inPath, const std::string &outPath, size_t memoryBytes, const std::string &tmpDir)
+{
+    int nextId = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> runs = makeRuns(inPath, memoryBytes, tmpDir, nextId);
+    double splitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "切块排序: " << runs.size() << " 个有序段, " << splitTime << " s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    if (runs.empty())
+    {
+        close(openWrite(outPath)); // 空输入得到空输出
+        return;
+    }
+    // 段太多时分组合并，直到一次能合并完
+    while ((int)runs.size() > MAX_FAN_IN)
+    {
+        std::vector<std::string> merged;
+        for (size_t i = 0; i < runs.size(); i += MAX_FAN_IN)
+        {
+            std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(runs.size(), i + MAX_FAN_IN));
+            std::string path = runPath(tmpDir, nextId++);
+            mergeRuns(group, path, memoryBytes);
+            merged.push_back(path);
+        }
+        runs.swap(merged);
+    }
+    mergeRuns(runs, outPath, memoryBytes);
+    double mergeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "多路归并: " << mergeTime << " s" << std::endl;
+}
+
+static void generate(const std::string &path, size_t count)
+{
+    int fd = openWrite(path);
+    BufferedWriter writer(fd, WRITE_BUFFER_BYTES);
+    std::mt19937 rng(12345);
+    for (size_t i = 0; i < count; i++)
+    {
+        writer.push((int)rng());
+    }
+    writer.flush();
+    close(fd);
+}
+
+static bool checkSorted(const std::string &path)
+{
+    MappedRun run(path);
+    if (run.empty())
+        return true;
+    int prev = run.head();
+    for (run.next(); !run.empty(); run.next())
+    {
+        if (run.head() < prev)
+            return false;
+        prev = run.head();
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 4 && strcmp(argv[1], "gen") == 0)
+    {
+        generate(argv[2], strtoull(argv[3], nullptr, 10));
+    }
+    else if (argc >= 4 && strcmp(argv[1], "sort") == 0)
+    {
+        size_t memoryMB = argc > 4 ? strtoull(argv[4], nullptr, 10) : 256;
+        std::string tmpDir = argc > 5 ? argv[5] : ".";
+        externalSort(argv[2], argv[3], memoryMB << 20, tmpDir);
+    }
+    else if (argc >= 3 && strcmp(argv[1], "check") == 0)
+    {
+        std::cout << (checkSorted(argv[2]) ? "有序" : "无序") << std::endl;
+    }
+    else
+    {
+        std::cout << "用法: " << argv[0] << " gen <file> <count> | sort <in> <out> [memMB] [tmpdir] | check <file>" << std::endl;
+        return 1;
+    }
+    return 0;
+}
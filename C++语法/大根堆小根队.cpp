@@ -1,133 +1,183 @@
 #include <iostream>
 #include <vector>
+#include <queue>
+#include <string>
 #include <functional>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include "大根堆小根队.h"
 
-class PriorityQueue
+struct Job
 {
-public:
-    PriorityQueue(int cap = 20) : size_(0), capacity_(cap), data_(new int[cap])
-    {
-        comp_ = std::greater<int>();
-    }
+    int priority;
+    std::string name;
+};
+
+// Dijkstra 里堆中的元素：到起点的距离和顶点编号
+struct Entry
+{
+    long long dist;
+    int node;
+};
 
-    ~PriorityQueue()
+struct CloserEntry
+{
+    bool operator()(const Entry &a, const Entry &b) const
     {
-        delete[] data_;
-        data_ = nullptr;
+        return a.dist < b.dist;
     }
+};
 
-    void push(int val)
+struct Graph
+{
+    std::vector<int> start; // 顶点 u 的边是 edges[start[u], start[u + 1])
+    std::vector<std::pair<int, int>> edges; // (终点, 权重)
+};
+
+Graph randomGraph(int n, int degree)
+{
+    std::mt19937 rng(12345);
+    Graph g;
+    g.start.resize(n + 1);
+    for (int u = 0; u < n; u++)
     {
-        if (size_ == capacity_)
-        {
-            expand();
-        }
-        if (size_ == 0)
-        {
-            data_[size_] = val;
-        }
-        else
+        g.start[u] = u * degree;
+        for (int k = 0; k < degree; k++)
         {
-            data_[size_] = val;
-            shiftup(size_, val);
+            g.edges.push_back(std::make_pair((int)(rng() % n), 1 + (int)(rng() % 1000)));
         }
-        ++size_;
     }
+    g.start[n] = n * degree;
+    return g;
+}
 
-    void pop()
+// 对照组：std::priority_queue 不能调整已有元素，松弛时塞入新元素，出队时跳过过期的
+long long dijkstraLazy(const Graph &g, std::vector<long long> &dist)
+{
+    std::fill(dist.begin(), dist.end(), LLONG_MAX);
+    auto farther = [](const Entry &a, const Entry &b)
+    {
+        return a.dist > b.dist;
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(farther)> pq(farther);
+    dist[0] = 0;
+    pq.push({0, 0});
+    long long pops = 0;
+    while (!pq.empty())
     {
-        if (size_ == 0)
+        Entry e = pq.top();
+        pq.pop();
+        pops++;
+        if (e.dist != dist[e.node])
         {
-            return;
+            continue;
         }
-        data_[0] = data_[--size_];
-        int i = 0;
-        while (i < size_ / 2)
+        for (int k = g.start[e.node]; k < g.start[e.node + 1]; k++)
         {
-            int left = i * 2 + 1;
-            int right = i * 2 + 2;
-            if (left >= size_)
-            {
-                break;
-            }
-            int minIndex = left;
-            if (right < size_ && comp_(data_[right], data_[left]))
-            {
-                minIndex = right;
-            }
-            if (comp_(data_[minIndex], data_[i]))
+            int v = g.edges[k].first;
+            long long nd = e.dist + g.edges[k].second;
+            if (nd < dist[v])
             {
-                std::swap(data_[i], data_[minIndex]);
-                i = minIndex;
+                dist[v] = nd;
+                pq.push({nd, v});
             }
-            else
-            {
-                break;
-            }
-        }
-    }
-
-    int top()
-    {
-        if (size_ == 0)
-        {
-            return -1; // or throw an exception
         }
-        return data_[0];
     }
+    return pops;
+}
 
-    void show()
+// 每个顶点在堆里最多一份，松弛时 decreaseKey
+template <int D>
+long long dijkstraDecreaseKey(const Graph &g, std::vector<long long> &dist)
+{
+    int n = (int)dist.size();
+    std::fill(dist.begin(), dist.end(), LLONG_MAX);
+    std::vector<int> handleOf(n, -1);
+    PriorityQueue<Entry, CloserEntry, D> pq(1024);
+    dist[0] = 0;
+    handleOf[0] = pq.push({0, 0});
+    long long pops = 0;
+    while (!pq.empty())
     {
-        for (int i = 0; i < size_; ++i)
+        Entry e = pq.top();
+        pq.pop();
+        handleOf[e.node] = -1;
+        pops++;
+        for (int k = g.start[e.node]; k < g.start[e.node + 1]; k++)
         {
-            std::cout << data_[i] << " ";
+            int v = g.edges[k].first;
+            long long nd = e.dist + g.edges[k].second;
+            if (nd < dist[v])
+            {
+                dist[v] = nd;
+                if (handleOf[v] >= 0)
+                {
+                    pq.decreaseKey(handleOf[v], {nd, v});
+                }
+                else
+                {
+                    handleOf[v] = pq.push({nd, v});
+                }
+            }
         }
-        std::cout << std::endl;
     }
+    return pops;
+}
 
-    void setComp(std::function<bool(int, int)> comp)
-    {
-        comp_ = comp;
-    }
+template <typename Run>
+void timeDijkstra(const char *name, const Graph &g, const std::vector<long long> &expect, Run run)
+{
+    std::vector<long long> dist(expect.size());
+    auto start = std::chrono::steady_clock::now();
+    long long pops = run(g, dist);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << seconds << " s  出队 " << pops << " 次" << (dist == expect ? "" : "  结果错误") << std::endl;
+}
 
-private:
-    using Comp = std::function<bool(int, int)>;
+// 压测：./a.out bench [n] [degree]，默认 1000000 个顶点、每个顶点 8 条出边的随机图上跑 Dijkstra
+void bench(int n, int degree)
+{
+    Graph g = randomGraph(n, degree);
+    std::vector<long long> expect(n);
+    dijkstraLazy(g, expect);
+    std::cout << n << " 个顶点, " << (long long)n * degree << " 条边" << std::endl;
+    timeDijkstra("  std::priority_queue 惰性删除  ", g, expect, dijkstraLazy);
+    timeDijkstra("  二叉堆 decreaseKey           ", g, expect, dijkstraDecreaseKey<2>);
+    timeDijkstra("  4 叉堆 decreaseKey           ", g, expect, dijkstraDecreaseKey<4>);
+    timeDijkstra("  8 叉堆 decreaseKey           ", g, expect, dijkstraDecreaseKey<8>);
 
-    void expand()
+    // 批量建堆：heapify 是 O(n)，逐个 push 是 O(n log n)
+    std::vector<int> keys(n);
+    std::mt19937 rng(1);
+    for (int &k : keys)
     {
-        int *new_data = new int[capacity_ * 2];
-        std::copy(data_, data_ + size_, new_data);
-        delete[] data_;
-        data_ = new_data;
-        capacity_ *= 2;
+        k = (int)rng();
     }
-
-    void shiftup(int size, int val)
+    PriorityQueue<> one(n), bulk(n);
+    auto start = std::chrono::steady_clock::now();
+    for (int k : keys)
     {
-        while (size > 0)
-        {
-            int father = (size - 1) / 2;
-            if (comp_(val, data_[father]))
-            {
-                std::swap(data_[size], data_[father]);
-                size = father;
-            }
-            else
-            {
-                break;
-            }
-        }
+        one.push(k);
     }
+    double pushTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    bulk.heapify(keys.begin(), keys.end());
+    double heapifyTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  逐个 push " << pushTime << " s  heapify " << heapifyTime << " s"
+              << (one.top() == bulk.top() ? "" : "  结果错误") << std::endl;
+}
 
-    Comp comp_;
-    int *data_;
-    int size_;
-    int capacity_;
-};
-
-int main()
+int main(int argc, char *argv[])
 {
-    PriorityQueue pq(10);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? atoi(argv[3]) : 8);
+        return 0;
+    }
+    PriorityQueue<> pq(10);
     pq.push(5);
     pq.push(1);
     pq.push(2);
@@ -139,5 +189,35 @@ int main()
     pq.push(9);
     pq.show();
 
+    // 结构体 + lambda 比较器：优先级高的先出队
+    auto byPriority = [](const Job &a, const Job &b)
+    {
+        return a.priority > b.priority;
+    };
+    PriorityQueue<Job, decltype(byPriority)> jobs(4, byPriority);
+    jobs.push({1, "备份"});
+    jobs.push({5, "告警"});
+    jobs.push({3, "日志"});
+    while (!jobs.empty())
+    {
+        std::cout << jobs.top().priority << ":" << jobs.top().name << " ";
+        jobs.pop();
+    }
+    std::cout << std::endl;
+
+    // 定时器改期：通过句柄直接调整到期时间，小根堆（less）里时间早的在堆顶
+    PriorityQueue<int, std::less<int>> timers;
+    std::vector<int> due = {30, 10, 50, 20};
+    timers.heapify(due.begin(), due.end()); // 句柄 0..3 对应 due 里的位置
+    timers.decreaseKey(2, 5);               // 50 提前到 5
+    timers.update(1, 40);                   // 10 推迟到 40
+    timers.erase(0);                        // 取消 30
+    while (!timers.empty())
+    {
+        std::cout << timers.top() << " ";
+        timers.pop();
+    }
+    std::cout << std::endl;
+
     return 0;
 }
@@ -0,0 +1,326 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+// d 叉堆实现的优先队列，元素类型、比较器和叉数都是模板参数：
+//   comp_(a, b) 为真表示 a 离堆顶更近，默认 greater 就是大根堆；比较器按值存放，调用可以内联。
+//   1. 节点 i 的孩子是 D*i+1 .. D*i+D。存储按缓存行对齐，并在数组前面空出 D-1 个位置，
+//      这样每个节点的 D 个孩子正好落在同一条缓存行里（D * sizeof(T) 是 64 的约数时），下沉时一次访存比较完；
+//      4 叉堆的高度只有二叉堆的一半，上浮少一半，下沉每层多比较几次但都在缓存里。
+//   2. 上浮和下沉都用“空穴”写法：待调整的元素先拿出来，路径上的元素各移动一次，最后放回，不逐层交换。
+//   3. push 返回一个句柄，内部用句柄 -> 下标的位置表跟踪元素，支持 decreaseKey / update / erase，
+//      定时器改期、Dijkstra 松弛时直接调整原来的元素，不用塞重复元素再惰性删除。
+//      元素出队或删除后句柄会被回收复用，调用方不要再用旧句柄。
+//   4. heapify 用 Floyd 建堆批量构造，O(n)。
+template <typename T = int, typename Compare = std::greater<T>, int D = 4>
+class PriorityQueue
+{
+    static_assert(D >= 2, "PriorityQueue 至少是二叉堆");
+
+public:
+    typedef int Handle;
+
+    PriorityQueue(int cap = 20, Compare comp = Compare()) : comp_(comp), data_(nullptr), size_(0), capacity_(0)
+    {
+        reserve(cap);
+    }
+
+    ~PriorityQueue()
+    {
+        if (data_ != nullptr)
+        {
+            deallocate(data_, capacity_);
+            data_ = nullptr;
+        }
+    }
+
+    PriorityQueue(const PriorityQueue &) = delete;
+    PriorityQueue &operator=(const PriorityQueue &) = delete;
+
+    // 按值传入：val 可能引用堆里的元素，扩容后就失效了
+    Handle push(T val)
+    {
+        if (size_ == capacity_)
+        {
+            reserve(capacity_ == 0 ? 1 : capacity_ * 2);
+        }
+        Handle h = newHandle();
+        data_[size_] = std::move(val);
+        ids_[size_] = h;
+        pos_[h] = size_;
+        siftUp(size_++);
+        return h;
+    }
+
+    void pop()
+    {
+        if (size_ == 0)
+        {
+            return;
+        }
+        erase(ids_[0]);
+    }
+
+    const T &top() const
+    {
+        if (size_ == 0)
+        {
+            throw std::out_of_range("PriorityQueue::top on empty queue");
+        }
+        return data_[0];
+    }
+
+    // 堆顶元素的句柄
+    Handle topHandle() const
+    {
+        if (size_ == 0)
+        {
+            throw std::out_of_range("PriorityQueue::topHandle on empty queue");
+        }
+        return ids_[0];
+    }
+
+    bool contains(Handle h) const
+    {
+        return h >= 0 && h < (Handle)pos_.size() && pos_[h] >= 0;
+    }
+
+    const T &get(Handle h) const
+    {
+        return data_[pos_[h]];
+    }
+
+    // val 不比原值离堆顶更远（大根堆里就是增大、小根堆里就是减小），只需要上浮
+    void decreaseKey(Handle h, T val)
+    {
+        int i = pos_[h];
+        data_[i] = std::move(val);
+        siftUp(i);
+    }
+
+    // 任意修改元素的值，按新值上浮或下沉
+    void update(Handle h, T val)
+    {
+        int i = pos_[h];
+        data_[i] = std::move(val);
+        restore(i);
+    }
+
+    // 删除任意元素：用最后一个元素填上它的位置，再上浮或下沉
+    void erase(Handle h)
+    {
+        int i = pos_[h];
+        pos_[h] = -1;
+        freeHandles_.push_back(h);
+        if (i != --size_)
+        {
+            moveSlot(size_, i);
+            restore(i);
+        }
+    }
+
+    // 用 [first, last) 替换全部内容并 O(n) 建堆，第 k 个元素的句柄就是 k
+    template <typename It>
+    void heapify(It first, It last)
+    {
+        clear();
+        int n = (int)std::distance(first, last);
+        if (n > capacity_)
+        {
+            reserve(n);
+        }
+        pos_.resize(n);
+        for (int i = 0; i < n; ++i, ++first)
+        {
+            data_[i] = *first;
+            ids_[i] = i;
+            pos_[i] = i;
+        }
+        size_ = n;
+        rebuild();
+    }
+
+    // 和析构一样先析构 [0, size) 的元素，让它们持有的资源马上释放；
+    // 存储里的位置始终是构造好的（push 是赋值进去的），所以析构完再原地值初始化
+    void clear()
+    {
+        std::destroy_n(data_, size_);
+        std::uninitialized_value_construct_n(data_, size_);
+        size_ = 0;
+        pos_.clear();
+        freeHandles_.clear();
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    int size() const
+    {
+        return size_;
+    }
+
+    void show()
+    {
+        for (int i = 0; i < size_; ++i)
+        {
+            std::cout << data_[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+
+    // 换了比较器，原来的堆序就不成立了，要重新建堆
+    void setComp(Compare comp)
+    {
+        comp_ = comp;
+        rebuild();
+    }
+
+private:
+    static const size_t CACHE_LINE = 64;
+    static const int PAD = D - 1; // 数组前面空出的位置，让每组孩子从缓存行边界开始
+
+    // 分配 cap 个元素的存储，返回的指针前面还有 PAD 个不用的位置
+    static T *allocate(int cap)
+    {
+        void *raw = ::operator new((cap + PAD) * sizeof(T), std::align_val_t(CACHE_LINE));
+        T *data = static_cast<T *>(raw) + PAD;
+        std::uninitialized_value_construct_n(data, cap);
+        return data;
+    }
+
+    static void deallocate(T *data, int cap)
+    {
+        std::destroy_n(data, cap);
+        ::operator delete(data - PAD, std::align_val_t(CACHE_LINE));
+    }
+
+    void reserve(int cap)
+    {
+        T *newData = allocate(cap);
+        if (data_ != nullptr)
+        {
+            std::move(data_, data_ + size_, newData);
+            deallocate(data_, capacity_);
+        }
+        data_ = newData;
+        capacity_ = cap;
+        ids_.resize(cap);
+    }
+
+    Handle newHandle()
+    {
+        if (!freeHandles_.empty())
+        {
+            Handle h = freeHandles_.back();
+            freeHandles_.pop_back();
+            return h;
+        }
+        pos_.push_back(-1);
+        return (Handle)pos_.size() - 1;
+    }
+
+    // 把 from 位置的元素搬到 to，句柄的位置跟着更新
+    void moveSlot(int from, int to)
+    {
+        data_[to] = std::move(data_[from]);
+        ids_[to] = ids_[from];
+        pos_[ids_[to]] = to;
+    }
+
+    void place(int i, T &val, Handle h)
+    {
+        data_[i] = std::move(val);
+        ids_[i] = h;
+        pos_[h] = i;
+    }
+
+    void restore(int i)
+    {
+        if (i > 0 && comp_(data_[i], data_[(i - 1) / D]))
+        {
+            siftUp(i);
+        }
+        else
+        {
+            siftDown(i);
+        }
+    }
+
+    void rebuild()
+    {
+        if (size_ < 2)
+        {
+            return;
+        }
+        for (int i = (size_ - 2) / D; i >= 0; --i)
+        {
+            siftDown(i);
+        }
+    }
+
+    void siftUp(int i)
+    {
+        T val = std::move(data_[i]);
+        Handle h = ids_[i];
+        while (i > 0)
+        {
+            int father = (i - 1) / D;
+            if (!comp_(val, data_[father]))
+            {
+                break;
+            }
+            moveSlot(father, i);
+            i = father;
+        }
+        place(i, val, h);
+    }
+
+    void siftDown(int i)
+    {
+        T val = std::move(data_[i]);
+        Handle h = ids_[i];
+        while (true)
+        {
+            int child = D * i + 1;
+            if (child >= size_)
+            {
+                break;
+            }
+            // 同一条缓存行里的 D 个孩子挑出离堆顶最近的
+            int end = std::min(child + D, size_);
+            int best = child;
+            for (int c = child + 1; c < end; ++c)
+            {
+                if (comp_(data_[c], data_[best]))
+                {
+                    best = c;
+                }
+            }
+            if (!comp_(data_[best], val))
+            {
+                break;
+            }
+            moveSlot(best, i);
+            i = best;
+        }
+        place(i, val, h);
+    }
+
+    Compare comp_;
+    T *data_;
+    std::vector<Handle> ids_;         // 堆中第 i 个元素的句柄
+    std::vector<int> pos_;            // 句柄 -> 堆中下标，已删除的是 -1
+    std::vector<Handle> freeHandles_; // 可复用的句柄
+    int size_;
+    int capacity_;
+};
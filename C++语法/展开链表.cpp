@@ -0,0 +1,97 @@
+#include <iostream>
+#include <list>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "展开链表.h"
+
+// 展开链表与 std::list 对比：尾插 n 个元素、顺序遍历求和 10 遍、删除所有等于某个值的元素
+// 用法: ./a.out [n]，默认 4000000 个元素
+
+template <typename F>
+static double timeMs(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char *name, double build, double scan, double erase, long long sum)
+{
+    std::cout << "  " << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(2)
+              << "尾插 " << std::setw(8) << build << " ms  遍历 " << std::setw(8) << scan << " ms  删除 "
+              << std::setw(8) << erase << " ms  校验 " << sum << std::endl;
+}
+
+static void bench(int n)
+{
+    std::cout << n << " 个元素" << std::endl;
+    {
+        std::list<int> l;
+        long long sum = 0;
+        double build = timeMs([&]
+                              {
+                                  for (int i = 0; i < n; i++)
+                                  {
+                                      l.push_back(i % 10);
+                                  }
+                              });
+        double scan = timeMs([&]
+                             {
+                                 for (int round = 0; round < 10; round++)
+                                 {
+                                     for (int value : l)
+                                     {
+                                         sum += value;
+                                     }
+                                 }
+                             });
+        double erase = timeMs([&]
+                              { l.remove(3); });
+        report("std::list", build, scan, erase, sum + (long long)l.size());
+    }
+    {
+        UnrolledList<int> l;
+        long long sum = 0;
+        double build = timeMs([&]
+                              {
+                                  for (int i = 0; i < n; i++)
+                                  {
+                                      l.inserttail(i % 10);
+                                  }
+                              });
+        double scan = timeMs([&]
+                             {
+                                 for (int round = 0; round < 10; round++)
+                                 {
+                                     l.forEach([&sum](int value)
+                                               { sum += value; });
+                                 }
+                             });
+        double erase = timeMs([&]
+                              { l.eraseAll(3); });
+        report("UnrolledList", build, scan, erase, sum + (long long)l.size());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    UnrolledList<int, 4> l; // 每块 4 个，方便看出分块
+    for (int i = 1; i <= 10; i++)
+    {
+        l.inserttail(i);
+    }
+    l.inserthead(0);
+    l.show();
+    l.erase(5);
+    l.eraseAll(7);
+    std::cout << "删除 5 和 7 后 (" << l.size() << " 个): ";
+    l.show();
+    std::cout << "find(8) = " << l.find(8) << ", find(7) = " << l.find(7) << std::endl;
+
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    bench(n);
+
+    std::cout << "---------E-N-D---------" << std::endl;
+    return 0;
+}
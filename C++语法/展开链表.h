@@ -0,0 +1,293 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+#include "节点池.h"
+
+// 展开链表：每个块里连续存放至多 N 个元素，块之间用双向链表串起来，块从 NodePool 分配。
+//   1. 遍历时一个块之内是顺序读数组，指针追逐从每个元素一次降到每 N 个元素一次，硬件预取也能跟上；
+//   2. 有 tail 指针，尾插只是往最后一块的空位里构造，满了挂一块新的，O(1)；
+//   3. 删除后块不足半满时和前一块合并，前一块太满装不下时从它末尾借元素补齐，保证除首尾外每块至少半满，
+//      遍历不会被大量空洞拖慢。
+// 块内插入要挪动后面的元素，代价是 O(N)，所以头插在块满之前也要挪动整块；N 默认让一块约占 4 条缓存行。
+template <typename T, int N = (sizeof(T) < 64 ? 256 / (int)sizeof(T) : 4), typename Alloc = std::allocator<T>>
+class UnrolledList
+{
+    static_assert(N >= 2, "每块至少放两个元素，否则退化成普通链表");
+
+public:
+    explicit UnrolledList(const Alloc &alloc = Alloc()) : pool(alloc), head(nullptr), tail(nullptr), count(0)
+    {
+    }
+
+    ~UnrolledList()
+    {
+        clear();
+    }
+
+    UnrolledList(const UnrolledList &) = delete;
+    UnrolledList &operator=(const UnrolledList &) = delete;
+
+    void inserttail(const T &value)
+    {
+        if (tail == nullptr || tail->size == N)
+        {
+            linkAfter(tail, createBlock());
+        }
+        new (tail->data() + tail->size) T(value);
+        tail->size++;
+        count++;
+    }
+
+    void inserthead(const T &value)
+    {
+        if (head == nullptr || head->size == N)
+        {
+            linkBefore(head, createBlock());
+        }
+        insertAt(head, 0, value);
+        count++;
+    }
+
+    // 删除第一个等于 value 的元素
+    bool erase(const T &value)
+    {
+        for (Block *b = head; b != nullptr; b = b->next)
+        {
+            T *d = b->data();
+            T *p = std::find(d, d + b->size, value);
+            if (p != d + b->size)
+            {
+                std::move(p + 1, d + b->size, p);
+                d[--b->size].~T();
+                count--;
+                settle(b);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 删除所有等于 value 的元素，返回删除的个数；每块就地压紧一遍，整条链表只走一次
+    std::size_t eraseAll(const T &value)
+    {
+        std::size_t removed = 0;
+        Block *b = head;
+        while (b != nullptr)
+        {
+            T *d = b->data();
+            T *last = std::remove(d, d + b->size, value);
+            int kept = (int)(last - d);
+            for (int i = kept; i < b->size; i++)
+            {
+                d[i].~T();
+            }
+            removed += b->size - kept;
+            b->size = kept;
+            b = settle(b);
+        }
+        count -= removed;
+        return removed;
+    }
+
+    bool find(const T &value) const
+    {
+        for (const Block *b = head; b != nullptr; b = b->next)
+        {
+            const T *d = b->data();
+            if (std::find(d, d + b->size, value) != d + b->size)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 按顺序对每个元素调用 f，块内是普通的数组循环
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (const Block *b = head; b != nullptr; b = b->next)
+        {
+            const T *d = b->data();
+            for (int i = 0; i < b->size; i++)
+            {
+                f(d[i]);
+            }
+        }
+    }
+
+    T &front() { return head->data()[0]; }
+    T &back() { return tail->data()[tail->size - 1]; }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void clear()
+    {
+        Block *b = head;
+        while (b != nullptr)
+        {
+            Block *next = b->next;
+            destroyElements(b);
+            freeBlock(b);
+            b = next;
+        }
+        head = nullptr;
+        tail = nullptr;
+        count = 0;
+    }
+
+    void show() const
+    {
+        forEach([](const T &value)
+                { std::cout << value << " "; });
+        std::cout << std::endl;
+    }
+
+private:
+    struct Block
+    {
+        Block *prev;
+        Block *next;
+        int size;
+        alignas(T) unsigned char storage[N * sizeof(T)];
+
+        T *data() { return reinterpret_cast<T *>(storage); }
+        const T *data() const { return reinterpret_cast<const T *>(storage); }
+    };
+
+    NodePool<Block, Alloc> pool; // 所有块都从这里分配
+    Block *head;
+    Block *tail;
+    std::size_t count;
+
+    Block *createBlock()
+    {
+        Block *b = new (pool.allocate()) Block;
+        b->prev = nullptr;
+        b->next = nullptr;
+        b->size = 0;
+        return b;
+    }
+
+    void freeBlock(Block *b)
+    {
+        b->~Block();
+        pool.deallocate(b);
+    }
+
+    static void destroyElements(Block *b)
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            for (int i = 0; i < b->size; i++)
+            {
+                b->data()[i].~T();
+            }
+        }
+    }
+
+    // 把 b 挂到 pos 后面，pos 为空时挂到最前面
+    void linkAfter(Block *pos, Block *b)
+    {
+        b->prev = pos;
+        b->next = pos != nullptr ? pos->next : head;
+        if (b->next != nullptr)
+        {
+            b->next->prev = b;
+        }
+        else
+        {
+            tail = b;
+        }
+        if (pos != nullptr)
+        {
+            pos->next = b;
+        }
+        else
+        {
+            head = b;
+        }
+    }
+
+    // 把 b 挂到 pos 前面，pos 为空时挂到最后面
+    void linkBefore(Block *pos, Block *b)
+    {
+        linkAfter(pos != nullptr ? pos->prev : tail, b);
+    }
+
+    void unlink(Block *b)
+    {
+        (b->prev != nullptr ? b->prev->next : head) = b->next;
+        (b->next != nullptr ? b->next->prev : tail) = b->prev;
+        freeBlock(b);
+    }
+
+    // 在 b 的第 i 个位置插入，b 必须还有空位
+    static void insertAt(Block *b, int i, const T &value)
+    {
+        T *d = b->data();
+        if (i == b->size)
+        {
+            new (d + i) T(value);
+        }
+        else
+        {
+            new (d + b->size) T(std::move(d[b->size - 1]));
+            std::move_backward(d + i, d + b->size - 1, d + b->size);
+            d[i] = value;
+        }
+        b->size++;
+    }
+
+    // 删除元素后整理 b：空了就摘掉，不足半满且能装进前一块就合并过去；
+    // 装不下说明前一块超过半满，b 在中间时从前一块末尾借元素补到半满，借完前一块也不少于半满。返回 b 原来的下一块
+    Block *settle(Block *b)
+    {
+        Block *next = b->next;
+        if (b->size == 0)
+        {
+            unlink(b);
+        }
+        else if (b->size < N / 2 && b->prev != nullptr && b->prev->size + b->size <= N)
+        {
+            Block *p = b->prev;
+            T *src = b->data();
+            T *dst = p->data() + p->size;
+            for (int i = 0; i < b->size; i++)
+            {
+                new (dst + i) T(std::move(src[i]));
+                src[i].~T();
+            }
+            p->size += b->size;
+            b->size = 0;
+            unlink(b);
+        }
+        else if (b->size < N / 2 && b->prev != nullptr && b->next != nullptr)
+        {
+            Block *p = b->prev;
+            int k = N / 2 - b->size;
+            T *d = b->data();
+            // 从后往前把 b 的元素整体后移 k 位，目标位置要么未构造，要么刚被移走析构过
+            for (int i = b->size - 1; i >= 0; i--)
+            {
+                new (d + i + k) T(std::move(d[i]));
+                d[i].~T();
+            }
+            T *src = p->data() + p->size - k;
+            for (int i = 0; i < k; i++)
+            {
+                new (d + i) T(std::move(src[i]));
+                src[i].~T();
+            }
+            p->size -= k;
+            b->size += k;
+        }
+        return next;
+    }
+};
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "大根堆小根队.h"
+#include "并发优先队列.h"
+
+// 多生产者多消费者压测：每个线程交替 push 一个随机优先级、pop 一个，队列里预先放 prefill 个元素
+// 对比一把互斥锁保护的 PriorityQueue 与 MultiQueue 结构的 ConcurrentPriorityQueue，线程数 1 到 64
+// 用法: ./a.out [prefill] [seconds]，默认 1000000 个元素、每轮 1 秒
+
+// 互斥锁包一层，接口和 ConcurrentPriorityQueue 保持一致
+class LockedPriorityQueue
+{
+public:
+    explicit LockedPriorityQueue(unsigned) : heap(1024)
+    {
+    }
+
+    void push(long long value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        heap.push(value);
+    }
+
+    bool tryPop(long long &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (heap.empty())
+        {
+            return false;
+        }
+        out = heap.top();
+        heap.pop();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    PriorityQueue<long long> heap;
+};
+
+template <typename Queue>
+static void worker(Queue &queue, int seed, const std::atomic<bool> &stop, std::atomic<long long> &ops,
+                   std::atomic<unsigned long long> &checksum)
+{
+    std::mt19937_64 rng(seed);
+    long long count = 0;
+    unsigned long long sum = 0; // 可以回绕，只看最后是否对得上；push 进去的加、pop 出来的减，全部线程合起来最后应该等于队列里剩下的
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        long long value = (long long)(rng() >> 20);
+        queue.push(value);
+        sum += value;
+        long long out;
+        if (queue.tryPop(out))
+        {
+            sum -= out;
+        }
+        count += 2;
+    }
+    ops += count;
+    checksum += sum;
+}
+
+template <typename Queue>
+static void bench(const char *name, int prefill, double seconds)
+{
+    std::cout << name << std::endl;
+    for (int threads = 1; threads <= 64; threads *= 2)
+    {
+        Queue queue(threads);
+        std::mt19937_64 rng(1);
+        unsigned long long remaining = 0;
+        for (int i = 0; i < prefill; i++)
+        {
+            long long value = (long long)(rng() >> 20);
+            queue.push(value);
+            remaining += value;
+        }
+        std::atomic<bool> stop{false};
+        std::atomic<long long> ops{0};
+        std::atomic<unsigned long long> checksum{0};
+        std::vector<std::thread> pool;
+        for (int i = 0; i < threads; i++)
+        {
+            pool.emplace_back(worker<Queue>, std::ref(queue), i + 100, std::cref(stop), std::ref(ops), std::ref(checksum));
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread &t : pool)
+        {
+            t.join();
+        }
+        // 把剩下的全部取出来，校验没有丢元素也没有重复出队
+        remaining += checksum;
+        long long out;
+        while (queue.tryPop(out))
+        {
+            remaining -= out;
+        }
+        std::cout << std::setw(4) << threads << " threads  " << std::fixed << std::setprecision(2) << std::setw(8)
+                  << ops / seconds / 1e6 << " M ops/s";
+        if (remaining != 0)
+        {
+            std::cout << "  错误: 元素对不上";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // 近似顺序演示：单线程下依次取出，大体从大到小
+    ConcurrentPriorityQueue<int> demo(2);
+    for (int i = 0; i < 20; i++)
+    {
+        demo.push(i);
+    }
+    int value;
+    while (demo.tryPop(value))
+    {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+
+    int prefill = argc > 1 ? atoi(argv[1]) : 1000000;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+    bench<LockedPriorityQueue>("mutex + PriorityQueue", prefill, seconds);
+    bench<ConcurrentPriorityQueue<long long>>("ConcurrentPriorityQueue", prefill, seconds);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include "大根堆小根队.h"
+
+// 并发优先队列（MultiQueue）：把元素分散到 factor * 线程数 个带锁的 d 叉堆里，
+//   push 随机挑一个堆放进去；pop 随机挑两个堆，比较堆顶后从更靠前的那个取。
+// 锁都用 try_lock，抢不到就换一个堆，多个生产者/消费者几乎不会在同一把锁上排队。
+// 代价是出队顺序是“近似”的：取到的不一定是全局堆顶，但名次误差的期望只和堆的个数成正比，
+// 做任务调度、定时器这类只要求大致按优先级的场景足够；需要严格顺序时还是用一把锁包住 PriorityQueue。
+// comp 的含义和 PriorityQueue 相同：comp(a, b) 为真表示 a 先出队。
+template <typename T, typename Compare = std::greater<T>, int D = 4>
+class ConcurrentPriorityQueue
+{
+public:
+    explicit ConcurrentPriorityQueue(unsigned threads = std::thread::hardware_concurrency(), int factor = 2,
+                                     Compare comp = Compare())
+        : comp_(comp), size_(0)
+    {
+        size_t count = (size_t)(threads == 0 ? 1 : threads) * (factor < 1 ? 1 : factor);
+        for (size_t i = 0; i < count; i++)
+        {
+            shards_.emplace_back(new Shard(comp));
+        }
+    }
+
+    ConcurrentPriorityQueue(const ConcurrentPriorityQueue &) = delete;
+    ConcurrentPriorityQueue &operator=(const ConcurrentPriorityQueue &) = delete;
+
+    void push(T val)
+    {
+        while (true)
+        {
+            Shard &shard = *shards_[randomIndex()];
+            std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                continue; // 别的线程正在用，换一个
+            }
+            shard.heap.push(std::move(val));
+            shard.count.store(shard.heap.size(), std::memory_order_relaxed);
+            size_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // 取出一个靠近堆顶的元素；所有堆都空时返回 false
+    bool tryPop(T &out)
+    {
+        for (size_t attempt = 0; attempt < shards_.size(); attempt++)
+        {
+            Shard *a = shards_[randomIndex()].get();
+            Shard *b = shards_[randomIndex()].get();
+            // 先不加锁看计数，两个都空就不用抢锁了
+            bool aEmpty = a->count.load(std::memory_order_relaxed) == 0;
+            bool bEmpty = b->count.load(std::memory_order_relaxed) == 0;
+            if (aEmpty && bEmpty)
+            {
+                continue;
+            }
+            if (aEmpty || a == b)
+            {
+                std::swap(a, b);
+                aEmpty = false;
+                bEmpty = true;
+            }
+            if (bEmpty)
+            {
+                std::unique_lock<std::mutex> lock(a->mutex, std::try_to_lock);
+                if (lock.owns_lock() && popFrom(*a, out))
+                {
+                    return true;
+                }
+                continue;
+            }
+            if (std::try_lock(a->mutex, b->mutex) != -1)
+            {
+                continue;
+            }
+            std::lock_guard<std::mutex> lockA(a->mutex, std::adopt_lock);
+            std::lock_guard<std::mutex> lockB(b->mutex, std::adopt_lock);
+            if (!b->heap.empty() && (a->heap.empty() || comp_(b->heap.top(), a->heap.top())))
+            {
+                std::swap(a, b);
+            }
+            if (popFrom(*a, out))
+            {
+                return true;
+            }
+        }
+        // 随机挑了一轮都没取到，队列可能快空了：挨个加锁检查一遍
+        size_t start = randomIndex();
+        for (size_t i = 0; i < shards_.size(); i++)
+        {
+            Shard &shard = *shards_[(start + i) % shards_.size()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (popFrom(shard, out))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 并发修改时只是一个近似值
+    size_t size() const
+    {
+        long long n = size_.load(std::memory_order_relaxed);
+        return n < 0 ? 0 : (size_t)n;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t shardCount() const
+    {
+        return shards_.size();
+    }
+
+private:
+    // 每个堆独占缓存行，锁和计数不和相邻的堆伪共享
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        PriorityQueue<T, Compare, D> heap;
+        std::atomic<int> count; // heap.size() 的副本，不加锁也能读
+
+        explicit Shard(Compare comp) : heap(64, comp), count(0)
+        {
+        }
+    };
+
+    // 调用方已持有 shard 的锁
+    bool popFrom(Shard &shard, T &out)
+    {
+        if (shard.heap.empty())
+        {
+            return false;
+        }
+        out = shard.heap.top();
+        shard.heap.pop();
+        shard.count.store(shard.heap.size(), std::memory_order_relaxed);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 每个线程一个 xorshift 随机数发生器，不共享状态
+    size_t randomIndex() const
+    {
+        thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (size_t)(state % shards_.size());
+    }
+
+    Compare comp_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<long long> size_;
+};
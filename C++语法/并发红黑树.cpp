@@ -0,0 +1,127 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include "红黑树.h"
+#include "并发红黑树.h"
+
+// 读多写少压测：一个写线程不停插入删除奇数键，若干读线程随机查偶数键
+// 对比全局互斥锁保护的 RBTree 与无锁读的 ConcurrentRBTree
+// 用法: ./a.out [n] [seconds]，默认 1000000 个键、每轮 1 秒
+
+// 互斥锁包一层，接口和 ConcurrentRBTree 保持一致
+class LockedRBTree
+{
+public:
+    bool find(int value) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tree.find(value);
+    }
+    void insert(int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tree.insert(value);
+    }
+    void remove(int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tree.remove(value);
+    }
+
+private:
+    mutable std::mutex mutex;
+    RBTree<int> tree;
+};
+
+template <typename Tree>
+static void readWorker(const Tree &tree, int n, int seed, const std::atomic<bool> &stop,
+                       std::atomic<long long> &lookups, std::atomic<long long> &misses)
+{
+    std::mt19937 rng(seed);
+    long long count = 0, miss = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        int key = (int)(rng() % (n / 2)) * 2;
+        miss += !tree.find(key); // 偶数键从不删除，查不到就是错误
+        count++;
+    }
+    lookups += count;
+    misses += miss;
+}
+
+template <typename Tree>
+static void writeWorker(Tree &tree, int n, const std::atomic<bool> &stop, std::atomic<long long> &writes)
+{
+    std::mt19937 rng(99);
+    long long count = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        int key = (int)(rng() % (n / 2)) * 2 + 1;
+        tree.insert(key);
+        tree.remove(key);
+        count += 2;
+    }
+    writes += count;
+}
+
+template <typename Tree>
+static void bench(const char *name, int n, double seconds)
+{
+    Tree tree;
+    for (int i = 0; i < n; i += 2)
+    {
+        tree.insert(i);
+    }
+    std::cout << name << std::endl;
+    for (int readers = 1; readers <= 16; readers *= 2)
+    {
+        std::atomic<bool> stop{false};
+        std::atomic<long long> lookups{0}, misses{0}, writes{0};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < readers; i++)
+        {
+            threads.emplace_back(readWorker<Tree>, std::cref(tree), n, i, std::cref(stop),
+                                 std::ref(lookups), std::ref(misses));
+        }
+        threads.emplace_back(writeWorker<Tree>, std::ref(tree), n, std::cref(stop), std::ref(writes));
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+        std::cout << std::setw(4) << readers << " readers  "
+                  << std::fixed << std::setprecision(2) << std::setw(8) << lookups / seconds / 1e6 << " M lookups/s  "
+                  << std::setw(8) << writes / seconds / 1e6 << " M writes/s";
+        if (misses != 0)
+        {
+            std::cout << "  错误: " << misses << " 次漏查";
+        }
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ConcurrentRBTree<int> demo;
+    for (int i = 0; i < 100; i++)
+    {
+        demo.insert(i);
+    }
+    demo.remove(42);
+    std::cout << "Find 42: " << demo.find(42) << std::endl; // false
+    std::cout << "Find 43: " << demo.find(43) << std::endl; // true
+    std::cout << "Size: " << demo.size() << std::endl;      // 99
+
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+    bench<LockedRBTree>("mutex + RBTree", n, seconds);
+    bench<ConcurrentRBTree<int>>("ConcurrentRBTree", n, seconds);
+    return 0;
+}
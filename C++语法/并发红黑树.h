@@ -0,0 +1,535 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <deque>
+#include <stdexcept>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "节点池.h"
+
+// 读多写少场景下的并发红黑树：读者不加锁，写者之间用一把互斥锁串行。
+// RBTree 的节点带父指针、原地旋转，读者和写者无法同时访问；这里改成持久化（函数式）红黑树：
+//   1. 节点一旦发布就不再修改。写操作只复制从根到修改点的路径（以及平衡时碰到的兄弟节点），
+//      其余子树与旧版本共享，最后用一次原子存储把新根发布出去，读者要么看到旧树要么看到新树；
+//   2. 插入用 Okasaki 的四种情况 balance，删除用 Kahrs 的 balleft/balright/app，都不需要父指针；
+//   3. 被替换下来的旧节点不能立即释放，可能还有读者在上面。按纪元（epoch）回收：
+//      读者进入时把当前纪元写进自己的槽位，写者发布新根后推进纪元，
+//      某一批旧节点只有在所有活跃读者的纪元都比它新时才真正释放。
+// 节点只由写者分配和释放（持锁），所以仍然可以用单线程的 NodePool。
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentRBTree
+{
+    struct Node
+    {
+        Node(const Node *left, const T &data, const Node *right, bool red, uint64_t version)
+            : data(data), left(left), right(right), red(red), version(version) {}
+        T data;
+        const Node *left;
+        const Node *right;
+        bool red;
+        uint64_t version; // 创建它的写操作序号，等于当前序号说明还没发布，可以直接改
+    };
+
+    static const int MAX_READERS = 128; // 同时读的线程数上限，线程退出后编号回收
+
+    // 每个读线程一个槽位，独占缓存行；0 表示不在读
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    struct RetiredBatch
+    {
+        uint64_t epoch;
+        std::vector<const Node *> nodes;
+    };
+
+public:
+    explicit ConcurrentRBTree(const Alloc &alloc = Alloc())
+        : root(nullptr), globalEpoch(1), elementCount(0), writeVersion(0), pool(alloc)
+    {
+    }
+    // 析构时不能再有读者
+    ~ConcurrentRBTree()
+    {
+        destroyTree(root.load(std::memory_order_relaxed));
+        for (RetiredBatch &batch : retired)
+        {
+            for (const Node *node : batch.nodes)
+            {
+                freeNode(node);
+            }
+        }
+    }
+    ConcurrentRBTree(const ConcurrentRBTree &) = delete;
+    ConcurrentRBTree &operator=(const ConcurrentRBTree &) = delete;
+
+    // 无锁查找
+    bool find(const T &value) const
+    {
+        ReadGuard guard(*this);
+        const Node *current = root.load(std::memory_order_seq_cst);
+        while (current != nullptr)
+        {
+            if (value < current->data)
+            {
+                current = current->left;
+            }
+            else if (current->data < value)
+            {
+                current = current->right;
+            }
+            else
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 在一个一致的快照上做中序遍历，遍历期间的写操作对本次遍历不可见
+    template <typename F>
+    void forEach(F visit) const
+    {
+        ReadGuard guard(*this);
+        inorder(root.load(std::memory_order_seq_cst), visit);
+    }
+
+    // 插入，已存在时返回false
+    bool insert(const T &value)
+    {
+        std::lock_guard<std::mutex> lock(writeLock);
+        writeVersion++;
+        bool inserted = false;
+        const Node *oldRoot = root.load(std::memory_order_relaxed);
+        const Node *newRoot = ins(oldRoot, value, inserted);
+        if (!inserted)
+        {
+            return false;
+        }
+        publish(makeBlack(newRoot));
+        elementCount.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 删除，不存在时返回false
+    bool remove(const T &value)
+    {
+        std::lock_guard<std::mutex> lock(writeLock);
+        const Node *oldRoot = root.load(std::memory_order_relaxed);
+        if (!contains(oldRoot, value))
+        {
+            return false; // Kahrs 的删除要求元素一定存在
+        }
+        writeVersion++;
+        const Node *newRoot = del(oldRoot, value);
+        publish(newRoot == nullptr ? nullptr : makeBlack(newRoot));
+        elementCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return elementCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<const Node *> root;
+    std::mutex writeLock;
+    mutable ReaderSlot slots[MAX_READERS];
+    std::atomic<uint64_t> globalEpoch;
+    std::atomic<size_t> elementCount;
+
+    // 以下只有持有 writeLock 的写者访问
+    uint64_t writeVersion;
+    NodePool<Node, Alloc> pool;
+    std::vector<const Node *> consumed; // 本次写操作中被拆掉、不再属于新树的节点
+    std::deque<RetiredBatch> retired;   // 等待所有读者离开的旧节点
+
+    // 读者登记：线程第一次读时领一个编号，对应每棵树里的一个槽位。
+    // 嵌套读（比如在 forEach 的回调里调用 find）沿用外层的纪元，退出时恢复外层的值，外层遍历仍受保护
+    struct ReadGuard
+    {
+        ReaderSlot &slot;
+        uint64_t previous;
+
+        explicit ReadGuard(const ConcurrentRBTree &t)
+            : slot(t.slots[readerId()]), previous(slot.epoch.load(std::memory_order_relaxed))
+        {
+            if (previous == 0)
+            {
+                slot.epoch.store(t.globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+        }
+        ~ReadGuard()
+        {
+            if (previous == 0)
+            {
+                slot.epoch.store(0, std::memory_order_release);
+            }
+        }
+    };
+
+    // 读线程编号：线程退出时还回去，线程池反复换线程也不会把编号用光；
+    // 同时读的线程超过 MAX_READERS 个时直接抛异常，而不是悄悄退化成排在写者后面的加锁读
+    class ReaderId
+    {
+    public:
+        ReaderId() : id_(acquire()) {}
+        ~ReaderId() { used()[id_].store(false, std::memory_order_release); }
+        ReaderId(const ReaderId &) = delete;
+        ReaderId &operator=(const ReaderId &) = delete;
+
+        int get() const { return id_; }
+
+    private:
+        int id_;
+
+        static std::atomic<bool> *used()
+        {
+            static std::atomic<bool> flags[MAX_READERS] = {};
+            return flags;
+        }
+
+        static int acquire()
+        {
+            for (int i = 0; i < MAX_READERS; i++)
+            {
+                bool expected = false;
+                if (!used()[i].load(std::memory_order_relaxed) &&
+                    used()[i].compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    return i;
+                }
+            }
+            throw std::length_error("ConcurrentRBTree: 同时读的线程超过 MAX_READERS 个");
+        }
+    };
+
+    static int readerId()
+    {
+        thread_local ReaderId id;
+        return id.get();
+    }
+
+    // 发布新根，把本次拆下的节点交给纪元回收
+    void publish(const Node *newRoot)
+    {
+        root.store(newRoot, std::memory_order_seq_cst);
+        RetiredBatch batch;
+        for (const Node *node : consumed)
+        {
+            if (node->version == writeVersion)
+            {
+                freeNode(node); // 本次新建又被拆掉的节点从未发布，直接释放
+            }
+            else
+            {
+                batch.nodes.push_back(node);
+            }
+        }
+        consumed.clear();
+        // 新根已经发布，之后进入的读者纪元都大于 batch.epoch，看不到这批节点
+        batch.epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+        if (!batch.nodes.empty())
+        {
+            retired.push_back(std::move(batch));
+        }
+        reclaim();
+    }
+
+    // 释放所有活跃读者都已经越过的批次
+    void reclaim()
+    {
+        uint64_t oldest = UINT64_MAX;
+        for (int i = 0; i < MAX_READERS; i++)
+        {
+            uint64_t e = slots[i].epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest)
+            {
+                oldest = e;
+            }
+        }
+        while (!retired.empty() && retired.front().epoch < oldest)
+        {
+            for (const Node *node : retired.front().nodes)
+            {
+                freeNode(node);
+            }
+            retired.pop_front();
+        }
+    }
+
+    const Node *make(bool red, const Node *left, const T &data, const Node *right)
+    {
+        return new (pool.allocate()) Node(left, data, right, red, writeVersion);
+    }
+
+    void freeNode(const Node *node)
+    {
+        Node *n = const_cast<Node *>(node);
+        n->~Node();
+        pool.deallocate(n);
+    }
+
+    void destroyTree(const Node *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        destroyTree(node->left);
+        destroyTree(node->right);
+        freeNode(node);
+    }
+
+    // 拆掉一个节点：它的孩子和数据会被新节点引用，节点本身等发布之后再处理
+    void consume(const Node *node)
+    {
+        consumed.push_back(node);
+    }
+
+    static bool isRed(const Node *node)
+    {
+        return node != nullptr && node->red;
+    }
+    static bool isBlack(const Node *node)
+    {
+        return node != nullptr && !node->red;
+    }
+
+    template <typename F>
+    static void inorder(const Node *node, F &visit)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        inorder(node->left, visit);
+        visit(node->data);
+        inorder(node->right, visit);
+    }
+
+    static bool contains(const Node *node, const T &value)
+    {
+        while (node != nullptr)
+        {
+            if (value < node->data)
+            {
+                node = node->left;
+            }
+            else if (node->data < value)
+            {
+                node = node->right;
+            }
+            else
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 根涂黑；未发布的新节点可以原地修改
+    const Node *makeBlack(const Node *node)
+    {
+        if (!node->red)
+        {
+            return node;
+        }
+        if (node->version == writeVersion)
+        {
+            const_cast<Node *>(node)->red = false;
+            return node;
+        }
+        consume(node);
+        return make(false, node->left, node->data, node->right);
+    }
+
+    // 黑节点 (a, x, b) 下出现红红相连时，改成红根两黑孩子
+    const Node *balance(const Node *a, const T &x, const Node *b)
+    {
+        if (isRed(a) && isRed(b))
+        {
+            consume(a);
+            consume(b);
+            return make(true, make(false, a->left, a->data, a->right), x, make(false, b->left, b->data, b->right));
+        }
+        if (isRed(a) && isRed(a->left))
+        {
+            const Node *ll = a->left;
+            consume(a);
+            consume(ll);
+            return make(true, make(false, ll->left, ll->data, ll->right), a->data, make(false, a->right, x, b));
+        }
+        if (isRed(a) && isRed(a->right))
+        {
+            const Node *lr = a->right;
+            consume(a);
+            consume(lr);
+            return make(true, make(false, a->left, a->data, lr->left), lr->data, make(false, lr->right, x, b));
+        }
+        if (isRed(b) && isRed(b->right))
+        {
+            const Node *rr = b->right;
+            consume(b);
+            consume(rr);
+            return make(true, make(false, a, x, b->left), b->data, make(false, rr->left, rr->data, rr->right));
+        }
+        if (isRed(b) && isRed(b->left))
+        {
+            const Node *rl = b->left;
+            consume(b);
+            consume(rl);
+            return make(true, make(false, a, x, rl->left), rl->data, make(false, rl->right, b->data, b->right));
+        }
+        return make(false, a, x, b);
+    }
+
+    // 插入：沿路径复制节点，没有插入（已存在）时原样返回
+    const Node *ins(const Node *node, const T &value, bool &inserted)
+    {
+        if (node == nullptr)
+        {
+            inserted = true;
+            return make(true, nullptr, value, nullptr);
+        }
+        if (value < node->data)
+        {
+            const Node *left = ins(node->left, value, inserted);
+            if (!inserted)
+            {
+                return node;
+            }
+            consume(node);
+            return node->red ? make(true, left, node->data, node->right) : balance(left, node->data, node->right);
+        }
+        if (node->data < value)
+        {
+            const Node *right = ins(node->right, value, inserted);
+            if (!inserted)
+            {
+                return node;
+            }
+            consume(node);
+            return node->red ? make(true, node->left, node->data, right) : balance(node->left, node->data, right);
+        }
+        return node;
+    }
+
+    // 黑节点 node 必须存在，去掉一层黑色
+    const Node *sub1(const Node *node)
+    {
+        consume(node);
+        return make(true, node->left, node->data, node->right);
+    }
+
+    // 左子树 bl 比右子树 r 少一层黑色
+    const Node *balleft(const Node *bl, const T &x, const Node *r)
+    {
+        if (isRed(bl))
+        {
+            consume(bl);
+            return make(true, make(false, bl->left, bl->data, bl->right), x, r);
+        }
+        if (isBlack(r))
+        {
+            consume(r);
+            return balance(bl, x, make(true, r->left, r->data, r->right));
+        }
+        // r 是红色，左孩子是黑色
+        const Node *rl = r->left;
+        consume(r);
+        consume(rl);
+        return make(true, make(false, bl, x, rl->left), rl->data, balance(rl->right, r->data, sub1(r->right)));
+    }
+
+    // 右子树 br 比左子树 l 少一层黑色
+    const Node *balright(const Node *l, const T &x, const Node *br)
+    {
+        if (isRed(br))
+        {
+            consume(br);
+            return make(true, l, x, make(false, br->left, br->data, br->right));
+        }
+        if (isBlack(l))
+        {
+            consume(l);
+            return balance(make(true, l->left, l->data, l->right), x, br);
+        }
+        // l 是红色，右孩子是黑色
+        const Node *lr = l->right;
+        consume(l);
+        consume(lr);
+        return make(true, balance(sub1(l->left), l->data, lr->left), lr->data, make(false, lr->right, x, br));
+    }
+
+    // 删除节点后把左右子树拼成一棵
+    const Node *app(const Node *a, const Node *b)
+    {
+        if (a == nullptr)
+        {
+            return b;
+        }
+        if (b == nullptr)
+        {
+            return a;
+        }
+        if (isRed(a) && isRed(b))
+        {
+            const Node *bc = app(a->right, b->left);
+            consume(a);
+            consume(b);
+            if (isRed(bc))
+            {
+                consume(bc);
+                return make(true, make(true, a->left, a->data, bc->left), bc->data, make(true, bc->right, b->data, b->right));
+            }
+            return make(true, a->left, a->data, make(true, bc, b->data, b->right));
+        }
+        if (isBlack(a) && isBlack(b))
+        {
+            const Node *bc = app(a->right, b->left);
+            consume(a);
+            consume(b);
+            if (isRed(bc))
+            {
+                consume(bc);
+                return make(true, make(false, a->left, a->data, bc->left), bc->data, make(false, bc->right, b->data, b->right));
+            }
+            return balleft(a->left, a->data, make(false, bc, b->data, b->right));
+        }
+        if (isRed(b))
+        {
+            consume(b);
+            return make(true, app(a, b->left), b->data, b->right);
+        }
+        consume(a);
+        return make(true, a->left, a->data, app(a->right, b));
+    }
+
+    // 删除：value 一定在 node 子树中
+    const Node *del(const Node *node, const T &value)
+    {
+        consume(node);
+        if (value < node->data)
+        {
+            if (isBlack(node->left))
+            {
+                return balleft(del(node->left, value), node->data, node->right);
+            }
+            return make(true, del(node->left, value), node->data, node->right);
+        }
+        if (node->data < value)
+        {
+            if (isBlack(node->right))
+            {
+                return balright(node->left, node->data, del(node->right, value));
+            }
+            return make(true, node->left, node->data, del(node->right, value));
+        }
+        return app(node->left, node->right);
+    }
+};
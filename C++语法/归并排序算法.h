@@ -0,0 +1,202 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include "排序网络.h"
+
+// 自底向上的归并排序引擎，思路同 TimSort：
+//   1. 先扫描出天然有序的段（严格降序的段原地翻转），太短的段补到 MIN_RUN 后用排序网络排好；
+//   2. 每一趟把相邻两段合并，结果在原数组和同一块临时缓冲区之间来回放，不用每趟拷回；
+//   3. 合并前先用倍增查找跳过已经就位的前缀和后缀，基本有序的输入几乎只剩拷贝；
+//   4. 合并的内循环不用分支，比较结果直接决定两个指针谁前进；一段连续领先时切换成倍增查找整块拷贝。
+// 整个排序只在开头分配一次段边界表，临时缓冲区由调用方提供。
+// 迭代器、元素类型和比较器都是模板参数；comp(a, b) 为真表示 a 严格排在 b 前面。
+
+const int MIN_RUN = 64; // 不超过 SORT_NETWORK_MAX，短段直接用排序网络（其他类型用插入排序）补齐
+const int MERGE_BLOCK = 8;
+
+// 从左往右倍增查找 [first, last) 中第一个排在 key 后面的位置
+template <typename It, typename T, typename Compare>
+It gallopUpper(It first, It last, const T &key, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t lo = 0;
+    std::ptrdiff_t step = 1;
+    while (step <= n && !comp(key, first[step - 1]))
+    {
+        lo = step;
+        step *= 2;
+    }
+    return std::upper_bound(first + lo, first + std::min(step, n), key, comp);
+}
+
+// 从左往右倍增查找 [first, last) 中第一个不排在 key 前面的位置
+template <typename It, typename T, typename Compare>
+It gallopLower(It first, It last, const T &key, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t lo = 0;
+    std::ptrdiff_t step = 1;
+    while (step <= n && comp(first[step - 1], key))
+    {
+        lo = step;
+        step *= 2;
+    }
+    return std::lower_bound(first + lo, first + std::min(step, n), key, comp);
+}
+
+// 从右往左倍增查找 [first, last) 中第一个不排在 key 前面的位置
+template <typename It, typename T, typename Compare>
+It gallopLowerFromRight(It first, It last, const T &key, Compare comp)
+{
+    std::ptrdiff_t n = last - first;
+    std::ptrdiff_t hi = n;
+    std::ptrdiff_t step = 1;
+    while (step <= n && !comp(last[-step], key))
+    {
+        hi = n - step;
+        step *= 2;
+    }
+    return std::lower_bound(first + (step > n ? 0 : n - step), first + hi, key, comp);
+}
+
+// 合并有序区间 [a1, e1) 和 [a2, e2) 到 out，相等时先取左边，保持稳定
+template <typename It, typename Out, typename Compare = std::less<>>
+void mergeRange(It a1, It e1, It a2, It e2, Out out, Compare comp = Compare())
+{
+    if (a1 != e1 && a2 != e2)
+    {
+        // 左段里不排在右段开头之后的前缀、右段里不排在左段结尾之前的后缀，都已经在最终位置上
+        It prefix = gallopUpper(a1, e1, *a2, comp);
+        out = std::copy(a1, prefix, out);
+        a1 = prefix;
+        if (a1 != e1)
+        {
+            It suffix = gallopLowerFromRight(a2, e2, *(e1 - 1), comp);
+            std::copy(suffix, e2, out + (e1 - a1) + (suffix - a2));
+            e2 = suffix;
+        }
+    }
+    // 每次无分支地合并 MERGE_BLOCK 个元素；整块都来自同一段，说明这一段正在连续领先，
+    // 改用倍增查找一次拷走整段领先的元素（TimSort 的 galloping 模式）
+    while (e1 - a1 >= MERGE_BLOCK && e2 - a2 >= MERGE_BLOCK)
+    {
+        It blockStart = a1;
+        for (int t = 0; t < MERGE_BLOCK; t++)
+        {
+            bool takeRight = comp(*a2, *a1);
+            *out++ = takeRight ? *a2 : *a1;
+            a2 += takeRight;
+            a1 += !takeRight;
+        }
+        if (a1 - blockStart == MERGE_BLOCK)
+        {
+            It p = gallopUpper(a1, e1, *a2, comp);
+            out = std::copy(a1, p, out);
+            a1 = p;
+        }
+        else if (a1 == blockStart)
+        {
+            It p = gallopLower(a2, e2, *a1, comp);
+            out = std::copy(a2, p, out);
+            a2 = p;
+        }
+    }
+    while (a1 < e1 && a2 < e2)
+    {
+        bool takeRight = comp(*a2, *a1);
+        *out++ = takeRight ? *a2 : *a1;
+        a2 += takeRight;
+        a1 += !takeRight;
+    }
+    out = std::copy(a1, e1, out);
+    std::copy(a2, e2, out);
+}
+
+// 一趟合并：把 src 中相邻两段合并到 dst 的相同位置，段边界表原地更新
+template <typename Src, typename Dst, typename Compare>
+void mergePass(Src src, Dst dst, std::vector<std::ptrdiff_t> &runs, Compare comp)
+{
+    size_t w = 1;
+    size_t k = 0;
+    for (; k + 2 < runs.size(); k += 2)
+    {
+        mergeRange(src + runs[k], src + runs[k + 1], src + runs[k + 1], src + runs[k + 2], dst + runs[k], comp);
+        runs[w++] = runs[k + 2];
+    }
+    if (k + 1 < runs.size())
+    {
+        std::copy(src + runs[k], src + runs[k + 1], dst + runs[k]); // 落单的最后一段
+        runs[w++] = runs[k + 1];
+    }
+    runs.resize(w);
+}
+
+// 自底向上归并排序 a[0, n)，temp 至少 n 个元素；a 和 temp 可以是不同类型的迭代器
+template <typename RandomIt, typename BufIt, typename Compare = std::less<>>
+void mergeSortBottomUp(RandomIt a, BufIt temp, std::ptrdiff_t n, Compare comp = Compare())
+{
+    if (n < 2)
+    {
+        return;
+    }
+    // 段边界：第 k 段是 [runs[k], runs[k + 1])
+    std::vector<std::ptrdiff_t> runs;
+    runs.reserve(n / MIN_RUN + 2);
+    runs.push_back(0);
+    std::ptrdiff_t i = 0;
+    while (i < n)
+    {
+        std::ptrdiff_t j = i + 1;
+        if (j < n && comp(a[j], a[j - 1]))
+        {
+            while (j < n && comp(a[j], a[j - 1]))
+            {
+                j++;
+            }
+            std::reverse(a + i, a + j); // 严格降序翻转后仍然稳定
+        }
+        else
+        {
+            while (j < n && !comp(a[j], a[j - 1]))
+            {
+                j++;
+            }
+        }
+        if (j - i < MIN_RUN)
+        {
+            j = std::min(n, i + MIN_RUN);
+            sorting::smallSort(a + i, a + j, comp);
+        }
+        runs.push_back(j);
+        i = j;
+    }
+
+    // 结果在 a 和 temp 之间来回放；两者类型可能不同，所以按趟数的奇偶分开调用
+    bool inTemp = false;
+    while (runs.size() > 2)
+    {
+        if (inTemp)
+        {
+            mergePass(temp, a, runs, comp);
+        }
+        else
+        {
+            mergePass(a, temp, runs, comp);
+        }
+        inTemp = !inTemp;
+    }
+    if (inTemp)
+    {
+        std::copy(temp, temp + n, a);
+    }
+}
+
+template <typename T, typename Compare = std::less<>>
+void mergeSortBottomUp(std::vector<T> &nums, Compare comp = Compare())
+{
+    std::vector<T> temp(nums.size());
+    mergeSortBottomUp(nums.begin(), temp.begin(), (std::ptrdiff_t)nums.size(), comp);
+}
@@ -0,0 +1,501 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 不依赖第三方库的微基准框架，写法照着 Google Benchmark：
+//   static void bmFoo(microbench::State &state)
+//   {
+//       准备数据（不计时）
+//       for (auto _ : state) { 被测代码 }
+//       state.setItemsProcessed(state.iterations() * n);
+//   }
+//   MICROBENCH(bmFoo)->argsProduct({{1 << 10, 1 << 20}, {0, 1}});
+// 迭代次数自动放大，直到一轮跑满 --min-time 秒；循环里可以用 pauseTiming/resumeTiming 把每轮的准备工作排除在外。
+// Linux 上同时用 perf_event_open 读 cycles、instructions、cache-misses、branch-misses，按每个 item 平均输出；
+// 内核不允许（perf_event_paranoid 太高）或者虚拟机没有 PMU 时这几列输出 "-"，计时不受影响。
+// 命令行: --filter=子串  --min-time=秒  --csv
+namespace microbench
+{
+    // 阻止编译器把结果没被用到的计算整个删掉
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+    inline void clobberMemory()
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    // 一组硬件计数器，第一个是组长，一次 read 读出全部，四个值对应的是同一段时间
+    class PerfCounters
+    {
+    public:
+        static const int COUNT = 4;
+        static const char *name(int i)
+        {
+            static const char *names[COUNT] = {"cycles", "instr", "cache-miss", "branch-miss"};
+            return names[i];
+        }
+
+        PerfCounters() : ok_(false)
+        {
+            std::fill(fd_, fd_ + COUNT, -1);
+#if defined(__linux__)
+            const uint64_t configs[COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+            for (int i = 0; i < COUNT; i++)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[i];
+                attr.disabled = i == 0; // 组长关着，组员跟着组长一起开关
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                fd_[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd_[0], 0);
+                if (fd_[i] < 0)
+                {
+                    error_ = std::string(name(i)) + ": " + std::strerror(errno);
+                    close();
+                    return;
+                }
+            }
+            ok_ = true;
+#else
+            error_ = "只支持 Linux";
+#endif
+        }
+
+        ~PerfCounters() { close(); }
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        bool ok() const { return ok_; }
+        const std::string &error() const { return error_; }
+
+        void start()
+        {
+#if defined(__linux__)
+            if (ok_)
+            {
+                ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+        }
+
+        // 关掉计数器，把这段时间的计数加到 total 上
+        void stop(uint64_t *total)
+        {
+#if defined(__linux__)
+            if (!ok_)
+            {
+                return;
+            }
+            ioctl(fd_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t buf[1 + COUNT];
+            if (read(fd_[0], buf, sizeof(buf)) == (ssize_t)sizeof(buf))
+            {
+                for (int i = 0; i < COUNT; i++)
+                {
+                    total[i] += buf[1 + i];
+                }
+            }
+            ioctl(fd_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+#else
+            (void)total;
+#endif
+        }
+
+    private:
+        int fd_[COUNT];
+        bool ok_;
+        std::string error_;
+
+        void close()
+        {
+#if defined(__linux__)
+            for (int i = COUNT - 1; i >= 0; i--)
+            {
+                if (fd_[i] >= 0)
+                {
+                    ::close(fd_[i]);
+                    fd_[i] = -1;
+                }
+            }
+#endif
+        }
+    };
+
+    class State
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        State(const std::vector<int64_t> &args, int64_t iterations, PerfCounters &counters)
+            : args_(args), iterations_(iterations), items_(0), counters_(counters), elapsed_(0), running_(false)
+        {
+            std::fill(totals_, totals_ + PerfCounters::COUNT, 0);
+        }
+
+        int64_t range(size_t i = 0) const { return args_[i]; }
+        int64_t iterations() const { return iterations_; }
+        void setItemsProcessed(int64_t items) { items_ = items; }
+        void setLabel(const std::string &label) { label_ = label; }
+
+        void pauseTiming()
+        {
+            elapsed_ += Clock::now() - start_;
+            counters_.stop(totals_);
+            running_ = false;
+        }
+
+        void resumeTiming()
+        {
+            running_ = true;
+            counters_.start();
+            start_ = Clock::now();
+        }
+
+        // for (auto _ : state) 正好跑 iterations() 次，第一次进入循环时开始计时，循环结束时停止
+        struct Value
+        {
+            ~Value() {} // 析构函数不平凡，循环变量 _ 没被用到时编译器不报警告
+        };
+
+        class Iterator
+        {
+        public:
+            Iterator(State *state, int64_t left) : state_(state), left_(left) {}
+            Value operator*() const { return Value(); }
+            void operator++() { --left_; }
+            bool operator!=(const Iterator &) const
+            {
+                if (left_ > 0)
+                {
+                    return true;
+                }
+                state_->finish();
+                return false;
+            }
+
+        private:
+            State *state_;
+            int64_t left_;
+        };
+
+        Iterator begin()
+        {
+            resumeTiming();
+            return Iterator(this, iterations_);
+        }
+        Iterator end() { return Iterator(this, 0); }
+
+        double seconds() const { return std::chrono::duration<double>(elapsed_).count(); }
+        int64_t items() const { return items_; }
+        const std::string &label() const { return label_; }
+        const uint64_t *counters() const { return totals_; }
+
+    private:
+        std::vector<int64_t> args_;
+        int64_t iterations_;
+        int64_t items_;
+        std::string label_;
+        PerfCounters &counters_;
+        uint64_t totals_[PerfCounters::COUNT];
+        Clock::duration elapsed_;
+        Clock::time_point start_;
+        bool running_;
+
+        void finish()
+        {
+            if (running_)
+            {
+                pauseTiming();
+            }
+        }
+    };
+
+    class Benchmark
+    {
+    public:
+        Benchmark(const char *name, std::function<void(State &)> fn) : name_(name), fn_(std::move(fn)) {}
+
+        Benchmark *arg(int64_t a)
+        {
+            args_.push_back({a});
+            return this;
+        }
+
+        Benchmark *args(const std::vector<int64_t> &a)
+        {
+            args_.push_back(a);
+            return this;
+        }
+
+        // 每一维取一个值，所有维度的组合都跑一遍
+        Benchmark *argsProduct(const std::vector<std::vector<int64_t>> &dims)
+        {
+            std::vector<size_t> pick(dims.size(), 0);
+            while (true)
+            {
+                std::vector<int64_t> a;
+                for (size_t d = 0; d < dims.size(); d++)
+                {
+                    a.push_back(dims[d][pick[d]]);
+                }
+                args_.push_back(a);
+                size_t d = dims.size();
+                while (d > 0 && ++pick[d - 1] == dims[d - 1].size())
+                {
+                    pick[--d] = 0;
+                }
+                if (d == 0)
+                {
+                    return this;
+                }
+            }
+        }
+
+        const std::string &name() const { return name_; }
+        const std::vector<std::vector<int64_t>> &argSets() const { return args_; }
+        void run(State &state) const { fn_(state); }
+
+    private:
+        std::string name_;
+        std::function<void(State &)> fn_;
+        std::vector<std::vector<int64_t>> args_;
+    };
+
+    // lo, lo*mult, lo*mult^2, ... 直到 hi（hi 本身总会包含在内）
+    inline std::vector<int64_t> range(int64_t lo, int64_t hi, int64_t mult = 8)
+    {
+        std::vector<int64_t> values;
+        for (int64_t v = lo; v < hi; v *= mult)
+        {
+            values.push_back(v);
+        }
+        values.push_back(hi);
+        return values;
+    }
+
+    // 函数内的静态变量，保证别的翻译单元里的注册语句执行时它已经构造好了
+    inline std::vector<std::unique_ptr<Benchmark>> &registry()
+    {
+        static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+        return benchmarks;
+    }
+
+    inline Benchmark *registerBenchmark(const char *name, void (*fn)(State &))
+    {
+        registry().emplace_back(new Benchmark(name, fn));
+        return registry().back().get();
+    }
+
+    struct Options
+    {
+        std::string filter;
+        double minTime = 0.2;
+        bool csv = false;
+    };
+
+    inline std::string fullName(const Benchmark &b, const std::vector<int64_t> &args)
+    {
+        std::string name = b.name();
+        for (int64_t a : args)
+        {
+            name += "/" + std::to_string(a);
+        }
+        return name;
+    }
+
+    struct Result
+    {
+        int64_t iterations;
+        double seconds;
+        int64_t items;
+        uint64_t counters[PerfCounters::COUNT];
+        std::string label;
+    };
+
+    // 先跑 1 次，按耗时估计跑满 minTime 需要多少次，每次最多放大 10 倍，跑够时间的那一轮作为结果
+    inline Result measure(const Benchmark &b, const std::vector<int64_t> &args, double minTime, PerfCounters &counters)
+    {
+        int64_t iterations = 1;
+        while (true)
+        {
+            State state(args, iterations, counters);
+            b.run(state);
+            double s = state.seconds();
+            if (s >= minTime || iterations >= 1000000000)
+            {
+                Result r{iterations, s, state.items(), {}, state.label()};
+                std::copy(state.counters(), state.counters() + PerfCounters::COUNT, r.counters);
+                return r;
+            }
+            double scale = s > 0 ? minTime * 1.4 / s : 10.0;
+            iterations = std::max(iterations + 1, (int64_t)(iterations * std::min(10.0, scale)));
+        }
+    }
+
+    inline void printHeader(const Options &options)
+    {
+        if (options.csv)
+        {
+            std::printf("name,iterations,ns_per_iter,items_per_sec");
+            for (int i = 0; i < PerfCounters::COUNT; i++)
+            {
+                std::printf(",%s_per_item", PerfCounters::name(i));
+            }
+            std::printf(",label\n");
+            return;
+        }
+        // 计数器按每个 item 平均
+        std::printf("%-44s %12s %14s %12s", "benchmark", "iterations", "ns/iter", "items/s");
+        for (int i = 0; i < PerfCounters::COUNT; i++)
+        {
+            std::printf(" %12s", PerfCounters::name(i));
+        }
+        std::printf("\n");
+    }
+
+    inline void printResult(const std::string &name, const Result &r, const Options &options, bool hasCounters)
+    {
+        double nsPerIter = r.seconds * 1e9 / (double)r.iterations;
+        double itemsPerSec = r.items > 0 && r.seconds > 0 ? (double)r.items / r.seconds : 0;
+        double perItem = r.items > 0 ? (double)r.items : (double)r.iterations;
+        if (options.csv)
+        {
+            std::printf("%s,%lld,%.2f,%.0f", name.c_str(), (long long)r.iterations, nsPerIter, itemsPerSec);
+            for (int i = 0; i < PerfCounters::COUNT; i++)
+            {
+                if (hasCounters)
+                {
+                    std::printf(",%.3f", (double)r.counters[i] / perItem);
+                }
+                else
+                {
+                    std::printf(",");
+                }
+            }
+            std::printf(",%s\n", r.label.c_str());
+            return;
+        }
+        std::printf("%-44s %12lld %14.1f %12.4g", name.c_str(), (long long)r.iterations, nsPerIter, itemsPerSec);
+        for (int i = 0; i < PerfCounters::COUNT; i++)
+        {
+            if (hasCounters)
+            {
+                std::printf(" %12.3f", (double)r.counters[i] / perItem);
+            }
+            else
+            {
+                std::printf(" %12s", "-");
+            }
+        }
+        if (!r.label.empty())
+        {
+            std::printf(" %s", r.label.c_str());
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    inline bool parseOptions(int argc, char *argv[], Options &options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string a = argv[i];
+            if (a.compare(0, 9, "--filter=") == 0)
+            {
+                options.filter = a.substr(9);
+            }
+            else if (a.compare(0, 11, "--min-time=") == 0)
+            {
+                options.minTime = std::atof(a.c_str() + 11);
+            }
+            else if (a == "--csv")
+            {
+                options.csv = true;
+            }
+            else
+            {
+                std::fprintf(stderr, "用法: %s [--filter=子串] [--min-time=秒] [--csv]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline int runAll(int argc, char *argv[])
+    {
+        Options options;
+        if (!parseOptions(argc, argv, options))
+        {
+            return 1;
+        }
+        PerfCounters counters;
+        if (!counters.ok())
+        {
+            std::fprintf(stderr, "硬件计数器不可用（%s），只输出时间\n", counters.error().c_str());
+        }
+        printHeader(options);
+        int ran = 0;
+        for (const std::unique_ptr<Benchmark> &b : registry())
+        {
+            std::vector<std::vector<int64_t>> argSets = b->argSets();
+            if (argSets.empty())
+            {
+                argSets.push_back({});
+            }
+            for (const std::vector<int64_t> &args : argSets)
+            {
+                std::string name = fullName(*b, args);
+                if (name.find(options.filter) == std::string::npos)
+                {
+                    continue;
+                }
+                printResult(name, measure(*b, args, options.minTime, counters), options, counters.ok());
+                ran++;
+            }
+        }
+        if (ran == 0)
+        {
+            std::fprintf(stderr, "没有匹配 \"%s\" 的基准\n", options.filter.c_str());
+            return 1;
+        }
+        return 0;
+    }
+}
+
+#define MICROBENCH_CONCAT2(a, b) a##b
+#define MICROBENCH_CONCAT(a, b) MICROBENCH_CONCAT2(a, b)
+#define MICROBENCH(fn) \
+    static microbench::Benchmark *MICROBENCH_CONCAT(microbench_, __LINE__) = microbench::registerBenchmark(#fn, fn)
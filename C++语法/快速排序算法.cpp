@@ -2,76 +2,119 @@
 #include <vector>
 #include <string>
 #include <stack>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "任务池.h"
+#include "排序.h"
 using namespace std;
 
-int middle(int a, int b, int c)
+const int PARALLEL_GRAIN = 1 << 15; // 并行模式下小于这个长度的区间不再拆任务
+
+// 实现快速排序算法：闭区间 [left, right]，划分、内省排序和小区间的排序网络都在 排序.h 的泛型实现里，
+// 这里的比较器是 less<int>，编译期就能确定走排序网络和内联的 < 比较
+void QuickSort(vector<int> &nums, int left, int right)
 {
-    if ((a > b) ^ (a > c))
-    {
-        return a;
-    }
-    else if ((b < a) ^ (b < c))
-    {
-        return b;
-    }
-    else
+    if (left < right)
     {
-        return c;
+        sorting::introSort(nums.begin() + left, nums.begin() + right + 1, less<int>());
     }
 }
-// 实现快速排序算法
-void QuickSort(vector<int> &nums, int left, int right)
+
+// 并行快速排序：划分后较短的一侧作为任务交给任务池（可能被别的线程偷走），
+// 当前线程继续划分较长的一侧；区间小于 PARALLEL_GRAIN 时退回串行 introSort
+void parallelQuickSortTask(vector<int>::iterator first, vector<int>::iterator last, int depth, TaskPool &pool, TaskPool::Group &group)
 {
-    if (left >= right)
+    while (last - first > PARALLEL_GRAIN && depth > 0)
     {
-        return;
+        depth--;
+        auto mid = sorting::partition3(first, last, less<int>());
+        if (mid.first - first < last - mid.second)
+        {
+            auto lt = mid.first;
+            pool.spawn(group, [first, lt, depth, &pool, &group]
+                       { parallelQuickSortTask(first, lt, depth, pool, group); });
+            first = mid.second;
+        }
+        else
+        {
+            auto gt = mid.second;
+            pool.spawn(group, [gt, last, depth, &pool, &group]
+                       { parallelQuickSortTask(gt, last, depth, pool, group); });
+            last = mid.first;
+        }
     }
-    int i = left;
-    int j = right;
-    int key1 = nums[left];
-    int key2 = nums[right];
-    int key3 = nums[left + (right - left) / 2];
-    int key = middle(key1, key2, key3);
-    if (key == key2)
+    sorting::introSortLoop(first, last, depth, less<int>());
+}
+
+void parallelQuickSort(vector<int> &nums, TaskPool &pool)
+{
+    TaskPool::Group group;
+    parallelQuickSortTask(nums.begin(), nums.end(), sorting::depthLimit((ptrdiff_t)nums.size()), pool, group);
+    pool.wait(group);
+}
+
+void benchInput(const char *name, const vector<int> &data, TaskPool &pool)
+{
+    int n = (int)data.size();
+    vector<int> expect(data);
+    auto start = chrono::steady_clock::now();
+    sort(expect.begin(), expect.end());
+    double stdTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<int> nums(data);
+    start = chrono::steady_clock::now();
+    QuickSort(nums, 0, n - 1);
+    double seqTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    nums = data;
+    start = chrono::steady_clock::now();
+    parallelQuickSort(nums, pool);
+    double parTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << name << endl;
+    cout << "  std::sort          " << stdTime << " s" << endl;
+    cout << "  QuickSort          " << seqTime << " s" << endl;
+    cout << "  parallelQuickSort  " << parTime << " s  加速比 " << seqTime / parTime << endl;
+    if (nums != expect)
     {
-        swap(nums[left], nums[right]);
+        cout << "  结果错误" << endl;
     }
-    else if (key == key3)
+}
+
+// 压测：./a.out bench [n] [threads]，默认 1 亿个数、全部核心；
+// 分别测随机、大量重复、已排序三种输入
+void bench(int n, unsigned threads)
+{
+    TaskPool pool(threads);
+    cout << n << " 个元素, " << pool.threadCount() << " 线程" << endl;
+    vector<int> data(n);
+    mt19937 rng(12345);
+    for (int &x : data)
     {
-        swap(nums[left + (right - left) / 2], nums[left]);
+        x = (int)rng();
     }
-
-    while (i < j)
+    benchInput("随机", data, pool);
+    for (int &x : data)
     {
-        while (i < j && nums[j] >= key)
-        {
-            j--;
-        }
-        if (i < j)
-        {
-            nums[i] = nums[j];
-            i++;
-        }
-        while (i < j && nums[i] <= key)
-        {
-            i++;
-        }
-        if (i < j)
-        {
-            nums[j] = nums[i];
-            j--;
-        }
-        if (i == j)
-        {
-            nums[i] = key;
-        }
+        x = (int)(rng() % 100);
     }
-    QuickSort(nums, left, i - 1);
-    QuickSort(nums, i + 1, right);
+    benchInput("只有 100 种取值", data, pool);
+    sort(data.begin(), data.end());
+    benchInput("已排序", data, pool);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        int n = argc > 2 ? atoi(argv[2]) : 100000000;
+        unsigned threads = argc > 3 ? (unsigned)atoi(argv[3]) : thread::hardware_concurrency();
+        bench(n, threads);
+        return 0;
+    }
     vector<int> nums = {1, 2, 3, 56, 5, 6, 7, 8, 99, 45, 213, 2, 1, 67};
     QuickSort(nums, 0, nums.size() - 1);
     for (int i = 0; i < nums.size(); i++)
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include "排序.h"
+using namespace std;
+
+// 泛型排序接口的演示和压测：./a.out bench [n]，默认 5000000 个元素
+//   int      sorting::sort 在编译期选中基数排序；
+//   结构体   比较器是 lambda 时比较内联，换成 std::function / 函数指针就退回间接调用；
+//   sortByKey 按结构体里的整数键直接分桶，不用先拷成 int 数组再排。
+
+struct Order
+{
+    uint32_t userId;
+    double amount;
+};
+
+bool lessByUser(const Order &a, const Order &b)
+{
+    return a.userId < b.userId;
+}
+
+template <typename T, typename Sort>
+double timeSort(vector<T> data, Sort sortFunc, vector<T> &result)
+{
+    auto start = chrono::steady_clock::now();
+    sortFunc(data);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.swap(data);
+    return seconds;
+}
+
+void bench(size_t n)
+{
+    mt19937 rng(12345);
+    vector<int> keys(n);
+    vector<Order> orders(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        keys[i] = (int)rng();
+        orders[i].userId = rng() % 100000;
+        orders[i].amount = (double)i; // 原始位置，顺带验证稳定性
+    }
+    cout << n << " 个元素" << endl;
+
+    vector<int> expectInt, gotInt;
+    double stdInt = timeSort(keys, [](vector<int> &v)
+                             { std::sort(v.begin(), v.end()); },
+                             expectInt);
+    double ourInt = timeSort(keys, [](vector<int> &v)
+                             { sorting::sort(v.begin(), v.end()); },
+                             gotInt);
+    cout << "int      std::sort " << stdInt << " s  sorting::sort " << ourInt << " s"
+         << (gotInt == expectInt ? "" : "  结果错误") << endl;
+
+    // 同一个比较逻辑的三种写法
+    auto byUser = [](const Order &a, const Order &b)
+    {
+        return a.userId < b.userId;
+    };
+    function<bool(const Order &, const Order &)> erased = byUser;
+    vector<Order> expect, got;
+    double stdStable = timeSort(orders, [&](vector<Order> &v)
+                                { std::stable_sort(v.begin(), v.end(), byUser); },
+                                expect);
+    auto sameAsExpect = [&expect](const vector<Order> &v)
+    {
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            if (v[i].userId != expect[i].userId || v[i].amount != expect[i].amount)
+            {
+                return false;
+            }
+        }
+        return v.size() == expect.size();
+    };
+    const char *wrong = "  结果错误";
+    double lambdaTime = timeSort(orders, [&](vector<Order> &v)
+                                 { sorting::stableSort(v.begin(), v.end(), byUser); },
+                                 got);
+    bool lambdaOk = sameAsExpect(got);
+    double erasedTime = timeSort(orders, [&](vector<Order> &v)
+                                 { sorting::stableSort(v.begin(), v.end(), erased); },
+                                 got);
+    bool erasedOk = sameAsExpect(got);
+    double pointerTime = timeSort(orders, [](vector<Order> &v)
+                                  { sorting::stableSort(v.begin(), v.end(), lessByUser); },
+                                  got);
+    bool pointerOk = sameAsExpect(got);
+    double keyTime = timeSort(orders, [](vector<Order> &v)
+                              { sorting::sortByKey(v.begin(), v.end(), [](const Order &o)
+                                                   { return o.userId; }); },
+                              got);
+    bool keyOk = sameAsExpect(got);
+    cout << "Order    std::stable_sort " << stdStable << " s" << endl;
+    cout << "  stableSort + lambda        " << lambdaTime << " s" << (lambdaOk ? "" : wrong) << endl;
+    cout << "  stableSort + std::function " << erasedTime << " s" << (erasedOk ? "" : wrong) << endl;
+    cout << "  stableSort + 函数指针       " << pointerTime << " s" << (pointerOk ? "" : wrong) << endl;
+    cout << "  sortByKey(userId)          " << keyTime << " s" << (keyOk ? "" : wrong) << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? strtoul(argv[2], nullptr, 10) : 5000000);
+        return 0;
+    }
+    vector<int> nums = {5, -3, 8, 0, 2, 2, -7, 9};
+    sorting::sort(nums.begin(), nums.end());
+    for (int x : nums)
+    {
+        cout << x << " ";
+    }
+    cout << endl;
+
+    vector<string> words = {"pear", "apple", "fig", "banana", "kiwi"};
+    sorting::sort(words.begin(), words.end(), [](const string &a, const string &b)
+                  { return a.size() < b.size() || (a.size() == b.size() && a < b); });
+    for (const string &w : words)
+    {
+        cout << w << " ";
+    }
+    cout << endl;
+
+    vector<Order> orders = {{3, 9.5}, {1, 20.0}, {3, 1.5}, {2, 7.0}};
+    sorting::sortByKey(orders.begin(), orders.end(), [](const Order &o)
+                       { return o.userId; });
+    for (const Order &o : orders)
+    {
+        cout << o.userId << ":" << o.amount << " ";
+    }
+    cout << endl;
+    return 0;
+}
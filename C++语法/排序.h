@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include "排序特征.h"
+#include "排序网络.h"
+#include "堆排序.h"
+#include "归并排序算法.h"
+#include "基数排序算法.h"
+
+// 泛型排序入口：迭代器、元素类型和比较器都是模板参数，比较直接内联进内循环。
+//   sorting::sort        不稳定，默认升序的整数走基数排序，其余走内省排序；
+//   sorting::stableSort  稳定，默认升序的整数走基数排序，其余走自底向上归并排序；
+//   sorting::sortByKey   按 keyOf 取出的键稳定排序，键是整数时直接按键分桶，结构体不用先拆成 int 数组。
+// 选哪种实现在编译期用 if constexpr 决定，没用到的分支不会实例化，也不会有运行时判断。
+// 基数排序和归并排序需要一块与输入等长的临时区，元素类型要能默认构造。
+namespace sorting
+{
+    const std::ptrdiff_t RADIX_SORT_MIN = 256; // 比这短的整数数组，直方图的开销比比较排序还大
+
+    // 三个值里居中的那个
+    template <typename T, typename Compare>
+    const T &median3(const T &a, const T &b, const T &c, Compare comp)
+    {
+        if (comp(b, a) ^ comp(c, a))
+        {
+            return a;
+        }
+        else if (comp(b, a) ^ comp(b, c))
+        {
+            return b;
+        }
+        else
+        {
+            return c;
+        }
+    }
+
+    // 三数取中选基准，三路划分（荷兰国旗）：
+    // 返回 (lt, gt)，[first, lt) 排在基准前面，[lt, gt) 与基准相等，[gt, last) 排在基准后面；
+    // 等于基准的元素不再参与递归，大量重复值时区间迅速缩小，不会退化成 O(n^2)
+    template <typename RandomIt, typename Compare>
+    std::pair<RandomIt, RandomIt> partition3(RandomIt first, RandomIt last, Compare comp)
+    {
+        ValueOf<RandomIt> key = median3(*first, *(last - 1), *(first + (last - first) / 2), comp);
+        RandomIt lt = first;
+        RandomIt gt = last;
+        RandomIt i = first;
+        while (i < gt)
+        {
+            if (comp(*i, key))
+            {
+                std::iter_swap(lt++, i++);
+            }
+            else if (comp(key, *i))
+            {
+                std::iter_swap(i, --gt);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        return std::make_pair(lt, gt);
+    }
+
+    // 递归深度上限 2 * log2(n)
+    inline int depthLimit(std::ptrdiff_t n)
+    {
+        int depth = 0;
+        while (n > 1)
+        {
+            n >>= 1;
+            depth++;
+        }
+        return depth * 2;
+    }
+
+    // 内省排序：快速排序递归超过 depth 层说明基准一直选得很差，剩下的区间改用堆排序，保证 O(n log n)；
+    // 只递归较短的一侧，较长的一侧在循环里继续（尾递归消除），栈深度不超过 log n
+    template <typename RandomIt, typename Compare>
+    void introSortLoop(RandomIt first, RandomIt last, int depth, Compare comp)
+    {
+        while (last - first > smallSortThreshold<RandomIt, Compare>())
+        {
+            if (depth == 0)
+            {
+                heapSort(first, last, comp);
+                return;
+            }
+            depth--;
+            std::pair<RandomIt, RandomIt> mid = partition3(first, last, comp);
+            if (mid.first - first < last - mid.second)
+            {
+                introSortLoop(first, mid.first, depth, comp);
+                first = mid.second;
+            }
+            else
+            {
+                introSortLoop(mid.second, last, depth, comp);
+                last = mid.first;
+            }
+        }
+        smallSort(first, last, comp);
+    }
+
+    template <typename RandomIt, typename Compare = std::less<>>
+    void introSort(RandomIt first, RandomIt last, Compare comp = Compare())
+    {
+        introSortLoop(first, last, depthLimit(last - first), comp);
+    }
+
+    template <typename RandomIt, typename Compare = std::less<>>
+    void sort(RandomIt first, RandomIt last, Compare comp = Compare())
+    {
+        if constexpr (IsRadixSortable<RandomIt, Compare>::value)
+        {
+            std::ptrdiff_t n = last - first;
+            if (n >= RADIX_SORT_MIN)
+            {
+                typedef ValueOf<RandomIt> T;
+                std::vector<T> scratch(n);
+                radixSortBy<8>(toPointer(first), scratch.data(), (size_t)n, [](T key)
+                               { return key; });
+                return;
+            }
+        }
+        introSort(first, last, comp);
+    }
+
+    template <typename RandomIt, typename Compare = std::less<>>
+    void stableSort(RandomIt first, RandomIt last, Compare comp = Compare())
+    {
+        std::ptrdiff_t n = last - first;
+        if constexpr (IsRadixSortable<RandomIt, Compare>::value)
+        {
+            if (n >= RADIX_SORT_MIN)
+            {
+                sorting::sort(first, last, comp); // 整数相等就是完全相同，基数排序稳不稳定都一样
+                return;
+            }
+        }
+        std::vector<ValueOf<RandomIt>> temp(n);
+        mergeSortBottomUp(first, temp.begin(), n, comp);
+    }
+
+    // 按 keyOf(元素) 升序稳定排序
+    template <typename RandomIt, typename KeyOf>
+    void sortByKey(RandomIt first, RandomIt last, KeyOf keyOf)
+    {
+        typedef ValueOf<RandomIt> T;
+        typedef typename std::decay<decltype(keyOf(*first))>::type Key;
+        std::ptrdiff_t n = last - first;
+        if constexpr (std::is_integral<Key>::value && !std::is_same<Key, bool>::value && IsContiguous<RandomIt>::value)
+        {
+            if (n >= RADIX_SORT_MIN)
+            {
+                std::vector<T> scratch(n);
+                radixSortBy<8>(toPointer(first), scratch.data(), (size_t)n, keyOf);
+                return;
+            }
+        }
+        std::vector<T> temp(n);
+        mergeSortBottomUp(first, temp.begin(), n, [&keyOf](const T &a, const T &b)
+                          { return keyOf(a) < keyOf(b); });
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// 排序算法共用的编译期判断：比较器是不是默认的升序、迭代器背后是不是一块连续内存。
+// 排序入口据此用 if constexpr 选实现——默认升序的整数走基数排序或排序网络，其余走比较排序；
+// 比较器作为模板参数传进来，比较调用在编译期就能内联，不经过函数指针或 std::function。
+namespace sorting
+{
+    template <typename It>
+    using ValueOf = typename std::iterator_traits<It>::value_type;
+
+    // Compare 对 T 来说是不是普通的 < 比较
+    template <typename Compare, typename T>
+    struct IsDefaultLess : std::false_type
+    {
+    };
+    template <typename T>
+    struct IsDefaultLess<std::less<T>, T> : std::true_type
+    {
+    };
+    template <typename T>
+    struct IsDefaultLess<std::less<>, T> : std::true_type
+    {
+    };
+
+    // 指针和 vector 的迭代器指向连续内存，可以直接取地址交给按指针工作的引擎；vector<bool> 除外
+    template <typename It>
+    struct IsContiguous
+        : std::integral_constant<bool, std::is_pointer<It>::value ||
+                                           (!std::is_same<ValueOf<It>, bool>::value &&
+                                            std::is_same<It, typename std::vector<ValueOf<It>>::iterator>::value)>
+    {
+    };
+
+    // 默认升序的内置整数（bool 除外）可以按位分桶，不需要比较
+    template <typename It, typename Compare>
+    struct IsRadixSortable
+        : std::integral_constant<bool, std::is_integral<ValueOf<It>>::value && !std::is_same<ValueOf<It>, bool>::value &&
+                                           IsDefaultLess<Compare, ValueOf<It>>::value && IsContiguous<It>::value>
+    {
+    };
+
+    // 连续存放、默认升序的 int 可以交给排序网络
+    template <typename It, typename Compare>
+    struct IsNetworkSortable
+        : std::integral_constant<bool, std::is_same<ValueOf<It>, int>::value &&
+                                           IsDefaultLess<Compare, int>::value && IsContiguous<It>::value>
+    {
+    };
+
+    template <typename It>
+    ValueOf<It> *toPointer(It it)
+    {
+        return std::addressof(*it);
+    }
+}
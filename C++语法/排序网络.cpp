@@ -0,0 +1,75 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <cstdlib>
+#include "排序网络.h"
+
+// 小数组排序压测：8/16/32/64 个元素，排序网络 vs 插入排序 vs std::sort
+// 编译: g++ -O2 -march=native 排序网络.cpp，用法: ./a.out [arrays]，默认每种规模 1000000 组
+
+static void insertionSort(int *a, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        int key = a[i];
+        int j = i - 1;
+        while (j >= 0 && a[j] > key)
+        {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = key;
+    }
+}
+
+template <typename Sort>
+static double timeSort(const std::vector<int> &data, int size, Sort sortFunc, long long &checksum)
+{
+    std::vector<int> work(data);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t off = 0; off + size <= work.size(); off += size)
+    {
+        sortFunc(work.data() + off, size);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // 每组的第一个和最后一个元素参与校验，防止编译器把排序优化掉，也顺便检查结果一致
+    checksum = 0;
+    for (size_t off = 0; off + size <= work.size(); off += size)
+    {
+        checksum += work[off] - (long long)work[off + size - 1] * 3;
+    }
+    return seconds;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t arrays = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    std::cout << "寄存器宽度 " << sortnet::Vec::LANES << " 个 int, 每种规模 " << arrays << " 组" << std::endl;
+    std::mt19937 rng(12345);
+    for (int size = 8; size <= SORT_NETWORK_MAX; size *= 2)
+    {
+        std::vector<int> data(arrays * size);
+        for (int &x : data)
+        {
+            x = (int)rng();
+        }
+        long long sumNet, sumIns, sumStd;
+        double net = timeSort(data, size, sortNetwork, sumNet);
+        double ins = timeSort(data, size, insertionSort, sumIns);
+        double stdTime = timeSort(data, size, [](int *a, int n)
+                                  { std::sort(a, a + n); },
+                                  sumStd);
+        std::cout << std::setw(3) << size << " 个元素  network " << std::fixed << std::setprecision(1)
+                  << std::setw(7) << net / arrays * 1e9 << " ns  insertion " << std::setw(7) << ins / arrays * 1e9
+                  << " ns  std::sort " << std::setw(7) << stdTime / arrays * 1e9 << " ns  加速比 "
+                  << std::setprecision(2) << ins / net << std::endl;
+        if (sumNet != sumIns || sumNet != sumStd)
+        {
+            std::cout << "结果不一致" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,359 @@
+#pragma once
+#include <climits>
+#include <algorithm>
+#include <utility>
+#include "排序特征.h"
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// 小数组排序网络：最多 64 个 int，给快速排序、归并排序、基数排序当叶子排序用。
+// 用的是双调排序网络（翻转 + 半清洗器的写法），比较序列固定、没有数据相关的分支：
+//   1. 数据按寄存器宽度装进 M 个向量寄存器（不足的用 INT_MAX 补齐，M 取 2 的幂）；
+//   2. 每个寄存器先在寄存器内部排好（lane 之间用 shuffle + min/max + blend 比较交换）；
+//   3. 再两两合并：前一半第 i 个与后一半倒数第 i 个比较（翻转），然后逐级做距离减半的半清洗器，
+//      距离不小于寄存器宽度时是整个寄存器之间的 min/max，小于时回到寄存器内部。
+// AVX-512 一次比较 16 个、AVX2 8 个、NEON 4 个；都没有时退化成标量 min/max（编译成 cmov），照样没有分支。
+namespace sortnet
+{
+    static const int SORT_NETWORK_MAX = 64;
+
+#if defined(__AVX512F__)
+// GCC 12 的 avx512fintrin.h 里，不带掩码的 shuffle/permute 也是调用带掩码的内建函数，直通操作数传
+// _mm512_undefined_epi32()（自己给自己赋值的未初始化变量）再配全 1 掩码，内联进来后每处都报
+// -W(maybe-)uninitialized。这是头文件的误报，只在 AVX-512 这一段里关掉
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    struct Vec
+    {
+        typedef __m512i Reg;
+        static const int LANES = 16;
+
+        static Reg load(const int *p) { return _mm512_loadu_si512(p); }
+        static void store(int *p, Reg v) { _mm512_storeu_si512(p, v); }
+        static Reg min(Reg a, Reg b) { return _mm512_min_epi32(a, b); }
+        static Reg max(Reg a, Reg b) { return _mm512_max_epi32(a, b); }
+        static Reg reverse(Reg v)
+        {
+            return _mm512_permutexvar_epi32(_mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), v);
+        }
+
+        // 与 partner 比较交换，mask 中为 1 的 lane 取较大值
+        static Reg exchange(Reg v, Reg partner, __mmask16 mask)
+        {
+            return _mm512_mask_blend_epi32(mask, _mm512_min_epi32(v, partner), _mm512_max_epi32(v, partner));
+        }
+
+        // 寄存器内的半清洗器：距离 8、4、2、1
+        static Reg cleanLanes(Reg v)
+        {
+            v = exchange(v, _mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(1, 0, 3, 2)), 0xFF00);
+            v = exchange(v, _mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(2, 3, 0, 1)), 0xF0F0);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)), 0xCCCC);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+            return v;
+        }
+
+        // 寄存器内完整排序：组大小 2、4、8、16 依次翻转，每次翻转后接更小距离的半清洗器
+        static Reg sortLanes(Reg v)
+        {
+            const Reg flip8 = _mm512_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(0, 1, 2, 3)), 0xCCCC);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+
+            v = exchange(v, _mm512_permutexvar_epi32(flip8, v), 0xF0F0);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)), 0xCCCC);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+
+            v = exchange(v, reverse(v), 0xFF00);
+            v = exchange(v, _mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(2, 3, 0, 1)), 0xF0F0);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2)), 0xCCCC);
+            v = exchange(v, _mm512_shuffle_epi32(v, (_MM_PERM_ENUM)_MM_SHUFFLE(2, 3, 0, 1)), 0xAAAA);
+            return v;
+        }
+    };
+#pragma GCC diagnostic pop
+#elif defined(__AVX2__)
+    struct Vec
+    {
+        typedef __m256i Reg;
+        static const int LANES = 8;
+
+        static Reg load(const int *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(int *p, Reg v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+        static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+        static Reg reverse(Reg v)
+        {
+            return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+        }
+
+        // 与 partner 比较交换，MASK 中为 1 的 lane 取较大值
+        template <int MASK>
+        static Reg exchange(Reg v, Reg partner)
+        {
+            return _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), MASK);
+        }
+
+        // 寄存器内的半清洗器：距离 4、2、1
+        static Reg cleanLanes(Reg v)
+        {
+            v = exchange<0xF0>(v, _mm256_permute2x128_si256(v, v, 0x01));
+            v = exchange<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return v;
+        }
+
+        // 寄存器内完整排序：组大小 2、4、8 依次翻转，每次翻转后接更小距离的半清洗器
+        static Reg sortLanes(Reg v)
+        {
+            v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            v = exchange<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+            v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            v = exchange<0xF0>(v, reverse(v));
+            v = exchange<0xCC>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+            v = exchange<0xAA>(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return v;
+        }
+    };
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    struct Vec
+    {
+        typedef int32x4_t Reg;
+        static const int LANES = 4;
+
+        static Reg load(const int *p) { return vld1q_s32(p); }
+        static void store(int *p, Reg v) { vst1q_s32(p, v); }
+        static Reg min(Reg a, Reg b) { return vminq_s32(a, b); }
+        static Reg max(Reg a, Reg b) { return vmaxq_s32(a, b); }
+        static Reg reverse(Reg v)
+        {
+            Reg r = vrev64q_s32(v);
+            return vextq_s32(r, r, 2);
+        }
+
+        // 与 partner 比较交换，mask 中为全 1 的 lane 取较大值
+        static Reg exchange(Reg v, Reg partner, uint32x4_t mask)
+        {
+            return vbslq_s32(mask, vmaxq_s32(v, partner), vminq_s32(v, partner));
+        }
+        static uint32x4_t oddLanes()
+        {
+            static const uint32_t bits[4] = {0, ~0u, 0, ~0u};
+            return vld1q_u32(bits);
+        }
+        static uint32x4_t upperLanes()
+        {
+            static const uint32_t bits[4] = {0, 0, ~0u, ~0u};
+            return vld1q_u32(bits);
+        }
+
+        // 寄存器内的半清洗器：距离 2、1
+        static Reg cleanLanes(Reg v)
+        {
+            v = exchange(v, vextq_s32(v, v, 2), upperLanes());
+            v = exchange(v, vrev64q_s32(v), oddLanes());
+            return v;
+        }
+
+        // 寄存器内完整排序：组大小 2、4 依次翻转
+        static Reg sortLanes(Reg v)
+        {
+            v = exchange(v, vrev64q_s32(v), oddLanes());
+            v = exchange(v, reverse(v), upperLanes());
+            v = exchange(v, vrev64q_s32(v), oddLanes());
+            return v;
+        }
+    };
+#else
+    // 标量版本：一个“寄存器”就是一个 int，寄存器内部的步骤都是空操作
+    struct Vec
+    {
+        typedef int Reg;
+        static const int LANES = 1;
+
+        static Reg load(const int *p) { return *p; }
+        static void store(int *p, Reg v) { *p = v; }
+        static Reg min(Reg a, Reg b) { return a < b ? a : b; }
+        static Reg max(Reg a, Reg b) { return a < b ? b : a; }
+        static Reg reverse(Reg v) { return v; }
+        static Reg cleanLanes(Reg v) { return v; }
+        static Reg sortLanes(Reg v) { return v; }
+    };
+#endif
+
+    typedef Vec::Reg Reg;
+
+    // M 个寄存器组成的双调序列，逐级半清洗后整体有序
+    template <int M>
+    struct Cleaner
+    {
+        static void run(Reg *r)
+        {
+            for (int i = 0; i < M / 2; i++)
+            {
+                Reg lo = Vec::min(r[i], r[i + M / 2]);
+                Reg hi = Vec::max(r[i], r[i + M / 2]);
+                r[i] = lo;
+                r[i + M / 2] = hi;
+            }
+            Cleaner<M / 2>::run(r);
+            Cleaner<M / 2>::run(r + M / 2);
+        }
+    };
+    template <>
+    struct Cleaner<1>
+    {
+        static void run(Reg *r)
+        {
+            r[0] = Vec::cleanLanes(r[0]);
+        }
+    };
+
+    // M 个寄存器整体排序：两半分别排好，翻转比较后各自半清洗
+    template <int M>
+    struct Network
+    {
+        static void sort(Reg *r)
+        {
+            Network<M / 2>::sort(r);
+            Network<M / 2>::sort(r + M / 2);
+            for (int i = 0; i < M / 2; i++)
+            {
+                Reg partner = Vec::reverse(r[M - 1 - i]);
+                Reg lo = Vec::min(r[i], partner);
+                Reg hi = Vec::max(r[i], partner);
+                r[i] = lo;
+                r[M - 1 - i] = Vec::reverse(hi);
+            }
+            Cleaner<M / 2>::run(r);
+            Cleaner<M / 2>::run(r + M / 2);
+        }
+    };
+    template <>
+    struct Network<1>
+    {
+        static void sort(Reg *r)
+        {
+            r[0] = Vec::sortLanes(r[0]);
+        }
+    };
+
+    template <int M>
+    inline void sortRegisters(int *buf)
+    {
+        Reg r[M];
+        for (int i = 0; i < M; i++)
+        {
+            r[i] = Vec::load(buf + i * Vec::LANES);
+        }
+        Network<M>::sort(r);
+        for (int i = 0; i < M; i++)
+        {
+            Vec::store(buf + i * Vec::LANES, r[i]);
+        }
+    }
+
+    // 按寄存器个数选择展开好的网络，M 从最大规模往下找
+    template <int M>
+    struct Dispatch
+    {
+        static void run(int *buf, int regs)
+        {
+            if (regs > M / 2)
+            {
+                sortRegisters<M>(buf);
+            }
+            else
+            {
+                Dispatch<M / 2>::run(buf, regs);
+            }
+        }
+    };
+    template <>
+    struct Dispatch<1>
+    {
+        static void run(int *buf, int)
+        {
+            sortRegisters<1>(buf);
+        }
+    };
+
+    // 排序 a[0, n)，n 不超过 SORT_NETWORK_MAX；先拷到栈上补齐成 2 的幂个寄存器
+    inline void sortNetwork(int *a, int n)
+    {
+        if (n < 2)
+        {
+            return;
+        }
+        alignas(64) int buf[SORT_NETWORK_MAX];
+        int regs = 1;
+        while (regs * Vec::LANES < n)
+        {
+            regs *= 2;
+        }
+        std::copy(a, a + n, buf);
+        std::fill(buf + n, buf + regs * Vec::LANES, INT_MAX);
+        Dispatch<SORT_NETWORK_MAX / Vec::LANES>::run(buf, regs);
+        std::copy(buf, buf + n, a);
+    }
+}
+
+using sortnet::SORT_NETWORK_MAX;
+using sortnet::sortNetwork;
+
+namespace sorting
+{
+    // 插入排序 [first, last)：比较器任意，元素整体后移一次到位，不逐个交换
+    template <typename It, typename Compare>
+    void insertionSort(It first, It last, Compare comp)
+    {
+        if (first == last)
+        {
+            return;
+        }
+        for (It i = first + 1; i != last; ++i)
+        {
+            ValueOf<It> key = std::move(*i);
+            It j = i;
+            while (j != first && comp(key, *(j - 1)))
+            {
+                *j = std::move(*(j - 1));
+                --j;
+            }
+            *j = std::move(key);
+        }
+    }
+
+    // 小区间的叶子排序交给谁、区间多长时交：连续存放的升序 int 用排序网络，其余用插入排序
+    template <typename It, typename Compare>
+    constexpr int smallSortThreshold()
+    {
+        return IsNetworkSortable<It, Compare>::value ? SORT_NETWORK_MAX : 16;
+    }
+
+    // 排序 [first, last)，长度不超过 SORT_NETWORK_MAX
+    template <typename It, typename Compare>
+    void smallSort(It first, It last, Compare comp)
+    {
+        if (last - first < 2)
+        {
+            return; // 空区间不能取首元素地址
+        }
+        if constexpr (IsNetworkSortable<It, Compare>::value)
+        {
+            sortNetwork(toPointer(first), (int)(last - first));
+        }
+        else
+        {
+            insertionSort(first, last, comp);
+        }
+    }
+}
@@ -1,4 +1,9 @@
 #include <iostream>
+#include <stack>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "分段栈.h"
 
 class mystack
 {
@@ -40,8 +45,63 @@ private:
     int capacity;
 };
 
-int main()
+template <typename Stack>
+long long deepRun(int depth)
 {
+    Stack s;
+    for (int i = 0; i < depth; i++)
+    {
+        s.push(i);
+    }
+    long long sum = 0;
+    while (!s.empty())
+    {
+        sum += s.top();
+        s.pop();
+    }
+    return sum;
+}
+
+// mystack 没有 top/empty 的 std 风格接口，包一层
+struct MyStackAdapter
+{
+    mystack s;
+    void push(int v) { s.push(v); }
+    void pop() { s.pop(); }
+    int top() { return s.gettop(); }
+    bool empty() { return s.isempty(); }
+};
+
+template <typename Stack>
+void timeStack(const char *name, int deep, int rounds)
+{
+    auto start = std::chrono::steady_clock::now();
+    long long sum = deepRun<Stack>(deep);
+    double deepTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        sum += deepRun<Stack>(16); // 浅栈：每次新建一个栈，只压 16 个
+    }
+    double shallowTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << "深栈 " << deepTime << " s  浅栈 " << shallowTime << " s  (" << sum % 1000 << ")" << std::endl;
+}
+
+// 压测：./a.out bench [deep] [rounds]，默认压 10000000 个再弹空，以及 1000000 次 16 层的浅栈
+void bench(int deep, int rounds)
+{
+    timeStack<MyStackAdapter>("mystack        ", deep, rounds);
+    timeStack<std::stack<int>>("std::stack     ", deep, rounds);
+    timeStack<SegmentedStack<int>>("SegmentedStack ", deep, rounds);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? atoi(argv[2]) : 10000000, argc > 3 ? atoi(argv[3]) : 1000000);
+        return 0;
+    }
     mystack s;
     for (int i = 0; i < 15; i++)
     {
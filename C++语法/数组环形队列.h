@@ -0,0 +1,81 @@
+#pragma once
+#include <iostream>
+#include <algorithm>
+#include "无锁环形队列.h"
+
+// 单线程环形队列：容量取 2 的幂，下标用 & mask 回绕，不做除法
+class Queue
+{
+public:
+    Queue(int size) : size((int)ringCapacity(size)), mask(this->size - 1), arr(new int[this->size]), front(0), rear(0) {};
+    ~Queue() { delete[] arr; }
+    void push(int value)
+    {
+        if (((rear + 1) & mask) == front)
+        {
+            expand(size * 2);
+        }
+        arr[rear] = value;
+        rear = (rear + 1) & mask;
+    }
+
+    int pop()
+    {
+        if (isEmpty())
+        {
+            return -1;
+        }
+        int top = arr[front];
+        front = (front + 1) & mask;
+        return top;
+    }
+
+    int top() const { return arr[front]; }
+
+    int back() const { return arr[(rear - 1) & mask]; }
+
+    int getFront() { return arr[front]; }
+
+    bool isEmpty() { return front == rear; }
+
+    bool isFull() { return ((rear + 1) & mask) == front; }
+
+    void show()
+    {
+        for (int i = front; i != rear; i = (i + 1) & mask)
+        {
+            std::cout << arr[i] << " ";
+        }
+        std::cout << std::endl;
+    }
+
+private:
+    int size; // 总是 2 的幂
+    int mask;
+    int *arr;
+    int front;
+    int rear;
+
+    // 只由 push 在满时调用：newSize 必须是 2 的幂且放得下全部元素，mask 下标依赖这一点。
+    // 元素最多分成 [front, size) 和 [0, rear) 两段，各拷贝一次
+    void expand(int newSize)
+    {
+        int *newArr = new int[newSize];
+        int count;
+        if (front <= rear)
+        {
+            count = (int)(std::copy(arr + front, arr + rear, newArr) - newArr);
+        }
+        else
+        {
+            int *out = std::copy(arr + front, arr + size, newArr);
+            count = (int)(std::copy(arr, arr + rear, out) - newArr);
+        }
+        delete[] arr;
+        arr = newArr;
+        front = 0;
+        rear = count;
+        size = newSize;
+        mask = newSize - 1;
+    }
+};
@@ -0,0 +1,225 @@
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <iomanip>
+#include "无锁环形队列.h"
+
+// 线程间传递压测：生产者按顺序发 0..n-1，消费者收完后校验总和（SPSC 还校验顺序）
+// 对比 mutex + std::queue、逐个 tryPush/tryPop、每批 BATCH 个的 pushN/popN
+// 用法: ./a.out [n]，默认每轮 10000000 个元素；满或空时 yield，单核机器上也能推进
+
+const size_t RING_SIZE = 1 << 14;
+const size_t BATCH = 64;
+
+class MutexQueue
+{
+public:
+    explicit MutexQueue(size_t)
+    {
+    }
+
+    bool tryPush(long long value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push(value);
+        return true;
+    }
+
+    bool tryPop(long long &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty())
+        {
+            return false;
+        }
+        out = items.front();
+        items.pop();
+        return true;
+    }
+
+    size_t pushN(const long long *values, size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < n; i++)
+        {
+            items.push(values[i]);
+        }
+        return n;
+    }
+
+    size_t popN(long long *out, size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = 0;
+        while (count < n && !items.empty())
+        {
+            out[count++] = items.front();
+            items.pop();
+        }
+        return count;
+    }
+
+private:
+    std::mutex mutex;
+    std::queue<long long> items;
+};
+
+// 生产者发 [begin, end)
+template <typename Ring>
+static void produce(Ring &ring, long long begin, long long end, bool batched)
+{
+    long long buf[BATCH];
+    long long next = begin;
+    while (next < end)
+    {
+        if (batched)
+        {
+            size_t want = (size_t)std::min<long long>(BATCH, end - next);
+            for (size_t i = 0; i < want; i++)
+            {
+                buf[i] = next + (long long)i;
+            }
+            size_t done = 0;
+            while (done < want)
+            {
+                size_t k = ring.pushN(buf + done, want - done);
+                if (k == 0)
+                {
+                    std::this_thread::yield();
+                }
+                done += k;
+            }
+            next += (long long)want;
+        }
+        else if (ring.tryPush(next))
+        {
+            next++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// 消费者收 count 个，ordered 时检查是否严格递增
+template <typename Ring>
+static long long consume(Ring &ring, long long count, bool batched, bool ordered, bool &orderOk)
+{
+    long long buf[BATCH];
+    long long sum = 0;
+    long long got = 0;
+    long long expectNext = 0;
+    while (got < count)
+    {
+        size_t k;
+        if (batched)
+        {
+            k = ring.popN(buf, (size_t)std::min<long long>(BATCH, count - got));
+        }
+        else
+        {
+            k = ring.tryPop(buf[0]) ? 1 : 0;
+        }
+        if (k == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < k; i++)
+        {
+            sum += buf[i];
+            if (ordered && buf[i] != expectNext++)
+            {
+                orderOk = false;
+            }
+        }
+        got += (long long)k;
+    }
+    return sum;
+}
+
+template <typename Ring>
+static void run(const char *name, int producers, int consumers, long long n, bool batched)
+{
+    Ring ring(RING_SIZE);
+    std::atomic<long long> total{0};
+    std::atomic<bool> orderOk{true};
+    long long perProducer = n / producers;
+    long long perConsumer = perProducer * producers / consumers;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&ring, p, perProducer, batched]
+                             { produce(ring, p * perProducer, (p + 1) * perProducer, batched); });
+    }
+    for (int c = 0; c < consumers; c++)
+    {
+        threads.emplace_back([&ring, &total, &orderOk, perConsumer, batched, producers, consumers]
+                             {
+                                 bool ok = true;
+                                 total += consume(ring, perConsumer, batched, producers == 1 && consumers == 1, ok);
+                                 if (!ok)
+                                 {
+                                     orderOk = false;
+                                 }
+                             });
+    }
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long items = perProducer * producers;
+    bool sumOk = total == items * (items - 1) / 2;
+    std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << items / seconds / 1e6 << " M items/s" << (sumOk && orderOk ? "" : "  结果错误")
+              << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    SpscRing<int> demo(5); // 容量取成 8
+    for (int i = 1; demo.tryPush(i); i++)
+    {
+    }
+    std::cout << "容量 " << demo.capacity() << ":";
+    int value;
+    while (demo.tryPop(value))
+    {
+        std::cout << " " << value;
+    }
+    std::cout << std::endl;
+
+    // 批量接口：n == 0 立即返回 0；满了 pushN 返回 0，空了 popN 返回 0
+    MpmcRing<int> batch(8);
+    int items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int got[10];
+    bool batchOk = batch.pushN(items, 0) == 0 && batch.popN(got, 0) == 0 && batch.popN(got, 4) == 0 &&
+                   batch.pushN(items, 10) == 8 && batch.pushN(items, 1) == 0 && batch.pushN(items, 0) == 0 &&
+                   batch.popN(got, 0) == 0 && batch.popN(got, 10) == 8 && got[7] == 7 && demo.pushN(items, 0) == 0 &&
+                   demo.popN(got, 0) == 0;
+    std::cout << "批量接口边界: " << (batchOk ? "正确" : "错误") << std::endl;
+
+    long long n = argc > 1 ? atoll(argv[1]) : 10000000;
+    std::cout << "1 生产者 1 消费者" << std::endl;
+    run<MutexQueue>("mutex + std::queue", 1, 1, n, false);
+    run<SpscRing<long long>>("SpscRing", 1, 1, n, false);
+    run<SpscRing<long long>>("SpscRing pushN/popN", 1, 1, n, true);
+    run<MpmcRing<long long>>("MpmcRing", 1, 1, n, false);
+    for (int threads = 2; threads <= 8; threads *= 2)
+    {
+        std::cout << threads << " 生产者 " << threads << " 消费者" << std::endl;
+        run<MutexQueue>("mutex + std::queue", threads, threads, n, false);
+        run<MpmcRing<long long>>("MpmcRing", threads, threads, n, false);
+        run<MpmcRing<long long>>("MpmcRing pushN/popN", threads, threads, n, true);
+    }
+    return 0;
+}
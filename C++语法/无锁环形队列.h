@@ -0,0 +1,290 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// 无锁环形队列：容量向上取成 2 的幂，下标用与运算取模；head/tail 是只增不减的计数，差值就是元素个数。
+// SpscRing：单生产者单消费者，两边各自只写自己的下标，用 acquire/release 配对发布元素，没有 CAS；
+//           每一边还缓存一份对方的下标，只有看起来满了/空了才去读对方的缓存行。
+// MpmcRing：多生产者多消费者，Vyukov 有界队列：每个槽带一个序号，
+//           序号等于位置时槽空着可写，等于位置 + 1 时槽里有数据可读，生产者/消费者各用一个 CAS 抢位置。
+// pushN / popN 一次抢一段连续的槽，批量搬运时原子操作的次数降到每批一次。
+// 两种队列都不扩容、不阻塞：满了 tryPush 返回 false，空了 tryPop 返回 false，由调用方决定重试还是让出 CPU。
+
+const size_t RING_CACHE_LINE = 64;
+
+inline size_t ringCapacity(size_t capacity)
+{
+    size_t n = 2;
+    while (n < capacity)
+    {
+        n <<= 1;
+    }
+    return n;
+}
+
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(ringCapacity(capacity) - 1), slots_(new T[mask_ + 1]), head_(0), tailCache_(0), tail_(0), headCache_(0)
+    {
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 只能由生产者线程调用
+    bool tryPush(T value)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ > mask_)
+        {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ > mask_)
+            {
+                return false; // 满
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 放入 items[0, n) 中能放下的前若干个，返回放入的个数
+    size_t pushN(const T *items, size_t n)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (capacity() - (tail - headCache_) < n)
+        {
+            headCache_ = head_.load(std::memory_order_acquire);
+        }
+        size_t count = std::min(n, capacity() - (tail - headCache_));
+        for (size_t i = 0; i < count; i++)
+        {
+            slots_[(tail + i) & mask_] = items[i];
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // 只能由消费者线程调用
+    bool tryPop(T &out)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_)
+        {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_)
+            {
+                return false; // 空
+            }
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 取出至多 n 个元素到 out，返回取出的个数
+    size_t popN(T *out, size_t n)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (tailCache_ - head < n)
+        {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+        }
+        size_t count = std::min(n, tailCache_ - head);
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = std::move(slots_[(head + i) & mask_]);
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    // 消费者写的下标和它缓存的 tail 放在一条缓存行，生产者的放另一条，两边不互相踢缓存行
+    alignas(RING_CACHE_LINE) std::atomic<size_t> head_;
+    size_t tailCache_;
+    alignas(RING_CACHE_LINE) std::atomic<size_t> tail_;
+    size_t headCache_;
+};
+
+template <typename T>
+class MpmcRing
+{
+public:
+    explicit MpmcRing(size_t capacity)
+        : mask_(ringCapacity(capacity) - 1), cells_(new Cell[mask_ + 1]), enqueuePos_(0), dequeuePos_(0)
+    {
+        for (size_t i = 0; i <= mask_; i++)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing &) = delete;
+    MpmcRing &operator=(const MpmcRing &) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    bool tryPush(T value)
+    {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            intptr_t diff = (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // 这个槽上一圈的数据还没被取走：满
+            }
+            else
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed); // 被别的生产者抢先了
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 一次抢下从当前位置开始的一段空槽，放入 items 的前若干个，返回放入的个数
+    size_t pushN(const T *items, size_t n)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        size_t count;
+        while (true)
+        {
+            // 先看第一个槽：跟 tryPush 一样，落后说明满了，超前说明位置被别的生产者抢走了
+            intptr_t diff = (intptr_t)cells_[pos & mask_].sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff < 0)
+            {
+                return 0;
+            }
+            if (diff > 0)
+            {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            count = 1;
+            while (count < n && cells_[(pos + count) & mask_].sequence.load(std::memory_order_acquire) == pos + count)
+            {
+                count++;
+            }
+            if (enqueuePos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            Cell &cell = cells_[(pos + i) & mask_];
+            cell.data = items[i];
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool tryPop(T &out)
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell *cell;
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            intptr_t diff = (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // 槽里还没有数据：空
+            }
+            else
+            {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release); // 留给下一圈的生产者
+        return true;
+    }
+
+    // 一次抢下从当前位置开始的一段已发布的槽，取出至多 n 个，返回取出的个数
+    size_t popN(T *out, size_t n)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        size_t count;
+        while (true)
+        {
+            // 先看第一个槽：落后说明空了，超前说明位置被别的消费者抢走了
+            intptr_t diff = (intptr_t)cells_[pos & mask_].sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff < 0)
+            {
+                return 0;
+            }
+            if (diff > 0)
+            {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            count = 1;
+            while (count < n && cells_[(pos + count) & mask_].sequence.load(std::memory_order_acquire) == pos + count + 1)
+            {
+                count++;
+            }
+            if (dequeuePos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            Cell &cell = cells_[(pos + i) & mask_];
+            out[i] = std::move(cell.data);
+            cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(RING_CACHE_LINE) std::atomic<size_t> enqueuePos_;
+    alignas(RING_CACHE_LINE) std::atomic<size_t> dequeuePos_; // 类按缓存行对齐，后面的对象也不会挤进这一行
+};
@@ -0,0 +1,433 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "二分查找.h"
+
+// 容器快照：把内存里的有序容器 / 哈希表写成不含指针的紧凑文件，之后 mmap 进来原地查询，不用反序列化。
+// 冷启动只需要 open + mmap，真正用到哪一页才缺页读哪一页，不再是逐个 insert 重建整棵树。
+//   SortedSnapshot<T>        有序数组：下标就是"偏移"，二分查找原地进行；RBTree 这类有 size() 和 forEach 的容器都能写；
+//   HashSnapshot<K, V, Hash> 按桶排好的 CSR 布局：桶起点数组 + 连续的 {hash, key, value} 数组，一次查找只碰两三条缓存行。
+// 文件 = 64 字节对齐的文件头 + 各段数据，每段起点按缓存行对齐；按本机字节序、本机结构布局直接写，
+// 只能在同样的平台上读。元素必须可平凡拷贝（整数、定长结构体），带指针的类型（std::string）写不进来。
+// 写文件先写到 path.tmp，fsync 之后 rename 覆盖，读的一方要么看到旧快照，要么看到完整的新快照。
+// 打开时校验魔数、版本、类型和元素大小，不匹配或文件被截断时抛 std::runtime_error，系统调用失败抛 std::system_error。
+namespace snapshot
+{
+    const char MAGIC[8] = {'N', 'O', 'T', 'E', 'S', 'N', 'A', 'P'};
+    const uint32_t VERSION = 1;
+    const uint64_t ALIGN = 64;
+
+    enum Kind : uint32_t
+    {
+        SORTED = 1,
+        HASH = 2
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t kind;
+        uint64_t count;       // 元素个数
+        uint64_t buckets;     // 哈希桶数，有序快照为 0
+        uint32_t keySize;     // sizeof(K)，有序快照是 sizeof(T)
+        uint32_t valueSize;   // sizeof(V)，有序快照为 0
+        uint64_t firstOffset; // 第一段数据在文件里的偏移
+        uint64_t secondOffset;
+        uint64_t fileSize;
+    };
+
+    inline uint64_t alignUp(uint64_t n)
+    {
+        return (n + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    // 只读映射整个文件，析构时解除映射
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &path) : base_(nullptr), size_(0)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "open " + path);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "fstat " + path);
+            }
+            size_ = (size_t)st.st_size;
+            if (size_ != 0)
+            {
+                base_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            int err = errno;
+            ::close(fd); // 映射建立后文件描述符就不需要了
+            if (base_ == MAP_FAILED)
+            {
+                base_ = nullptr;
+                throw std::system_error(err, std::generic_category(), "mmap " + path);
+            }
+        }
+
+        ~MappedFile()
+        {
+            if (base_ != nullptr)
+            {
+                ::munmap(base_, size_);
+            }
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const unsigned char *data() const { return static_cast<const unsigned char *>(base_); }
+        size_t size() const { return size_; }
+
+    private:
+        void *base_;
+        size_t size_;
+    };
+
+    // 顺序写文件，commit() 之前析构会删掉临时文件
+    class Writer
+    {
+    public:
+        explicit Writer(const std::string &path) : path_(path), tmp_(path + ".tmp"), offset_(0), committed_(false)
+        {
+            fd_ = ::open(tmp_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd_ < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "open " + tmp_);
+            }
+        }
+
+        ~Writer()
+        {
+            if (!committed_)
+            {
+                ::close(fd_);
+                ::unlink(tmp_.c_str());
+            }
+        }
+
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        uint64_t offset() const { return offset_; }
+
+        void append(const void *data, size_t n)
+        {
+            const char *p = static_cast<const char *>(data);
+            while (n > 0)
+            {
+                ssize_t written = ::write(fd_, p, n);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "write " + tmp_);
+                }
+                p += written;
+                n -= (size_t)written;
+                offset_ += (uint64_t)written;
+            }
+        }
+
+        // 补零到下一个缓存行边界，返回新的偏移
+        uint64_t pad()
+        {
+            static const char zeros[ALIGN] = {};
+            append(zeros, (size_t)(alignUp(offset_) - offset_));
+            return offset_;
+        }
+
+        void commit()
+        {
+            if (::fsync(fd_) != 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "fsync " + tmp_);
+            }
+            ::close(fd_);
+            committed_ = true;
+            if (::rename(tmp_.c_str(), path_.c_str()) != 0)
+            {
+                int err = errno;
+                ::unlink(tmp_.c_str());
+                throw std::system_error(err, std::generic_category(), "rename " + tmp_);
+            }
+        }
+
+    private:
+        std::string path_;
+        std::string tmp_;
+        int fd_;
+        uint64_t offset_;
+        bool committed_;
+    };
+
+    inline Header makeHeader(Kind kind, uint64_t count, uint64_t buckets, uint32_t keySize, uint32_t valueSize)
+    {
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.kind = kind;
+        h.count = count;
+        h.buckets = buckets;
+        h.keySize = keySize;
+        h.valueSize = valueSize;
+        h.firstOffset = alignUp(sizeof(Header));
+        return h;
+    }
+
+    // [offset, offset + count * width) 是否落在 [0, limit) 内且按 ALIGN 对齐；用除法比较，损坏的 count 不会让乘法溢出绕过检查
+    inline bool fits(uint64_t offset, uint64_t count, uint64_t width, uint64_t limit)
+    {
+        return offset % ALIGN == 0 && offset <= limit && count <= (limit - offset) / width;
+    }
+
+    // 检查文件头，返回映射里的文件头；各段的范围由调用方再用 fits 对照 fileSize 检查
+    inline const Header &checkHeader(const MappedFile &file, const std::string &path, Kind kind, uint32_t keySize,
+                                     uint32_t valueSize)
+    {
+        if (file.size() < sizeof(Header))
+        {
+            throw std::runtime_error("快照文件太短: " + path);
+        }
+        const Header &h = *reinterpret_cast<const Header *>(file.data());
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION)
+        {
+            throw std::runtime_error("不是快照文件或版本不对: " + path);
+        }
+        if (h.kind != kind || h.keySize != keySize || h.valueSize != valueSize)
+        {
+            throw std::runtime_error("快照的类型和元素大小对不上: " + path);
+        }
+        if (h.fileSize != file.size())
+        {
+            throw std::runtime_error("快照文件不完整: " + path);
+        }
+        return h;
+    }
+
+    template <typename T>
+    class SortedSnapshot
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "快照里的元素必须可平凡拷贝");
+
+    public:
+        // 按 forEach 的顺序（必须是升序）写出 container 的全部元素
+        template <typename Container>
+        static void write(const std::string &path, const Container &container)
+        {
+            Header h = makeHeader(SORTED, container.size(), 0, sizeof(T), 0);
+            h.secondOffset = h.firstOffset + alignUp(h.count * sizeof(T));
+            h.fileSize = h.secondOffset;
+            Writer out(path);
+            out.append(&h, sizeof(h));
+            out.pad();
+            std::vector<T> buffer;
+            buffer.reserve(BUFFER);
+            container.forEach([&](const T &value)
+                              {
+                                  buffer.push_back(value);
+                                  if (buffer.size() == BUFFER)
+                                  {
+                                      out.append(buffer.data(), buffer.size() * sizeof(T));
+                                      buffer.clear();
+                                  }
+                              });
+            out.append(buffer.data(), buffer.size() * sizeof(T));
+            out.pad();
+            out.commit();
+        }
+
+        explicit SortedSnapshot(const std::string &path) : file_(path)
+        {
+            const Header &h = checkHeader(file_, path, SORTED, sizeof(T), 0);
+            if (!fits(h.firstOffset, h.count, sizeof(T), h.fileSize))
+            {
+                throw std::runtime_error("快照的元素个数和文件大小对不上: " + path);
+            }
+            count_ = h.count;
+            data_ = reinterpret_cast<const T *>(file_.data() + h.firstOffset);
+        }
+
+        size_t size() const { return count_; }
+
+        bool find(const T &value) const
+        {
+            size_t i = searching::lowerBound(data_, count_, value);
+            return i < count_ && !(value < data_[i]);
+        }
+
+        // 第 k 小（从 0 开始）的元素，越界时返回 nullptr
+        const T *select(size_t k) const
+        {
+            return k < count_ ? data_ + k : nullptr;
+        }
+
+        // 小于 value 的元素个数
+        size_t rank(const T &value) const
+        {
+            return searching::lowerBound(data_, count_, value);
+        }
+
+        // [lo, hi] 内的元素个数
+        size_t countRange(const T &lo, const T &hi) const
+        {
+            if (hi < lo)
+            {
+                return 0;
+            }
+            size_t upper = searching::lowerBound(data_, count_, hi, [](const T &a, const T &b)
+                                                 { return !(b < a); });
+            return upper - rank(lo);
+        }
+
+    private:
+        static const size_t BUFFER = 4096;
+
+        MappedFile file_;
+        size_t count_;
+        const T *data_;
+    };
+
+    template <typename K, typename V, typename Hash>
+    class HashSnapshot
+    {
+        static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                      "快照里的键和值必须可平凡拷贝");
+
+    public:
+        struct Entry
+        {
+            uint64_t hash;
+            K key;
+            V value;
+        };
+
+        // 写出 table 的全部键值对；table 要有 size() 和 forEach(visit(key, value))。
+        // 哈希值存进文件，读的一方要用同一个 Hash，所以 Hash 不能带随机种子
+        template <typename Table>
+        static void write(const std::string &path, const Table &table, const Hash &hash = Hash())
+        {
+            uint64_t buckets = 1;
+            while (buckets < table.size())
+            {
+                buckets <<= 1;
+            }
+            // 按桶计数排序：先数每个桶有几个，前缀和得到起点，再把元素放进去
+            std::vector<Entry> entries;
+            entries.reserve(table.size());
+            std::vector<uint64_t> start(buckets + 1, 0);
+            table.forEach([&](const K &key, const V &value)
+                          {
+                              entries.push_back(Entry{(uint64_t)hash(key), key, value});
+                              start[(entries.back().hash & (buckets - 1)) + 1]++;
+                          });
+            for (uint64_t b = 0; b < buckets; b++)
+            {
+                start[b + 1] += start[b];
+            }
+            std::vector<Entry> sorted(entries.size());
+            std::vector<uint64_t> next(start.begin(), start.end() - 1);
+            for (const Entry &e : entries)
+            {
+                sorted[next[e.hash & (buckets - 1)]++] = e;
+            }
+
+            Header h = makeHeader(HASH, entries.size(), buckets, sizeof(K), sizeof(V));
+            h.secondOffset = h.firstOffset + alignUp(start.size() * sizeof(uint64_t));
+            h.fileSize = h.secondOffset + alignUp(sorted.size() * sizeof(Entry));
+            Writer out(path);
+            out.append(&h, sizeof(h));
+            out.pad();
+            out.append(start.data(), start.size() * sizeof(uint64_t));
+            out.pad();
+            out.append(sorted.data(), sorted.size() * sizeof(Entry));
+            out.pad();
+            out.commit();
+        }
+
+        explicit HashSnapshot(const std::string &path, const Hash &hash = Hash()) : file_(path), hasher_(hash)
+        {
+            const Header &h = checkHeader(file_, path, HASH, sizeof(K), sizeof(V));
+            // buckets 是 2 的幂，buckets + 1 不会溢出
+            if (h.buckets == 0 || (h.buckets & (h.buckets - 1)) != 0 ||
+                !fits(h.firstOffset, h.buckets + 1, sizeof(uint64_t), h.secondOffset) ||
+                !fits(h.secondOffset, h.count, sizeof(Entry), h.fileSize))
+            {
+                throw std::runtime_error("快照的桶数和文件大小对不上: " + path);
+            }
+            count_ = h.count;
+            mask_ = h.buckets - 1;
+            start_ = reinterpret_cast<const uint64_t *>(file_.data() + h.firstOffset);
+            entries_ = reinterpret_cast<const Entry *>(file_.data() + h.secondOffset);
+            // find 直接用 start_[b]..start_[b + 1] 下标访问 entries_，打开时把整个桶数组验一遍：
+            // 从 0 开始、单调不减、结束于 count
+            uint64_t prev = 0;
+            for (uint64_t b = 0; b <= h.buckets; b++)
+            {
+                if (start_[b] < prev || start_[b] > count_ || (b == 0 && start_[b] != 0))
+                {
+                    throw std::runtime_error("快照的桶数组损坏: " + path);
+                }
+                prev = start_[b];
+            }
+            if (prev != count_)
+            {
+                throw std::runtime_error("快照的桶数组损坏: " + path);
+            }
+        }
+
+        size_t size() const { return count_; }
+
+        // 返回映射里的值，不存在时返回 nullptr
+        const V *find(const K &key) const
+        {
+            uint64_t h = (uint64_t)hasher_(key);
+            uint64_t b = h & mask_;
+            for (uint64_t i = start_[b]; i < start_[b + 1]; i++)
+            {
+                if (entries_[i].hash == h && entries_[i].key == key)
+                {
+                    return &entries_[i].value;
+                }
+            }
+            return nullptr;
+        }
+
+        bool contains(const K &key) const
+        {
+            return find(key) != nullptr;
+        }
+
+    private:
+        MappedFile file_;
+        Hash hasher_;
+        size_t count_;
+        uint64_t mask_;
+        const uint64_t *start_;  // 桶 b 的元素是 entries_[start_[b], start_[b + 1])
+        const Entry *entries_;
+    };
+}
@@ -0,0 +1,217 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdlib>
+#include "分段栈.h"
+#include "任务池.h"
+
+// 二叉搜索树的一遍式校验：一次后序遍历同时算出每棵子树的节点数、高度、最小和最大节点，
+// 顺带检查有序性（左子树最大值 < 根 < 右子树最小值，严格小于，不允许重复）、可选的平衡性（左右高度差不超过 1），
+// 以及调用方给的附加检查（比如节点里缓存的子树大小对不对）。
+//   validateTree          单线程，遍历用堆上的分段栈，退化成链的树也不会爆调用栈；
+//   validateTreeParallel  上面几层按子树拆成任务交给 TaskPool，每个任务内部仍是单线程；
+// 两种模式都在发现第一处违规时停下，并行模式下其他任务也会很快看到停止标志并退出。
+// Node 需要有 data、left、right 三个成员；附加检查 check(node, size, height) 在并行模式下会被多个线程同时调用。
+namespace treecheck
+{
+    enum Violation
+    {
+        NONE,     // 没有违规
+        ORDER,    // 有序性被破坏
+        BALANCE,  // 左右子树高度差超过 1
+        CHECK     // 附加检查没通过
+    };
+
+    // 没有违规时 size 和 height 是整棵树的；有违规时只有 violation 和 where 有意义
+    template <typename Node>
+    struct TreeReport
+    {
+        size_t size;
+        int height;
+        Violation violation;
+        const Node *where; // 第一个被发现违规的节点（并行模式下是最先报告的那个）
+
+        bool ok() const { return violation == NONE; }
+    };
+
+    struct NoCheck
+    {
+        template <typename Node>
+        bool operator()(const Node *, size_t, int) const { return true; }
+    };
+
+    template <typename Node>
+    struct Summary
+    {
+        size_t size;
+        int height;
+        const Node *min;
+        const Node *max;
+    };
+
+    template <typename Node, typename Compare, typename Check>
+    class Validator
+    {
+    public:
+        Validator(bool requireBalanced, Compare comp, Check check)
+            : requireBalanced_(requireBalanced), comp_(comp), check_(check), stop_(false), violation_(NONE), where_(nullptr)
+        {
+        }
+
+        // 单线程校验以 root 为根的子树
+        bool subtree(const Node *root, Summary<Node> &out)
+        {
+            out = Summary<Node>{0, 0, nullptr, nullptr};
+            if (root == nullptr)
+            {
+                return true;
+            }
+            // 内部节点进栈两次：第一次展开孩子，第二次孩子都算完了，合并孩子的结果；叶子（约占一半）出栈时直接合并
+            SegmentedStack<std::pair<const Node *, bool>> stack;
+            SegmentedStack<Summary<Node>> results;
+            stack.push({root, false});
+            size_t steps = 0;
+            while (!stack.empty())
+            {
+                std::pair<const Node *, bool> top = stack.top();
+                stack.pop();
+                const Node *node = top.first;
+                if (!top.second && (node->left != nullptr || node->right != nullptr))
+                {
+                    stack.push({node, true});
+                    if (node->right != nullptr)
+                        stack.push({node->right, false});
+                    if (node->left != nullptr)
+                        stack.push({node->left, false});
+                    continue;
+                }
+                Summary<Node> right{0, 0, nullptr, nullptr};
+                Summary<Node> left{0, 0, nullptr, nullptr};
+                if (node->right != nullptr)
+                {
+                    right = results.top();
+                    results.pop();
+                }
+                if (node->left != nullptr)
+                {
+                    left = results.top();
+                    results.pop();
+                }
+                Summary<Node> merged;
+                if (!merge(node, left, right, merged))
+                {
+                    return false;
+                }
+                results.push(merged);
+                if ((++steps & 1023) == 0 && stopped()) // 别的任务已经发现违规
+                {
+                    return false;
+                }
+            }
+            out = results.top();
+            return true;
+        }
+
+        // 上面 depth 层按子树拆成任务：左子树交给任务池，当前线程做右子树，合并两边
+        bool parallel(const Node *node, int depth, TaskPool &pool, Summary<Node> &out)
+        {
+            if (depth == 0 || node == nullptr)
+            {
+                return subtree(node, out);
+            }
+            Summary<Node> left{0, 0, nullptr, nullptr};
+            Summary<Node> right{0, 0, nullptr, nullptr};
+            bool leftOk = true;
+            TaskPool::Group group;
+            if (node->left != nullptr)
+            {
+                pool.spawn(group, [this, node, depth, &pool, &left, &leftOk]
+                           { leftOk = parallel(node->left, depth - 1, pool, left); });
+            }
+            bool rightOk = node->right == nullptr || parallel(node->right, depth - 1, pool, right);
+            pool.wait(group);
+            return leftOk && rightOk && !stopped() && merge(node, left, right, out);
+        }
+
+        TreeReport<Node> report(const Summary<Node> &whole) const
+        {
+            return TreeReport<Node>{whole.size, whole.height, violation_, where_};
+        }
+
+    private:
+        bool requireBalanced_;
+        Compare comp_;
+        Check check_;
+        std::atomic<bool> stop_;
+        Violation violation_; // 只由抢到 stop_ 的那个线程写，其余线程结束后才读
+        const Node *where_;
+
+        bool stopped() const
+        {
+            return stop_.load(std::memory_order_relaxed);
+        }
+
+        void fail(Violation violation, const Node *node)
+        {
+            bool expected = false;
+            if (stop_.compare_exchange_strong(expected, true))
+            {
+                violation_ = violation;
+                where_ = node;
+            }
+        }
+
+        bool merge(const Node *node, const Summary<Node> &left, const Summary<Node> &right, Summary<Node> &out)
+        {
+            if ((left.max != nullptr && !comp_(left.max->data, node->data)) ||
+                (right.min != nullptr && !comp_(node->data, right.min->data)))
+            {
+                fail(ORDER, node);
+                return false;
+            }
+            if (requireBalanced_ && std::abs(left.height - right.height) > 1)
+            {
+                fail(BALANCE, node);
+                return false;
+            }
+            out.size = left.size + right.size + 1;
+            out.height = std::max(left.height, right.height) + 1;
+            out.min = left.min != nullptr ? left.min : node;
+            out.max = right.max != nullptr ? right.max : node;
+            if (!check_(node, out.size, out.height))
+            {
+                fail(CHECK, node);
+                return false;
+            }
+            return true;
+        }
+    };
+
+    template <typename Node, typename Compare = std::less<>, typename Check = NoCheck>
+    TreeReport<Node> validateTree(const Node *root, bool requireBalanced = false, Compare comp = Compare(),
+                                  Check check = Check())
+    {
+        Validator<Node, Compare, Check> validator(requireBalanced, comp, check);
+        Summary<Node> whole;
+        validator.subtree(root, whole);
+        return validator.report(whole);
+    }
+
+    template <typename Node, typename Compare = std::less<>, typename Check = NoCheck>
+    TreeReport<Node> validateTreeParallel(const Node *root, TaskPool &pool, bool requireBalanced = false,
+                                          Compare comp = Compare(), Check check = Check())
+    {
+        // 拆到每个线程平均 16 棵子树，树不平衡时空闲线程还有任务可偷
+        int depth = 4;
+        for (size_t n = pool.threadCount(); n > 1; n >>= 1)
+        {
+            depth++;
+        }
+        Validator<Node, Compare, Check> validator(requireBalanced, comp, check);
+        Summary<Node> whole{0, 0, nullptr, nullptr};
+        validator.parallel(root, depth, pool, whole);
+        return validator.report(whole);
+    }
+}
@@ -0,0 +1,649 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stack>
+#include <queue>
+#include <memory>
+#include <type_traits>
+#include <iterator>
+#include "节点池.h"
+#include "运行统计.h"
+
+// 节点从 NodePool 分配：批量插入几乎不调用 malloc，节点在内存里按插入顺序连续排列；
+// 析构时如果 T 可平凡析构，不需要逐个释放节点，由节点池整块归还。
+// Alloc 是节点池向系统申请整块内存用的分配器。
+template <typename T, typename Alloc = std::allocator<T>>
+class RBTree
+{
+public:
+    explicit RBTree(const Alloc &alloc = Alloc()) : root(nullptr), pool(alloc) {}
+    ~RBTree()
+    {
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            destroy(root);
+        }
+    }
+    // 由升序序列直接建树
+    template <typename It>
+    RBTree(It first, It last, const Alloc &alloc = Alloc()) : root(nullptr), pool(alloc)
+    {
+        buildFromSorted(first, last);
+    }
+    RBTree(const RBTree &) = delete;
+    RBTree &operator=(const RBTree &) = delete;
+
+    // O(n) 建树：每次取中间元素作根，得到的树所有空链接都在最底下两层。
+    // 最底下一层没填满时把这一层涂红，其余全黑，黑高处处相同，不需要旋转和修正。
+    // 原有内容会被清空
+    template <typename It>
+    void buildFromSorted(It first, It last)
+    {
+        clear();
+        size_t n = std::distance(first, last);
+        int redDepth = -1;
+        if ((n & (n + 1)) != 0) // n+1 不是2的幂，最底层不满
+        {
+            redDepth = 0;
+            while (((size_t)2 << redDepth) <= n)
+            {
+                redDepth++;
+            }
+        }
+        root = build(first, n, 0, redDepth);
+    }
+
+    // 合并另一棵树：两棵树分别中序展开成有序序列，归并后重新建树，O(n + m)。
+    // 允许重复元素（和 insert 一致）；other 合并后为空
+    void merge(RBTree &other)
+    {
+        std::vector<T> a, b, merged;
+        a.reserve(size());
+        b.reserve(other.size());
+        forEach([&a](const T &value)
+                { a.push_back(value); });
+        other.forEach([&b](const T &value)
+                      { b.push_back(value); });
+        merged.reserve(a.size() + b.size());
+        std::merge(std::make_move_iterator(a.begin()), std::make_move_iterator(a.end()),
+                   std::make_move_iterator(b.begin()), std::make_move_iterator(b.end()),
+                   std::back_inserter(merged));
+        other.clear();
+        buildFromSorted(std::make_move_iterator(merged.begin()), std::make_move_iterator(merged.end()));
+    }
+
+    // 删除所有元素，节点内存留在池里复用
+    void clear()
+    {
+        release(root);
+        root = nullptr;
+    }
+
+    void insert(const T &value)
+    {
+        Node *newNode = createNode(value);
+        if (root == nullptr)
+        {
+            root = newNode;
+            root->color = balck; // 根节点为黑色
+            return;
+        }
+
+        Node *parent = nullptr;
+        Node *current = root;
+        size_t depth = 0;
+        while (current != nullptr)
+        {
+            depth++;
+            parent = current;
+            current->size++; // 沿途每棵子树都多一个节点
+            if (newNode->data < current->data)
+            {
+                current = current->left;
+            }
+            else
+            {
+                current = current->right;
+            }
+        }
+
+        NOTES_STATS_RECORD("rbtree.insert_depth", depth);
+        newNode->parent = parent;
+        newNode->color = red; // 新插入的节点为红色
+        if (newNode->data < parent->data)
+        {
+            parent->left = newNode;
+        }
+        else
+        {
+            parent->right = newNode;
+        }
+
+        // 插入后修正红黑树性质
+        if (getColor(parent) == red)
+        {
+            this->fixAfterInsert(newNode);
+        }
+    }
+
+    void remove(const T &value)
+    {
+        if (root == nullptr)
+        {
+            return;
+        }
+
+        Node *current = root;
+
+        while (current != nullptr)
+        {
+            if (value == current->data)
+            {
+                break;
+            }
+            else if (value < current->data)
+            {
+                current = current->left;
+            }
+            else
+            {
+                current = current->right;
+            }
+        }
+        if (current == nullptr)
+        {
+            return; // 找不到要删除的节点
+        }
+
+        if (current->left != nullptr && current->right != nullptr)
+        {
+            Node *pre = current->left;
+            while (pre->right != nullptr)
+            {
+                pre = pre->right;
+            }
+            current->data = pre->data;
+            current = pre;
+        }
+        // current 至多只有一个孩子，用孩子顶替它的位置
+        Node *child = current->left != nullptr ? current->left : current->right;
+        Node *parent = current->parent;
+        for (Node *p = parent; p != nullptr; p = p->parent)
+        {
+            p->size--;
+        }
+        if (child != nullptr)
+        {
+            child->parent = parent;
+        }
+        if (parent == nullptr)
+        {
+            root = child;
+        }
+        else if (current == parent->left)
+        {
+            parent->left = child;
+        }
+        else
+        {
+            parent->right = child;
+        }
+
+        // 删掉的是黑色节点，路径上少了一个黑色，需要修正；child 可能为空，所以同时传入父节点
+        if (current->color == balck)
+        {
+            fixAfterRemove(child, parent);
+        }
+        destroyNode(current);
+    }
+
+    bool find(const T &value) const
+    {
+        Node *current = root;
+        size_t depth = 0;
+        while (current != nullptr)
+        {
+            depth++;
+            if (value < current->data)
+            {
+                current = current->left;
+            }
+            else if (current->data < value)
+            {
+                current = current->right;
+            }
+            else
+            {
+                NOTES_STATS_RECORD("rbtree.find_depth", depth);
+                return true;
+            }
+        }
+        NOTES_STATS_RECORD("rbtree.find_depth", depth);
+        return false;
+    }
+
+    size_t size() const
+    {
+        return getSize(root);
+    }
+
+    // 顺序统计：每个节点记录子树大小，插入/删除时沿路径增减，旋转时就地修正，
+    // 以下查询都只走一条根到叶的路径，O(log n)
+    // 第k小的元素（k从0开始），越界时返回nullptr；倒数第k个就是 select(size() - k)
+    const T *select(size_t k) const
+    {
+        Node *current = root;
+        while (current != nullptr)
+        {
+            size_t leftSize = getSize(current->left);
+            if (k < leftSize)
+            {
+                current = current->left;
+            }
+            else if (k == leftSize)
+            {
+                return &current->data;
+            }
+            else
+            {
+                k -= leftSize + 1;
+                current = current->right;
+            }
+        }
+        return nullptr;
+    }
+
+    // 小于 value 的元素个数
+    size_t rank(const T &value) const
+    {
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
+        {
+            if (current->data < value)
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
+            else
+            {
+                current = current->left;
+            }
+        }
+        return n;
+    }
+
+    // 落在闭区间 [lo, hi] 内的元素个数
+    size_t countRange(const T &lo, const T &hi) const
+    {
+        if (hi < lo)
+        {
+            return 0;
+        }
+        return rankUpper(hi) - rank(lo);
+    }
+
+    // 中序遍历：沿父指针找后继，不需要栈也不递归
+    template <typename F>
+    void forEach(F visit) const
+    {
+        Node *current = root;
+        while (current != nullptr && current->left != nullptr)
+        {
+            current = current->left;
+        }
+        while (current != nullptr)
+        {
+            visit(current->data);
+            if (current->right != nullptr)
+            {
+                current = current->right;
+                while (current->left != nullptr)
+                {
+                    current = current->left;
+                }
+            }
+            else
+            {
+                while (current->parent != nullptr && current == current->parent->right)
+                {
+                    current = current->parent;
+                }
+                current = current->parent;
+            }
+        }
+    }
+
+private:
+    enum Color
+    {
+        red,
+        balck
+    };
+
+    struct Node
+    {
+        Node(T value = T(), Node *left = nullptr, Node *right = nullptr, Node *parent = nullptr, Color color = balck)
+            : data(std::move(value)), left(left), right(right), parent(parent), color(color) {}
+        T data;
+        Node *left;
+        Node *right;
+        Node *parent;
+        Color color;     // 新增颜色属性
+        size_t size = 1; // 子树节点数，用于顺序统计
+    };
+    Node *root;                  // 根节点
+    NodePool<Node, Alloc> pool; // 所有节点都从这里分配
+
+    template <typename U>
+    Node *createNode(U &&value)
+    {
+        return new (pool.allocate()) Node(std::forward<U>(value));
+    }
+
+    void destroyNode(Node *node)
+    {
+        node->~Node();
+        pool.deallocate(node);
+    }
+
+    // 按中序消费 n 个元素，返回子树的根；深度等于 redDepth 的节点涂红
+    template <typename It>
+    Node *build(It &it, size_t n, int depth, int redDepth)
+    {
+        if (n == 0)
+        {
+            return nullptr;
+        }
+        Node *left = build(it, n / 2, depth + 1, redDepth);
+        Node *node = createNode(*it);
+        ++it;
+        Node *right = build(it, n - n / 2 - 1, depth + 1, redDepth);
+        node->left = left;
+        node->right = right;
+        if (left != nullptr)
+        {
+            left->parent = node;
+        }
+        if (right != nullptr)
+        {
+            right->parent = node;
+        }
+        node->color = depth == redDepth ? red : balck;
+        node->size = n;
+        return node;
+    }
+
+    void release(Node *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        release(node->left);
+        release(node->right);
+        destroyNode(node);
+    }
+
+    // 后序释放整棵树，只在 T 需要析构时调用
+    void destroy(Node *node)
+    {
+        if (node == nullptr)
+        {
+            return;
+        }
+        destroy(node->left);
+        destroy(node->right);
+        node->~Node();
+    }
+
+    Color getColor(Node *node) const
+    {
+        return node == nullptr ? balck : node->color;
+    }
+
+    void setColor(Node *node, Color color)
+    {
+        if (node != nullptr)
+        {
+            node->color = color;
+        }
+    }
+
+    size_t getSize(Node *node) const
+    {
+        return node == nullptr ? 0 : node->size;
+    }
+
+    // 不大于 value 的元素个数
+    size_t rankUpper(const T &value) const
+    {
+        size_t n = 0;
+        Node *current = root;
+        while (current != nullptr)
+        {
+            if (value < current->data)
+            {
+                current = current->left;
+            }
+            else
+            {
+                n += getSize(current->left) + 1;
+                current = current->right;
+            }
+        }
+        return n;
+    }
+
+    Node *getParent(Node *node) const
+    {
+        return node == nullptr ? nullptr : node->parent;
+    }
+
+    Node *getleft(Node *node) const
+    {
+        return node == nullptr ? nullptr : node->left;
+    }
+
+    Node *getright(Node *node) const
+    {
+        return node == nullptr ? nullptr : node->right;
+    }
+
+    void leftRotate(Node *father)
+    {
+        NOTES_STATS_ADD("rbtree.rotations", 1);
+        Node *child = father->right;
+        child->parent = father->parent;
+        if (father->parent == nullptr)
+        {
+            root = child;
+        }
+        else
+        {
+            if (father == father->parent->left)
+            {
+                father->parent->left = child;
+            }
+            else
+            {
+                father->parent->right = child;
+            }
+        }
+
+        father->right = child->left;
+        if (child->left != nullptr)
+        {
+            child->left->parent = father;
+        }
+
+        child->left = father;
+        father->parent = child;
+
+        // 旋转后 child 接管原来整棵子树，father 的子树重新计算
+        child->size = father->size;
+        father->size = getSize(father->left) + getSize(father->right) + 1;
+    }
+
+    void rightRotate(Node *father)
+    {
+        NOTES_STATS_ADD("rbtree.rotations", 1);
+        Node *child = father->left;
+        child->parent = father->parent;
+        if (father->parent == nullptr)
+        {
+            root = child;
+        }
+        else
+        {
+            if (father == father->parent->left)
+            {
+                father->parent->left = child;
+            }
+            else
+            {
+                father->parent->right = child;
+            }
+        }
+        father->left = child->right;
+        if (child->right != nullptr)
+        {
+            child->right->parent = father;
+        }
+
+        child->right = father;
+        father->parent = child;
+
+        child->size = father->size;
+        father->size = getSize(father->left) + getSize(father->right) + 1;
+    }
+
+    void fixAfterInsert(Node *node)
+    {
+
+        while (getColor(node->parent) == red)
+        {
+            if (node->parent == node->parent->parent->left)
+            {
+                Node *uncle = node->parent->parent->right;
+                if (getColor(uncle) == red)
+                {
+                    setColor(node->parent, balck);
+                    setColor(uncle, balck);
+                    setColor(node->parent->parent, red);
+                    node = node->parent->parent;
+                }
+                else
+                {
+                    if (node == node->parent->right)
+                    {
+                        node = node->parent;
+                        leftRotate(node);
+                    }
+                    setColor(node->parent, balck);
+                    setColor(node->parent->parent, red);
+                    rightRotate(node->parent->parent);
+                }
+            }
+            else
+            {
+                Node *uncle = node->parent->parent->left;
+                if (getColor(uncle) == red)
+                {
+                    setColor(node->parent, balck);
+                    setColor(uncle, balck);
+                    setColor(node->parent->parent, red);
+                    node = node->parent->parent;
+                }
+                else
+                {
+                    if (node == node->parent->left)
+                    {
+                        node = node->parent;
+                        rightRotate(node);
+                    }
+                    setColor(node->parent, balck);
+                    setColor(node->parent->parent, red);
+                    leftRotate(node->parent->parent);
+                }
+            }
+        }
+        setColor(root, balck); // 根节点始终为黑色
+    };
+
+    // node 是顶替被删节点的孩子（可能为空），parent 是它的父节点
+    void fixAfterRemove(Node *node, Node *parent)
+    {
+        while (node != root && getColor(node) == balck)
+        {
+            if (node == parent->left)
+            {
+                Node *sibling = parent->right;
+                if (getColor(sibling) == red)
+                {
+                    setColor(sibling, balck);
+                    setColor(parent, red);
+                    leftRotate(parent);
+                    sibling = parent->right;
+                }
+                if (getColor(sibling->left) == balck && getColor(sibling->right) == balck)
+                {
+                    setColor(sibling, red);
+                    node = parent;
+                    parent = node->parent;
+                }
+                else
+                {
+                    if (getColor(sibling->right) == balck)
+                    {
+                        setColor(sibling->left, balck);
+                        setColor(sibling, red);
+                        rightRotate(sibling);
+                        sibling = parent->right;
+                    }
+                    setColor(sibling, getColor(parent));
+                    setColor(parent, balck);
+                    setColor(sibling->right, balck);
+                    leftRotate(parent);
+                    node = root;
+                    break;
+                }
+            }
+            else
+            {
+                Node *sibling = parent->left;
+                if (getColor(sibling) == red)
+                {
+                    setColor(sibling, balck);
+                    setColor(parent, red);
+                    rightRotate(parent);
+                    sibling = parent->left;
+                }
+                if (getColor(sibling->right) == balck && getColor(sibling->left) == balck)
+                {
+                    setColor(sibling, red);
+                    node = parent;
+                    parent = node->parent;
+                }
+                else
+                {
+                    if (getColor(sibling->left) == balck)
+                    {
+                        setColor(sibling->right, balck);
+                        setColor(sibling, red);
+                        leftRotate(sibling);
+                        sibling = parent->left;
+                    }
+                    setColor(sibling, getColor(parent));
+                    setColor(parent, balck);
+                    setColor(sibling->left, balck);
+                    rightRotate(parent);
+                    node = root;
+                    break;
+                }
+            }
+        }
+        setColor(node, balck); // 设置为黑色
+    }
+};
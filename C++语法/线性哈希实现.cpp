@@ -1,186 +1,7 @@
 #include <iostream>
-#include <vector>
-#include <functional>
+#include "线性哈希表.h"
 using namespace std;
 
-enum state
-{
-    STATE_UNUSED,
-    STATE_DELETED,
-    STATE_OCCUPIED
-};
-
-struct BUCKET
-{
-    BUCKET() : key(0), status(STATE_UNUSED) {}
-    int key;
-    state status;
-};
-
-// 线性探测哈希表的实现
-class LinearProbingHashTable
-{
-public:
-    LinearProbingHashTable() : capacity(PRIME[0]), size(0), usedbucketnumber(0), LOADFACTOR(0.75), PRIME_INDEX(0)
-    {
-        if (capacity != PRIME[0])
-        {
-            while (PRIME[PRIME_INDEX] < capacity)
-            {
-                PRIME_INDEX++;
-            }
-            capacity = PRIME[PRIME_INDEX];
-        }
-
-        table = new BUCKET[capacity];
-    }
-    ~LinearProbingHashTable()
-    {
-        delete[] table;
-        table = nullptr;
-    }
-
-public:
-    // 插入键值对
-    bool insert(int key)
-    {
-        double loadfactor = (double)usedbucketnumber / capacity;
-        if (loadfactor > LOADFACTOR)
-        {
-            expand();
-        }
-        int idx = key % capacity;
-
-        if (table[idx].status == STATE_UNUSED)
-        {
-            table[idx].key = key;
-            table[idx].status = STATE_OCCUPIED;
-            usedbucketnumber++;
-            return true;
-        }
-        for (int i = (idx + 1) % capacity; i != idx; i = (i + 1) % capacity)
-        {
-            if (table[i].status == STATE_UNUSED)
-            {
-                table[i].key = key;
-                table[i].status = STATE_OCCUPIED;
-                usedbucketnumber++;
-                return true;
-            }
-        }
-        return false;
-    }
-
-    bool erase(int key)
-    {
-        int idx = key % capacity;
-        if (table[idx].status == STATE_UNUSED)
-        {
-            return true;
-        }
-        if (table[idx].status == STATE_OCCUPIED && table[idx].key == key)
-        {
-            table[idx].status = STATE_DELETED;
-            usedbucketnumber--;
-            return true;
-        }
-        for (int i = (idx + 1) % capacity; i != idx; i = (i + 1) % capacity)
-        {
-            if (table[i].status == STATE_UNUSED)
-            {
-                return true; // 没有找到
-            }
-            if (table[i].status == STATE_OCCUPIED && table[i].key == key)
-            {
-                table[i].status = STATE_DELETED;
-                usedbucketnumber--;
-                return true;
-            }
-        }
-        return true;
-    }
-
-    bool find(int key)
-    {
-        int idx = key % capacity;
-        if (table[idx].status == STATE_UNUSED)
-        {
-            return false;
-        }
-        if (table[idx].status == STATE_OCCUPIED && table[idx].key == key)
-        {
-            return true;
-        }
-        for (int i = (idx + 1) % capacity; i != idx; i = (i + 1) % capacity)
-        {
-            if (table[i].status == STATE_UNUSED)
-            {
-                return false; // 没有找到
-            }
-            if (table[i].status == STATE_OCCUPIED && table[i].key == key)
-            {
-                return true;
-            }
-        }
-        return false;
-    }
-
-private:
-    BUCKET *table;
-    int capacity;
-    int size;
-    int usedbucketnumber;             // 记录已使用的桶的数量
-    double LOADFACTOR;                // 负载因子
-    static const int PRIME_SIZE = 10; // 默认容量
-    static int PRIME[PRIME_SIZE];     // 素数表
-    int PRIME_INDEX;                  // 素数表的索引
-
-    void expand()
-    {
-        int oldcapacity = capacity;
-        BUCKET *oldtable = table;
-        capacity = PRIME[++PRIME_INDEX];
-        table = new BUCKET[capacity];
-        for (int i = 0; i < oldcapacity; i++)
-        {
-            if (oldtable[i].status == STATE_OCCUPIED)
-            {
-                int idx = oldtable[i].key % capacity;
-                if (table[idx].status == STATE_UNUSED)
-                {
-                    table[idx].key = oldtable[i].key;
-                    table[idx].status = STATE_OCCUPIED;
-                }
-                else
-                {
-                    for (int j = (idx + 1) % capacity; j != idx; (j + 1) % capacity)
-                    {
-                        if (table[j].status == STATE_UNUSED)
-                        {
-                            table[j].key = oldtable[i].key;
-                            table[j].status = STATE_OCCUPIED;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-        delete[] oldtable;
-    }
-};
-
-int LinearProbingHashTable::PRIME[PRIME_SIZE] = {
-    3,
-    7,
-    23,
-    47,
-    97,
-    251,
-    443,
-    911,
-    1471,
-    2869};
-
 int main()
 {
 
@@ -198,6 +19,26 @@ int main()
     std::cout << "Find 5: " << hashTable.find(5) << std::endl; // true
     hashTable.erase(2);
 
-    std::cout << "Find 2: " << hashTable.find(2) << std::endl; // true
+    std::cout << "Find 2: " << hashTable.find(2) << std::endl; // false
+
+    // 反复插入/删除，验证扩容和墓碑重建
+    for (int i = 0; i < 100000; i++)
+    {
+        hashTable.insert(i);
+        if (i % 3 == 0)
+        {
+            hashTable.erase(i);
+        }
+    }
+    int missing = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        missing += hashTable.find(i) != (i % 3 != 0);
+    }
+    std::cout << "Size: " << hashTable.count() << ", mismatches: " << missing << std::endl; // 66666, 0
+    if (stats::enabled)
+    {
+        stats::dump(std::cout); // 以 -DNOTES_STATS 编译时输出探测长度分布
+    }
     return 0;
 }
@@ -0,0 +1,320 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+#include "运行统计.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// 开放寻址哈希表（Swiss table 风格）
+// 原实现每个桶是 {key, 3态枚举}，按 % capacity 逐个探测，删除标记永远不会被复用，
+// expand() 里的探测循环 (j + 1) % capacity 没有赋值，遇到冲突会死循环。
+// 现在把状态单独放进控制字节数组：
+//   控制字节 = 0b0xxxxxxx 时表示占用，低7位是哈希值的 h2 标签
+//   kEmpty   = 0b10000000 空槽
+//   kDeleted = 0b11111110 墓碑
+// 查找时一次取16个控制字节，用 SSE2/NEON 和 h2 做并行比较，只有标签相同的槽位才去比较 key；
+// 组里出现空槽就说明 key 不存在。大多数查找只碰一条控制字节缓存行 + 一条数据缓存行。
+// 容量是2的幂，下标用 & mask 计算；控制字节末尾镜像前16个字节，任意位置开始取一组都不越界。
+
+namespace swiss
+{
+    typedef int8_t ctrl_t;
+    static const ctrl_t kEmpty = -128;
+    static const ctrl_t kDeleted = -2;
+    static const int GROUP_WIDTH = 16;
+
+    // 16个控制字节的并行匹配，结果是16位掩码，第i位为1表示第i个槽位匹配
+    struct Group
+    {
+#if defined(__SSE2__)
+        explicit Group(const ctrl_t *pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))) {}
+
+        uint32_t match(ctrl_t h2) const
+        {
+            return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+        }
+        uint32_t matchEmpty() const
+        {
+            return match(kEmpty);
+        }
+        // kEmpty 和 kDeleted 都小于 -1，占用槽位的标签都 >= 0
+        uint32_t matchEmptyOrDeleted() const
+        {
+            return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+        }
+
+        __m128i ctrl;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        explicit Group(const ctrl_t *pos) : ctrl(vld1q_s8(pos)) {}
+
+        uint32_t match(ctrl_t h2) const
+        {
+            return toMask(vceqq_s8(vdupq_n_s8(h2), ctrl));
+        }
+        uint32_t matchEmpty() const
+        {
+            return match(kEmpty);
+        }
+        uint32_t matchEmptyOrDeleted() const
+        {
+            return toMask(vcltq_s8(ctrl, vdupq_n_s8(-1)));
+        }
+
+        // NEON 没有 movemask：每个字节保留自己对应的位权，再把高低8字节分别横向相加
+        static uint32_t toMask(uint8x16_t eq)
+        {
+            static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            uint8x16_t bits = vandq_u8(eq, vld1q_u8(weights));
+            return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+        }
+
+        int8x16_t ctrl;
+#else
+        explicit Group(const ctrl_t *pos)
+        {
+            std::memcpy(ctrl, pos, GROUP_WIDTH);
+        }
+
+        uint32_t match(ctrl_t h2) const
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < GROUP_WIDTH; i++)
+            {
+                mask |= (uint32_t)(ctrl[i] == h2) << i;
+            }
+            return mask;
+        }
+        uint32_t matchEmpty() const
+        {
+            return match(kEmpty);
+        }
+        uint32_t matchEmptyOrDeleted() const
+        {
+            uint32_t mask = 0;
+            for (int i = 0; i < GROUP_WIDTH; i++)
+            {
+                mask |= (uint32_t)(ctrl[i] < -1) << i;
+            }
+            return mask;
+        }
+
+        ctrl_t ctrl[GROUP_WIDTH];
+#endif
+    };
+
+    // 16位掩码的最低/最高置位
+    inline int lowestBit(uint32_t mask)
+    {
+        return __builtin_ctz(mask);
+    }
+    inline int trailingZeros(uint32_t mask)
+    {
+        return mask == 0 ? GROUP_WIDTH : __builtin_ctz(mask);
+    }
+    inline int leadingZeros(uint32_t mask)
+    {
+        return mask == 0 ? GROUP_WIDTH : __builtin_clz(mask) - (32 - GROUP_WIDTH);
+    }
+
+    // 整数的哈希需要把高位也打散，否则连续的 key 的 h2 标签全部相同
+    inline uint64_t hashInt(int key)
+    {
+        uint64_t x = (uint32_t)key;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+}
+
+class LinearProbingHashTable
+{
+public:
+    LinearProbingHashTable() : ctrl(nullptr), slots(nullptr), capacity(0), size(0), growthLeft(0)
+    {
+        initTable(MIN_CAPACITY);
+    }
+    ~LinearProbingHashTable()
+    {
+        delete[] ctrl;
+        delete[] slots;
+        ctrl = nullptr;
+        slots = nullptr;
+    }
+    LinearProbingHashTable(const LinearProbingHashTable &) = delete;
+    LinearProbingHashTable &operator=(const LinearProbingHashTable &) = delete;
+
+public:
+    // 插入键，已存在时返回false
+    bool insert(int key)
+    {
+        uint64_t hash = swiss::hashInt(key);
+        if (findIndex(key, hash) != -1)
+        {
+            return false;
+        }
+        size_t idx = findInsertSlot(hash);
+        // 复用墓碑不消耗增长余量；用掉空槽时余量不足则先重建
+        if (ctrl[idx] == swiss::kEmpty && growthLeft == 0)
+        {
+            rehashAndGrow();
+            idx = findInsertSlot(hash);
+        }
+        growthLeft -= (ctrl[idx] == swiss::kEmpty);
+        setCtrl(idx, h2(hash));
+        slots[idx] = key;
+        size++;
+        return true;
+    }
+
+    bool erase(int key)
+    {
+        long idx = findIndex(key, swiss::hashInt(key));
+        if (idx == -1)
+        {
+            return false;
+        }
+        size--;
+        // 如果包含该槽位的任意16宽窗口都曾有空槽，那么没有探测序列会"路过"这里，
+        // 可以直接还原为空槽；否则必须留下墓碑，保证后面的 key 仍能被找到
+        size_t before = (idx - swiss::GROUP_WIDTH) & mask();
+        uint32_t emptyAfter = swiss::Group(ctrl + idx).matchEmpty();
+        uint32_t emptyBefore = swiss::Group(ctrl + before).matchEmpty();
+        bool wasNeverFull = emptyBefore && emptyAfter &&
+                            swiss::leadingZeros(emptyBefore) + swiss::trailingZeros(emptyAfter) < swiss::GROUP_WIDTH;
+        setCtrl(idx, wasNeverFull ? swiss::kEmpty : swiss::kDeleted);
+        growthLeft += wasNeverFull;
+        return true;
+    }
+
+    bool find(int key) const
+    {
+        return findIndex(key, swiss::hashInt(key)) != -1;
+    }
+
+    size_t count() const
+    {
+        return size;
+    }
+
+private:
+    swiss::ctrl_t *ctrl;  // capacity + GROUP_WIDTH 个控制字节，末尾镜像前 GROUP_WIDTH 个
+    int *slots;           // 与控制字节一一对应的 key
+    size_t capacity;      // 2的幂
+    size_t size;          // 元素个数
+    size_t growthLeft;    // 还能再用掉多少个空槽（最大负载因子 7/8）
+    static const size_t MIN_CAPACITY = 16;
+
+    size_t mask() const
+    {
+        return capacity - 1;
+    }
+    static uint64_t h1(uint64_t hash)
+    {
+        return hash >> 7;
+    }
+    static swiss::ctrl_t h2(uint64_t hash)
+    {
+        return (swiss::ctrl_t)(hash & 0x7f);
+    }
+    static size_t maxLoad(size_t cap)
+    {
+        return cap - cap / 8;
+    }
+
+    // 设置控制字节，前 GROUP_WIDTH 个同时写镜像
+    void setCtrl(size_t idx, swiss::ctrl_t c)
+    {
+        ctrl[idx] = c;
+        if (idx < swiss::GROUP_WIDTH)
+        {
+            ctrl[capacity + idx] = c;
+        }
+    }
+
+    void initTable(size_t cap)
+    {
+        capacity = cap;
+        ctrl = new swiss::ctrl_t[cap + swiss::GROUP_WIDTH];
+        std::memset(ctrl, (unsigned char)swiss::kEmpty, cap + swiss::GROUP_WIDTH);
+        slots = new int[cap];
+        growthLeft = maxLoad(cap) - size;
+    }
+
+    // 按组做三角探测：偏移依次为 0, 16, 48, 96 ...，容量为2的幂时能覆盖所有组
+    // 统计：每次查找扫过几组，以及 h2 撞上但 key 不同的次数（多了说明哈希的低 7 位分布不好）
+    long findIndex(int key, uint64_t hash) const
+    {
+        size_t pos = h1(hash) & mask();
+        size_t step = 0;
+        while (true)
+        {
+            swiss::Group g(ctrl + pos);
+            for (uint32_t m = g.match(h2(hash)); m != 0; m &= m - 1)
+            {
+                size_t idx = (pos + swiss::lowestBit(m)) & mask();
+                if (slots[idx] == key)
+                {
+                    NOTES_STATS_RECORD("linear.probe_groups", step / swiss::GROUP_WIDTH + 1);
+                    return (long)idx;
+                }
+                NOTES_STATS_ADD("linear.h2_false_match", 1);
+            }
+            if (g.matchEmpty() != 0)
+            {
+                NOTES_STATS_RECORD("linear.probe_groups", step / swiss::GROUP_WIDTH + 1);
+                return -1;
+            }
+            step += swiss::GROUP_WIDTH;
+            pos = (pos + step) & mask();
+        }
+    }
+
+    // 探测序列上第一个空槽或墓碑；growthLeft 保证至少留有一个空槽，循环必然结束
+    size_t findInsertSlot(uint64_t hash) const
+    {
+        size_t pos = h1(hash) & mask();
+        size_t step = 0;
+        while (true)
+        {
+            uint32_t m = swiss::Group(ctrl + pos).matchEmptyOrDeleted();
+            if (m != 0)
+            {
+                return (pos + swiss::lowestBit(m)) & mask();
+            }
+            step += swiss::GROUP_WIDTH;
+            pos = (pos + step) & mask();
+        }
+    }
+
+    // 余量用完时：如果主要是墓碑占位，按原容量重建清掉墓碑；否则容量翻倍
+    void rehashAndGrow()
+    {
+        NOTES_STATS_TIMER("linear.rehash_ns");
+        size_t newCapacity = size * 32 <= capacity * 25 ? capacity : capacity * 2;
+        swiss::ctrl_t *oldCtrl = ctrl;
+        int *oldSlots = slots;
+        size_t oldCapacity = capacity;
+        initTable(newCapacity);
+        for (size_t i = 0; i < oldCapacity; i++)
+        {
+            if (oldCtrl[i] >= 0)
+            {
+                uint64_t hash = swiss::hashInt(oldSlots[i]);
+                size_t idx = findInsertSlot(hash);
+                setCtrl(idx, h2(hash));
+                slots[idx] = oldSlots[i];
+            }
+        }
+        delete[] oldCtrl;
+        delete[] oldSlots;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <memory>
+#include <cstddef>
+
+// 节点池：按块向分配器申请节点，块大小逐次翻倍；释放的节点挂到空闲链表上复用，
+// 只有析构时才把整块还给分配器。插入密集的场景几乎不再调用 malloc，
+// 同一批插入的节点在内存里也是连续的，遍历时更容易命中缓存。
+// 哈希表和各种树共用，Alloc 是向系统申请整块内存用的分配器。
+template <typename Node, typename Alloc>
+class NodePool
+{
+    union Slot
+    {
+        Slot *next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+    struct Chunk
+    {
+        Chunk *next;
+        std::size_t count;
+        Slot *slots;
+    };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Slot> SlotAlloc;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Chunk> ChunkAlloc;
+
+public:
+    explicit NodePool(const Alloc &alloc = Alloc())
+        : slotAlloc(alloc), chunkAlloc(alloc), chunks(nullptr), freeList(nullptr), nextChunkSize(FIRST_CHUNK)
+    {
+    }
+    ~NodePool()
+    {
+        while (chunks != nullptr)
+        {
+            Chunk *c = chunks;
+            chunks = c->next;
+            std::allocator_traits<SlotAlloc>::deallocate(slotAlloc, c->slots, c->count);
+            std::allocator_traits<ChunkAlloc>::deallocate(chunkAlloc, c, 1);
+        }
+    }
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    // 返回未构造的节点内存
+    void *allocate()
+    {
+        if (freeList == nullptr)
+        {
+            grow();
+        }
+        Slot *s = freeList;
+        freeList = s->next;
+        return s->storage;
+    }
+
+    // 节点已经析构，内存挂回空闲链表
+    void deallocate(void *p)
+    {
+        Slot *s = reinterpret_cast<Slot *>(p);
+        s->next = freeList;
+        freeList = s;
+    }
+
+private:
+    SlotAlloc slotAlloc;
+    ChunkAlloc chunkAlloc;
+    Chunk *chunks;       // 已申请的块
+    Slot *freeList;      // 空闲节点
+    std::size_t nextChunkSize;
+    static const std::size_t FIRST_CHUNK = 64;
+    static const std::size_t MAX_CHUNK = 65536;
+
+    void grow()
+    {
+        Chunk *c = std::allocator_traits<ChunkAlloc>::allocate(chunkAlloc, 1);
+        c->count = nextChunkSize;
+        c->slots = std::allocator_traits<SlotAlloc>::allocate(slotAlloc, c->count);
+        c->next = chunks;
+        chunks = c;
+        // 倒序串起来，分配顺序就是地址递增顺序
+        for (std::size_t i = c->count; i > 0; i--)
+        {
+            c->slots[i - 1].next = freeList;
+            freeList = &c->slots[i - 1];
+        }
+        if (nextChunkSize < MAX_CHUNK)
+        {
+            nextChunkSize *= 2;
+        }
+    }
+};
@@ -0,0 +1,394 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 热路径上的运行统计：探测长度、链长、扩容次数和耗时、旋转次数、树的深度。
+// 编译时定义 NOTES_STATS 才生效（cmake -DNOTES_STATS=ON），否则下面几个宏都展开成空语句，热路径上没有任何额外指令；
+// 同一个程序的所有翻译单元要么都定义要么都不定义，不然同一个模板在不同翻译单元里的定义不一致。
+//   NOTES_STATS_ADD(name, n)        计数器加 n
+//   NOTES_STATS_RECORD(name, value) 直方图记一个值，0..62 每个值一个桶，>=63 合成一个桶
+//   NOTES_STATS_TIMER(name)         作用域计时，离开作用域时把耗时（纳秒）记进按 2 的幂分桶的直方图
+// 每个线程第一次记录时领一块自己的计数器，只有这个线程写，不用原子加（load + store 即可），线程之间没有争用；
+// dump 时把所有线程的计数器加起来，读到的是近似值，但不会有数据竞争。线程退出后它那块计数器留给下一个新线程接着用。
+namespace stats
+{
+#if defined(NOTES_STATS)
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    enum Kind
+    {
+        COUNTER, // 只有一个计数
+        LINEAR,  // 值本身就是桶号
+        LOG2     // 桶号是值的二进制位数，桶 b 统计 [2^(b-1), 2^b)
+    };
+
+    const size_t BUCKETS = 64;
+    const size_t HISTOGRAM_SLOTS = BUCKETS + 2; // 各个桶，然后是总和、最大值
+    const size_t MAX_SLOTS = 4096;              // 每个线程的计数器个数，够 60 个直方图
+
+    struct Metric
+    {
+        size_t offset; // 在每个线程的计数器块里的起始下标
+        Kind kind;
+    };
+
+    struct alignas(64) Block
+    {
+        std::atomic<uint64_t> slots[MAX_SLOTS];
+        bool inUse;
+    };
+
+    class Registry
+    {
+    public:
+        // 永不析构：线程可能在静态对象析构之后才退出
+        static Registry &instance()
+        {
+            static Registry *registry = new Registry();
+            return *registry;
+        }
+
+        // 同名的指标只注册一次，模板的每个实例化拿到的是同一个
+        Metric add(const char *name, Kind kind)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            for (const Info &info : metrics_)
+            {
+                if (info.name == name)
+                {
+                    if (info.metric.kind != kind)
+                    {
+                        throw std::logic_error(std::string("统计指标类型冲突: ") + name);
+                    }
+                    return info.metric;
+                }
+            }
+            size_t width = kind == COUNTER ? 1 : HISTOGRAM_SLOTS;
+            if (nextSlot_ + width > MAX_SLOTS)
+            {
+                throw std::length_error("统计指标太多，调大 stats::MAX_SLOTS");
+            }
+            Metric metric{nextSlot_, kind};
+            nextSlot_ += width;
+            metrics_.push_back(Info{name, metric});
+            return metric;
+        }
+
+        Block *acquire()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            for (Block *block : blocks_)
+            {
+                if (!block->inUse)
+                {
+                    block->inUse = true;
+                    return block;
+                }
+            }
+            Block *block = new Block();
+            for (std::atomic<uint64_t> &slot : block->slots)
+            {
+                slot.store(0, std::memory_order_relaxed);
+            }
+            block->inUse = true;
+            blocks_.push_back(block);
+            return block;
+        }
+
+        void release(Block *block)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            block->inUse = false;
+        }
+
+        // 所有线程之和；最大值取各线程的最大值
+        std::vector<uint64_t> total(const Metric &metric)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            size_t width = metric.kind == COUNTER ? 1 : HISTOGRAM_SLOTS;
+            std::vector<uint64_t> sum(width, 0);
+            for (Block *block : blocks_)
+            {
+                for (size_t i = 0; i < width; i++)
+                {
+                    uint64_t v = block->slots[metric.offset + i].load(std::memory_order_relaxed);
+                    sum[i] = metric.kind != COUNTER && i == BUCKETS + 1 ? std::max(sum[i], v) : sum[i] + v;
+                }
+            }
+            return sum;
+        }
+
+        // 按名字排好序的快照
+        std::vector<std::pair<std::string, Metric>> metrics()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            std::vector<std::pair<std::string, Metric>> result;
+            for (const Info &info : metrics_)
+            {
+                result.emplace_back(info.name, info.metric);
+            }
+            std::sort(result.begin(), result.end(), [](const std::pair<std::string, Metric> &a, const std::pair<std::string, Metric> &b)
+                      { return a.first < b.first; });
+            return result;
+        }
+
+        // 别的线程正在写时清零，个别计数可能被它写回去
+        void reset()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            for (Block *block : blocks_)
+            {
+                for (std::atomic<uint64_t> &slot : block->slots)
+                {
+                    slot.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        struct Info
+        {
+            std::string name;
+            Metric metric;
+        };
+
+        std::mutex lock_;
+        std::vector<Info> metrics_;
+        std::vector<Block *> blocks_;
+        size_t nextSlot_ = 0;
+
+        Registry() = default;
+    };
+
+    // 线程退出时把计数器块还回去
+    struct BlockOwner
+    {
+        Block *block = nullptr;
+        ~BlockOwner();
+    };
+
+    // 常量初始化的 thread_local 指针，快路径上直接按 TLS 偏移访问，不经过初始化检查
+    inline Block *&currentBlock()
+    {
+        static thread_local Block *block = nullptr;
+        return block;
+    }
+
+    inline BlockOwner::~BlockOwner()
+    {
+        if (block != nullptr)
+        {
+            currentBlock() = nullptr;
+            Registry::instance().release(block);
+        }
+    }
+
+    inline Block &attachThread()
+    {
+        static thread_local BlockOwner owner;
+        owner.block = Registry::instance().acquire();
+        currentBlock() = owner.block;
+        return *owner.block;
+    }
+
+    inline std::atomic<uint64_t> *localSlots(const Metric &metric)
+    {
+        Block *block = currentBlock();
+        return (block != nullptr ? *block : attachThread()).slots + metric.offset;
+    }
+
+    // 只有本线程写，不需要原子读改写指令
+    inline void bump(std::atomic<uint64_t> &slot, uint64_t n)
+    {
+        slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline Metric registerMetric(const char *name, Kind kind)
+    {
+        return Registry::instance().add(name, kind);
+    }
+
+    inline void add(const Metric &metric, uint64_t n)
+    {
+        bump(*localSlots(metric), n);
+    }
+
+    inline size_t bucketOf(Kind kind, uint64_t value)
+    {
+        if (kind == LINEAR)
+        {
+            return (size_t)std::min<uint64_t>(value, BUCKETS - 1);
+        }
+        size_t bits = 0;
+        while (value != 0 && bits < BUCKETS - 1)
+        {
+            value >>= 1;
+            bits++;
+        }
+        return bits;
+    }
+
+    inline void record(const Metric &metric, uint64_t value)
+    {
+        std::atomic<uint64_t> *slots = localSlots(metric);
+        bump(slots[bucketOf(metric.kind, value)], 1);
+        bump(slots[BUCKETS], value);
+        if (value > slots[BUCKETS + 1].load(std::memory_order_relaxed))
+        {
+            slots[BUCKETS + 1].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const Metric &metric) : metric_(metric), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer()
+        {
+            record(metric_, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Metric metric_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // 桶 b 里最小的值
+    inline uint64_t bucketLow(Kind kind, size_t b)
+    {
+        return kind == LINEAR || b == 0 ? b : (uint64_t)1 << (b - 1);
+    }
+
+    struct Summary
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        std::vector<uint64_t> buckets;
+
+        double mean() const { return count == 0 ? 0 : (double)sum / (double)count; }
+
+        // 第 p 分位所在桶的下界
+        uint64_t percentile(Kind kind, double p) const
+        {
+            uint64_t target = (uint64_t)(p * (double)count);
+            uint64_t seen = 0;
+            for (size_t b = 0; b < buckets.size(); b++)
+            {
+                seen += buckets[b];
+                if (seen > target)
+                {
+                    return bucketLow(kind, b);
+                }
+            }
+            return max;
+        }
+    };
+
+    // 计数器的 count 就是它的值
+    inline Summary summary(const Metric &metric)
+    {
+        std::vector<uint64_t> t = Registry::instance().total(metric);
+        if (metric.kind == COUNTER)
+        {
+            return Summary{t[0], t[0], t[0], {}};
+        }
+        Summary s{0, t[BUCKETS], t[BUCKETS + 1], std::vector<uint64_t>(t.begin(), t.begin() + BUCKETS)};
+        for (uint64_t c : s.buckets)
+        {
+            s.count += c;
+        }
+        return s;
+    }
+
+    // 按名字查，没有注册过（这条路径还没被执行过）时返回全 0
+    inline Summary summary(const std::string &name)
+    {
+        for (const std::pair<std::string, Metric> &m : Registry::instance().metrics())
+        {
+            if (m.first == name)
+            {
+                return summary(m.second);
+            }
+        }
+        return Summary{0, 0, 0, {}};
+    }
+
+    // 每个指标一行摘要，直方图下面再列出非空的桶
+    inline void dump(std::ostream &os)
+    {
+        if (!enabled)
+        {
+            os << "运行统计没有编译进来（需要定义 NOTES_STATS）" << std::endl;
+            return;
+        }
+        os << "---- 运行统计 ----" << std::endl;
+        for (const std::pair<std::string, Metric> &m : Registry::instance().metrics())
+        {
+            Summary s = summary(m.second);
+            Kind kind = m.second.kind;
+            os << std::left << std::setw(28) << m.first << std::right;
+            if (kind == COUNTER)
+            {
+                os << s.count << std::endl;
+                continue;
+            }
+            os << "count " << s.count << "  mean " << std::fixed << std::setprecision(2) << s.mean()
+               << "  p50 " << s.percentile(kind, 0.5) << "  p99 " << s.percentile(kind, 0.99)
+               << "  max " << s.max << std::endl;
+            for (size_t b = 0; b < BUCKETS; b++)
+            {
+                if (s.buckets[b] == 0)
+                {
+                    continue;
+                }
+                std::string label = kind == LINEAR ? std::to_string(b) : ">=" + std::to_string(bucketLow(kind, b));
+                if (kind == LINEAR && b == BUCKETS - 1)
+                {
+                    label = ">=" + label;
+                }
+                os << "    " << std::setw(12) << label << std::setw(14) << s.buckets[b] << std::setw(8)
+                   << std::setprecision(2) << 100.0 * (double)s.buckets[b] / (double)s.count << "%" << std::endl;
+            }
+        }
+        os.unsetf(std::ios::fixed);
+    }
+
+    inline void reset()
+    {
+        Registry::instance().reset();
+    }
+}
+
+#if defined(NOTES_STATS)
+#define NOTES_STATS_METRIC(name, kind)                                  \
+    ([]() -> const stats::Metric & {                                    \
+        static const stats::Metric metric = stats::registerMetric(name, kind); \
+        return metric;                                                  \
+    }())
+#define NOTES_STATS_CONCAT2(a, b) a##b
+#define NOTES_STATS_CONCAT(a, b) NOTES_STATS_CONCAT2(a, b)
+#define NOTES_STATS_ADD(name, n) stats::add(NOTES_STATS_METRIC(name, stats::COUNTER), (n))
+#define NOTES_STATS_RECORD(name, value) stats::record(NOTES_STATS_METRIC(name, stats::LINEAR), (value))
+#define NOTES_STATS_TIMER(name) \
+    stats::ScopedTimer NOTES_STATS_CONCAT(statsTimer, __LINE__)(NOTES_STATS_METRIC(name, stats::LOG2))
+#else
+// sizeof 不求值，只是让只为统计而算的局部变量不报"未使用"警告
+#define NOTES_STATS_ADD(name, n) ((void)sizeof(n))
+#define NOTES_STATS_RECORD(name, value) ((void)sizeof(value))
+#define NOTES_STATS_TIMER(name) ((void)0)
+#endif
@@ -0,0 +1,594 @@
+#pragma once
+#include <vector>
+#include <new>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "节点池.h"
+#include "运行统计.h"
+
+// 链式哈希表的实现
+// HashTable<K, V, Hash, Eq, Alloc>：任意键值类型，哈希函数/比较函数/分配器可替换。
+// 桶数是2的幂，按元素个数/桶数的负载因子翻倍扩容，不再受素数表长度限制；
+// 节点上缓存完整哈希值，扩容时直接按缓存值把节点重新挂到新桶，不重新计算哈希也不重新分配节点。
+// 桶是侵入式单链表，节点从块式节点池里分配，不再是每个元素一个 std::list 双向链表节点。
+
+// wyhash 风格的默认哈希：整数做一次 128 位乘法折叠，字符串按 wyhash 的分块方式混合
+namespace fasthash
+{
+    static const uint64_t SECRET0 = 0xa0761d6478bd642fULL;
+    static const uint64_t SECRET1 = 0xe7037ed1a0b428dbULL;
+    static const uint64_t SECRET2 = 0x8ebc6af09c88c6e3ULL;
+    static const uint64_t SECRET3 = 0x589965cc75374cc3ULL;
+
+    // 64x64 -> 128 位乘法，高低两半异或
+    inline uint64_t mix(uint64_t a, uint64_t b)
+    {
+        __uint128_t r = (__uint128_t)a * b;
+        return (uint64_t)r ^ (uint64_t)(r >> 64);
+    }
+
+    inline uint64_t read8(const uint8_t *p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
+    }
+    inline uint64_t read4(const uint8_t *p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    // 1~3 字节：取首、中、尾三个字节
+    inline uint64_t read3(const uint8_t *p, size_t len)
+    {
+        return ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+    }
+
+    inline uint64_t hashBytes(const void *key, size_t len, uint64_t seed = 0)
+    {
+        const uint8_t *p = (const uint8_t *)key;
+        seed ^= mix(seed ^ SECRET0, SECRET1);
+        uint64_t a, b;
+        if (len <= 16)
+        {
+            if (len >= 4)
+            {
+                // 4~16 字节：首尾各取两个可能重叠的4字节
+                a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+                b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+            }
+            else if (len > 0)
+            {
+                a = read3(p, len);
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            size_t i = len;
+            if (i > 48)
+            {
+                // 长串三路并行混合，打断乘法的依赖链
+                uint64_t see1 = seed, see2 = seed;
+                do
+                {
+                    seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+                    see1 = mix(read8(p + 16) ^ SECRET2, read8(p + 24) ^ see1);
+                    see2 = mix(read8(p + 32) ^ SECRET3, read8(p + 40) ^ see2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= see1 ^ see2;
+            }
+            while (i > 16)
+            {
+                seed = mix(read8(p) ^ SECRET1, read8(p + 8) ^ seed);
+                p += 16;
+                i -= 16;
+            }
+            a = read8(p + i - 16);
+            b = read8(p + i - 8);
+        }
+        return mix(SECRET1 ^ len, mix(a ^ SECRET1, b ^ seed));
+    }
+
+    inline uint64_t hashInt(uint64_t x)
+    {
+        return mix(x ^ SECRET0, SECRET1);
+    }
+}
+
+// 默认哈希：其它类型先用 std::hash，再混合一次，保证低位也足够随机（桶下标用 & mask）
+template <typename K, typename = void>
+struct FastHash
+{
+    size_t operator()(const K &key) const
+    {
+        return fasthash::hashInt(std::hash<K>()(key));
+    }
+};
+
+template <typename K>
+struct FastHash<K, typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value>::type>
+{
+    size_t operator()(K key) const
+    {
+        return fasthash::hashInt((uint64_t)key);
+    }
+};
+
+template <>
+struct FastHash<std::string_view>
+{
+    size_t operator()(std::string_view key) const
+    {
+        return fasthash::hashBytes(key.data(), key.size());
+    }
+};
+
+template <>
+struct FastHash<std::string>
+{
+    size_t operator()(const std::string &key) const
+    {
+        return fasthash::hashBytes(key.data(), key.size());
+    }
+};
+
+template <typename K, typename V,
+          typename Hash = FastHash<K>,
+          typename Eq = std::equal_to<K>,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+class HashTable
+{
+    // 侵入式单链表节点：next 指针和缓存的完整哈希直接放在节点里，
+    // 比较键之前先比较哈希，扩容时直接用它算新桶
+    struct Node
+    {
+        Node *next;
+        size_t hash;
+        K key;
+        V value;
+    };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node *> BucketAlloc;
+
+public:
+    explicit HashTable(size_t buckets = MIN_BUCKETS, const Hash &hash = Hash(), const Eq &eq = Eq(), const Alloc &alloc = Alloc())
+        : table(roundUpPow2(buckets), nullptr, BucketAlloc(alloc)), pool(alloc), elementCount(0), maxLoadFactor(1.0), hasher(hash), keyEq(eq)
+    {
+    }
+
+    ~HashTable()
+    {
+        clear();
+    }
+    HashTable(const HashTable &) = delete;
+    HashTable &operator=(const HashTable &) = delete;
+
+public:
+    // 插入键值对，键已存在时返回false
+    bool insert(K key, V value)
+    {
+        size_t h = hasher(key);
+        if (findNode(key, h) != nullptr)
+        {
+            return false; // 键已存在
+        }
+        if ((double)(elementCount + 1) > maxLoadFactor * table.size())
+        {
+            expand();
+        }
+        Node *&head = table[h & (table.size() - 1)];
+        head = new (pool.allocate()) Node{head, h, std::move(key), std::move(value)};
+        elementCount++;
+        return true;
+    }
+
+    bool remove(const K &key)
+    {
+        size_t h = hasher(key);
+        for (Node **pp = &table[h & (table.size() - 1)]; *pp != nullptr; pp = &(*pp)->next)
+        {
+            Node *node = *pp;
+            if (node->hash == h && keyEq(node->key, key))
+            {
+                *pp = node->next;
+                destroyNode(node);
+                elementCount--;
+                return true;
+            }
+        }
+        return false; // 键不存在
+    }
+
+    // 查找键值对，不存在时返回nullptr
+    V *find(const K &key)
+    {
+        Node *node = findNode(key, hasher(key));
+        return node == nullptr ? nullptr : &node->value;
+    }
+
+    bool contains(const K &key) const
+    {
+        return findNode(key, hasher(key)) != nullptr;
+    }
+
+    // 不存在时插入默认值
+    V &operator[](const K &key)
+    {
+        size_t h = hasher(key);
+        Node *node = findNode(key, h);
+        if (node != nullptr)
+        {
+            return node->value;
+        }
+        insert(key, V());
+        return findNode(key, h)->value;
+    }
+
+    // 预留能容纳n个元素的桶数，避免批量插入时多次扩容
+    void reserve(size_t n)
+    {
+        while (maxLoadFactor * table.size() < (double)n)
+        {
+            expand();
+        }
+    }
+
+    // 删除所有元素，节点内存留在池里给后续插入复用
+    void clear()
+    {
+        for (Node *&head : table)
+        {
+            while (head != nullptr)
+            {
+                Node *node = head;
+                head = node->next;
+                destroyNode(node);
+            }
+        }
+        elementCount = 0;
+    }
+
+    size_t size() const
+    {
+        return elementCount;
+    }
+
+    size_t bucketCount() const
+    {
+        return table.size();
+    }
+
+    // 按桶的顺序访问每个键值对，写快照用
+    template <typename F>
+    void forEach(F visit) const
+    {
+        for (Node *head : table)
+        {
+            for (Node *node = head; node != nullptr; node = node->next)
+            {
+                visit(node->key, node->value);
+            }
+        }
+    }
+
+private:
+    std::vector<Node *, BucketAlloc> table; // 每个桶只存链表头指针，大小是2的幂
+    NodePool<Node, Alloc> pool;        // 所有节点都从这里分配
+    size_t elementCount;               // 元素个数
+    double maxLoadFactor;              // 负载因子（元素数/桶数）
+    Hash hasher;
+    Eq keyEq;
+    static const size_t MIN_BUCKETS = 8;
+
+    static size_t roundUpPow2(size_t n)
+    {
+        size_t cap = MIN_BUCKETS;
+        while (cap < n)
+        {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    // 统计：每次查找在链上走过的节点数（没找到时就是整条链长）
+    Node *findNode(const K &key, size_t h) const
+    {
+        size_t steps = 0;
+        for (Node *node = table[h & (table.size() - 1)]; node != nullptr; node = node->next)
+        {
+            steps++;
+            if (node->hash == h && keyEq(node->key, key))
+            {
+                NOTES_STATS_RECORD("chained.lookup_length", steps);
+                return node;
+            }
+        }
+        NOTES_STATS_RECORD("chained.lookup_length", steps);
+        return nullptr;
+    }
+
+    void destroyNode(Node *node)
+    {
+        node->~Node();
+        pool.deallocate(node);
+    }
+
+private:
+    // 扩容哈希表：桶数翻倍，节点按缓存的哈希重新挂链，键值本身不动
+    void expand()
+    {
+        rehashInto(table.size() * 2);
+    }
+
+    // 把所有节点挂到新的桶数组上，旧桶数组返回给调用者决定何时释放
+    // （并发版本要等读者不再访问后才能释放）
+    // 统计：每次扩容的耗时，以及扩容后每个桶的链长分布
+    std::vector<Node *, BucketAlloc> rehashInto(size_t buckets)
+    {
+        NOTES_STATS_TIMER("chained.rehash_ns");
+        std::vector<Node *, BucketAlloc> oldtable(buckets, nullptr, table.get_allocator());
+        oldtable.swap(table);
+        size_t mask = table.size() - 1;
+        for (Node *node : oldtable)
+        {
+            while (node != nullptr)
+            {
+                Node *next = node->next;
+                Node *&head = table[node->hash & mask];
+                node->next = head;
+                head = node;
+                node = next;
+            }
+        }
+        if (stats::enabled)
+        {
+            for (Node *node : table)
+            {
+                size_t length = 0;
+                for (; node != nullptr; node = node->next)
+                {
+                    length++;
+                }
+                NOTES_STATS_RECORD("chained.bucket_length", length);
+            }
+        }
+        return oldtable;
+    }
+
+    template <typename, typename, typename, typename, typename>
+    friend class ConcurrentHashTable;
+};
+
+// 并发分片哈希表：按哈希高位分到 N 个分片，每个分片是一个 HashTable 加一把写锁和一个 seqlock 序号。
+// 写者持分片锁修改，修改前后各把序号加一（奇数表示正在写）；
+// 读者不加锁：记下序号 -> 遍历链表 -> 再读序号，两次相同且为偶数说明读到的是一致的快照，否则重试。
+// 读者可能读到正在被修改/已被删除的节点，所以要求：
+//   1. 节点内存不能还给系统：节点池只在析构时释放整块，删除的节点只是挂回空闲链表；
+//   2. 扩容后的旧桶数组不能立即释放：放进 retired 里，直到整个表析构；
+//   3. K 和 V 必须是可平凡拷贝的，读到撕裂的值也不会出错，序号校验失败后丢弃即可。
+template <typename K, typename V,
+          typename Hash = FastHash<K>,
+          typename Eq = std::equal_to<K>,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+class ConcurrentHashTable
+{
+    static_assert(std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value,
+                  "乐观读要求键值可平凡拷贝");
+
+    typedef HashTable<K, V, Hash, Eq, Alloc> Table;
+    typedef typename Table::Node Node;
+    typedef std::vector<Node *, typename Table::BucketAlloc> Buckets;
+
+    // 每个分片独占缓存行，避免不同分片的序号和锁互相伪共享
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<Node *const *> buckets{nullptr}; // 读者看到的桶数组
+        std::atomic<size_t> mask{0};
+        std::mutex writeLock;
+        Table table;
+        std::vector<Buckets> retired; // 扩容换下来的旧桶数组
+
+        Shard(const Hash &hash, const Eq &eq, const Alloc &alloc) : table(MIN_SHARD_BUCKETS, hash, eq, alloc)
+        {
+            publish();
+        }
+
+        // 先发布数组再发布掩码；读者先读掩码再读数组，看到新掩码时一定能看到不小于它的数组
+        void publish()
+        {
+            buckets.store(table.table.data(), std::memory_order_relaxed);
+            mask.store(table.table.size() - 1, std::memory_order_release);
+        }
+    };
+
+public:
+    explicit ConcurrentHashTable(size_t shards = DEFAULT_SHARDS, const Hash &hash = Hash(), const Eq &eq = Eq(), const Alloc &alloc = Alloc())
+        : shardCount(roundUpPow2(shards)), shardShift(64 - log2(shardCount)), hasher(hash), keyEq(eq)
+    {
+        for (size_t i = 0; i < shardCount; i++)
+        {
+            shards_.emplace_back(new Shard(hash, eq, alloc));
+        }
+    }
+
+    // 不存在时插入，返回是否插入
+    bool insert(const K &key, const V &value)
+    {
+        size_t h = hasher(key);
+        Shard &s = shardFor(h);
+        std::lock_guard<std::mutex> lock(s.writeLock);
+        if (s.table.findNode(key, h) != nullptr)
+        {
+            return false;
+        }
+        WriteSection ws(s);
+        growIfNeeded(s);
+        return s.table.insert(key, value);
+    }
+
+    // 插入或覆盖
+    void assign(const K &key, const V &value)
+    {
+        size_t h = hasher(key);
+        Shard &s = shardFor(h);
+        std::lock_guard<std::mutex> lock(s.writeLock);
+        WriteSection ws(s);
+        Node *node = s.table.findNode(key, h);
+        if (node != nullptr)
+        {
+            node->value = value;
+            return;
+        }
+        growIfNeeded(s);
+        s.table.insert(key, value);
+    }
+
+    bool remove(const K &key)
+    {
+        Shard &s = shardFor(hasher(key));
+        std::lock_guard<std::mutex> lock(s.writeLock);
+        WriteSection ws(s);
+        return s.table.remove(key);
+    }
+
+    // 无锁查找，找到时把值拷贝到 out
+    bool find(const K &key, V &out) const
+    {
+        size_t h = hasher(key);
+        const Shard &s = shardFor(h);
+        while (true)
+        {
+            uint64_t begin = s.seq.load(std::memory_order_acquire);
+            if (begin & 1)
+            {
+                std::this_thread::yield(); // 写者正在修改
+                continue;
+            }
+            size_t mask = s.mask.load(std::memory_order_acquire);
+            Node *const *buckets = s.buckets.load(std::memory_order_relaxed);
+            bool found = false;
+            V value{};
+            Node *node = __atomic_load_n(&buckets[h & mask], __ATOMIC_RELAXED);
+            size_t steps = 1;
+            for (; node != nullptr; steps++)
+            {
+                if (__atomic_load_n(&node->hash, __ATOMIC_RELAXED) == h && keyEq(node->key, key))
+                {
+                    value = node->value;
+                    found = true;
+                    break;
+                }
+                node = __atomic_load_n(&node->next, __ATOMIC_RELAXED);
+                // 并发修改下链表可能暂时成环，定期检查序号，变了就提前重试
+                if (steps % 64 == 0 && s.seq.load(std::memory_order_relaxed) != begin)
+                {
+                    break;
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) == begin)
+            {
+                NOTES_STATS_RECORD("chained.lookup_length", found ? steps : steps - 1);
+                if (found)
+                {
+                    out = value;
+                }
+                return found;
+            }
+        }
+    }
+
+    bool contains(const K &key) const
+    {
+        V value;
+        return find(key, value);
+    }
+
+    // 各分片元素数之和，并发修改时只是近似值
+    size_t size() const
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < shardCount; i++)
+        {
+            n += __atomic_load_n(&shards_[i]->table.elementCount, __ATOMIC_RELAXED);
+        }
+        return n;
+    }
+
+private:
+    static const size_t DEFAULT_SHARDS = 64;
+    static const size_t MIN_SHARD_BUCKETS = 64;
+
+    size_t shardCount;
+    int shardShift;
+    Hash hasher;
+    Eq keyEq;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // 写区间：构造时序号变奇数，析构时变回偶数
+    struct WriteSection
+    {
+        Shard &s;
+        explicit WriteSection(Shard &shard) : s(shard)
+        {
+            s.seq.store(s.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        ~WriteSection()
+        {
+            s.seq.store(s.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    };
+
+    static size_t roundUpPow2(size_t n)
+    {
+        size_t cap = 1;
+        while (cap < n)
+        {
+            cap <<= 1;
+        }
+        return cap;
+    }
+    static int log2(size_t n)
+    {
+        int bits = 0;
+        while (((size_t)1 << bits) < n)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    // 分片用哈希高位，桶下标用低位，两者互不相关
+    Shard &shardFor(size_t h) const
+    {
+        return *shards_[shardShift == 64 ? 0 : h >> shardShift];
+    }
+
+    // 代替 HashTable::insert 里的自动扩容：旧桶数组留给可能还在读它的读者
+    void growIfNeeded(Shard &s)
+    {
+        Table &t = s.table;
+        if ((double)(t.elementCount + 1) > t.maxLoadFactor * t.table.size())
+        {
+            s.retired.push_back(t.rehashInto(t.table.size() * 2));
+            s.publish();
+        }
+    }
+};
@@ -1,154 +1,155 @@
 #include <iostream>
 #include <vector>
-#include <list>
-#include <algorithm>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include "链式哈希表.h"
+#include "映射快照.h"
 using namespace std;
 
-// 链式哈希表的实现
-
-class HashTable
+// 多线程读写混合压测：每个线程在 keys 个键上随机读写，直到 stop 被置位
+static void benchWorker(ConcurrentHashTable<uint64_t, uint64_t> *map, int id, int readPercent, uint64_t keys,
+                        const atomic<bool> *stop, uint64_t *ops)
 {
-public:
-    HashTable() : size(PRIME[0]), useBucketnumber(0), loadFactor(0.75), PRIME_INDEX(0)
-    {
-        if (size != PRIME[0])
-        {
-            while (PRIME[PRIME_INDEX] < size)
-            {
-                PRIME_INDEX++;
-            }
-            size = PRIME[PRIME_INDEX];
-        }
-        table.resize(size);
-    }
-
-    ~HashTable() {}
-
-public:
-    // 插入键值对
-    bool insert(int key)
+    uint64_t rng = 0x9E3779B97F4A7C15ULL * (id + 1);
+    uint64_t n = 0;
+    while (!stop->load(memory_order_relaxed))
     {
-        double loadfactor = (double)useBucketnumber / size;
-        if (loadfactor > loadFactor)
+        // xorshift64
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        uint64_t key = rng % keys;
+        uint64_t value;
+        if ((int)((rng >> 40) % 100) < readPercent)
         {
-            expand();
+            map->find(key, value);
         }
-        int idx = key % size;
-        if (table[idx].empty())
+        else if (rng & (1ULL << 32))
         {
-            useBucketnumber++;
-            table[idx].emplace_front(key);
-            return true;
+            map->assign(key, key);
         }
         else
         {
-            auto it = std::find(table[idx].begin(), table[idx].end(), key);
-            if (it == table[idx].end())
-            {
-                table[idx].emplace_front(key);
-            }
-            else
-            {
-                return false; // 键已存在
-            }
+            map->remove(key);
         }
-        return true;
+        n++;
     }
+    *ops = n;
+}
 
-    bool remove(int key)
+// 返回每秒百万次操作数
+static double benchConcurrent(ConcurrentHashTable<uint64_t, uint64_t> &map, int threads, int readPercent, double seconds, uint64_t keys)
+{
+    atomic<bool> stop{false};
+    vector<uint64_t> ops(threads, 0);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++)
     {
-        int idx = key % size;
-        auto it = std::find(table[idx].begin(), table[idx].end(), key);
-        if (it != table[idx].end())
-        {
-            table[idx].erase(it);
-            if (table[idx].empty())
-            {
-                useBucketnumber--;
-            }
-            return true;
-        }
-        return false; // 键不存在
+        workers.emplace_back(benchWorker, &map, t, readPercent, keys, &stop, &ops[t]);
+    }
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop.store(true);
+    uint64_t total = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].join();
+        total += ops[t];
+    }
+    return total / seconds / 1e6;
+}
+
+// 用法: ./a.out [bench [read_percent] [seconds_per_run]]
+int main(int argc, char *argv[])
+{
+    HashTable<int, int> hashTable;
+    hashTable.insert(1, 10);
+    hashTable.insert(2, 20);
+    hashTable.insert(3, 30);
+    hashTable.insert(4, 40);
+    hashTable.insert(5, 50);
+
+    std::cout << "Find 1: " << hashTable.contains(1) << std::endl; // true
+    std::cout << "Find 2: " << hashTable.contains(2) << std::endl; // true
+    std::cout << "Find 3: " << hashTable.contains(3) << std::endl; // true
+    std::cout << "Find 4: " << hashTable.contains(4) << std::endl; // true
+    std::cout << "Find 5: " << hashTable.contains(5) << std::endl; // true
+    hashTable.remove(3);
+    std::cout << "Find 3 after removal: " << hashTable.contains(3) << std::endl; // false
+    hashTable.remove(1);
+    std::cout << "Find 1 after removal: " << hashTable.contains(1) << std::endl; // false
+    std::cout << "Value of 4: " << *hashTable.find(4) << std::endl;         // 40
+
+    // 字符串键：超过原素数表上限（2869个桶）后继续扩容
+    HashTable<string, int> sessions;
+    for (int i = 0; i < 200000; i++)
+    {
+        sessions["session-" + to_string(i)] = i;
     }
+    int missing = 0;
+    for (int i = 0; i < 200000; i++)
+    {
+        int *v = sessions.find("session-" + to_string(i));
+        missing += (v == nullptr || *v != i);
+    }
+    std::cout << "Sessions: " << sessions.size() << ", buckets: " << sessions.bucketCount()
+              << ", mismatches: " << missing << std::endl; // 200000, 262144, 0
 
-    // 查找键值对
-    bool find(int key)
+    ConcurrentHashTable<uint64_t, uint64_t> shared;
+    for (uint64_t i = 0; i < 1000; i++)
     {
-        int idx = key % size;
-        for (auto it = table[idx].begin(); it != table[idx].end(); ++it)
-        {
-            if (*it == key)
-            {
-                return true;
-            }
-        }
-        return false;
+        shared.insert(i, i * i);
     }
+    uint64_t square = 0;
+    std::cout << "Concurrent find 30: " << shared.find(30, square) << " " << square << std::endl; // 1 900
 
-private:
-    vector<list<int>> table;          // 哈希表的底层存储结构
-    int size;                         // 哈希表的大小
-    int useBucketnumber;              // 已使用的桶数
-    double loadFactor;                // 负载因子
-    static const int PRIME_SIZE = 10; // 默认容量
-    static int PRIME[PRIME_SIZE];     // 素数表
-    int PRIME_INDEX;                  // 素数表的索引
+    // 快照：写成按桶排好的定长数组，重新打开时 mmap 进来原地查
+    HashTable<uint64_t, uint64_t> index;
+    for (uint64_t i = 0; i < 1000000; i++)
+    {
+        index.insert(i * 7, i);
+    }
+    typedef snapshot::HashSnapshot<uint64_t, uint64_t, FastHash<uint64_t>> IndexSnapshot;
+    const char *path = "hashtable.snapshot";
+    auto start = chrono::steady_clock::now();
+    IndexSnapshot::write(path, index);
+    double writeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    IndexSnapshot mapped(path);
+    size_t wrong = 0;
+    for (uint64_t i = 0; i < 2000000; i++)
+    {
+        const uint64_t *v = mapped.find(i * 7);
+        wrong += i < 1000000 ? (v == nullptr || *v != i) : (v != nullptr);
+    }
+    double queryMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    std::cout << "Snapshot of " << mapped.size() << ": write " << writeMs << " ms, map + 2M finds " << queryMs
+              << " ms, wrong " << wrong << std::endl; // wrong 0
+    remove(path);
 
-private:
-    // 扩容哈希表
-    void expand()
+    if (argc > 1 && string(argv[1]) == "bench")
     {
-        int oldsize = size;
-        vector<list<int>> oldtable;
-        oldtable.swap(table);
-        size = PRIME[++PRIME_INDEX];
-        table.resize(size);
-        useBucketnumber = 0;
-        for (int i = 0; i < oldsize; i++)
+        int readPercent = argc > 2 ? atoi(argv[2]) : 90;
+        double seconds = argc > 3 ? atof(argv[3]) : 1.0;
+        const uint64_t keys = 1 << 20;
+        std::cout << "read " << readPercent << "%, " << keys << " keys" << std::endl;
+        for (int threads = 1; threads <= 64; threads *= 2)
         {
-            for (auto it = oldtable[i].begin(); it != oldtable[i].end(); ++it)
+            ConcurrentHashTable<uint64_t, uint64_t> map;
+            for (uint64_t i = 0; i < keys; i += 2)
             {
-                int idx = *it % size;
-                if (table[idx].empty())
-                {
-                    useBucketnumber++;
-                }
-                table[idx].emplace_front(*it);
+                map.insert(i, i);
             }
+            double mops = benchConcurrent(map, threads, readPercent, seconds, keys);
+            std::cout << "threads " << setw(2) << threads << ": " << fixed << setprecision(2) << mops << " Mops/s" << std::endl;
         }
     }
-};
-
-int HashTable::PRIME[PRIME_SIZE] = {
-    3,
-    7,
-    23,
-    47,
-    97,
-    251,
-    443,
-    911,
-    1471,
-    2869};
-
-int main()
-{
-    HashTable hashTable;
-    hashTable.insert(1);
-    hashTable.insert(2);
-    hashTable.insert(3);
-    hashTable.insert(4);
-    hashTable.insert(5);
-
-    std::cout << "Find 1: " << hashTable.find(1) << std::endl; // true
-    std::cout << "Find 2: " << hashTable.find(2) << std::endl; // true
-    std::cout << "Find 3: " << hashTable.find(3) << std::endl; // true
-    std::cout << "Find 4: " << hashTable.find(4) << std::endl; // true
-    std::cout << "Find 5: " << hashTable.find(5) << std::endl; // true
-    hashTable.remove(3);
-    std::cout << "Find 3 after removal: " << hashTable.find(3) << std::endl; // false
-    hashTable.remove(1);
-    std::cout << "Find 1 after removal: " << hashTable.find(1) << std::endl; // false
 
+    if (stats::enabled)
+    {
+        stats::dump(std::cout); // 以 -DNOTES_STATS 编译时输出所有线程合计的链长分布和扩容耗时
+    }
     return 0;
 }
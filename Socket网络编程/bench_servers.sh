@@ -0,0 +1,52 @@
+#!/bin/bash
+# 用 echo_bench 依次压测本目录下的各种回显服务器，对比吞吐和延迟分布
+#   epoll-LT      : epoll.c        （水平触发，固定端口9999）
+#   epoll-ET      : epollet.c      （边缘触发，单reactor）
+#   epoll-ET-xN   : epollet.c      （N个reactor，SO_REUSEPORT）
+#   epoll-splice  : epollet.c      （splice 零拷贝回显）
+#   thread-pool   : select_sever.c （多路复用线程 + 线程池，固定端口8080）
+#   io_uring      : uring_server.c
+# 用法: ./bench_servers.sh [threads] [conns_per_thread] [msg_size] [seconds] [pipeline]
+# 例如 10k 连接: ./bench_servers.sh 8 1250 64 10 1
+
+THREADS=${1:-4}
+CONNS=${2:-256}
+MSG_SIZE=${3:-64}
+SECONDS_PER_RUN=${4:-10}
+PIPELINE=${5:-1}
+SERVER_WORKERS=${SERVER_WORKERS:-$(nproc)}
+BUILD_DIR=${BUILD_DIR:-/tmp/socket_bench}
+
+set -e
+cd "$(dirname "$0")"
+mkdir -p "$BUILD_DIR"
+
+# 一万以上的连接需要放开fd上限
+ulimit -n 200000 2>/dev/null || ulimit -n "$(ulimit -Hn)"
+
+gcc -O2 -pthread -o "$BUILD_DIR/echo_bench" echo_bench.c
+gcc -O2 -o "$BUILD_DIR/epoll_lt" epoll.c
+gcc -O2 -pthread -o "$BUILD_DIR/epoll_et" epollet.c
+gcc -O2 -pthread -o "$BUILD_DIR/thread_pool" select_sever.c
+gcc -O2 -o "$BUILD_DIR/uring_server" uring_server.c
+
+run_one() {
+    local name=$1
+    local port=$2
+    shift 2
+    "$@" >/dev/null 2>&1 &
+    local pid=$!
+    sleep 0.5
+    echo "===== $name ====="
+    "$BUILD_DIR/echo_bench" -t "$THREADS" -c "$CONNS" -s "$MSG_SIZE" -p "$PIPELINE" \
+        -d "$SECONDS_PER_RUN" 127.0.0.1 "$port"
+    kill "$pid" 2>/dev/null || true  # epoll.c 遇到连接重置会自己退出
+    wait "$pid" 2>/dev/null || true
+}
+
+run_one epoll-LT 9999 "$BUILD_DIR/epoll_lt"
+run_one epoll-ET 9998 "$BUILD_DIR/epoll_et" 9998 1
+run_one "epoll-ET-x$SERVER_WORKERS" 9996 "$BUILD_DIR/epoll_et" 9996 "$SERVER_WORKERS"
+run_one epoll-splice 9995 "$BUILD_DIR/epoll_et" 9995 "$SERVER_WORKERS" splice
+run_one thread-pool 8080 "$BUILD_DIR/thread_pool" "$SERVER_WORKERS"
+run_one io_uring 9997 "$BUILD_DIR/uring_server" 9997
@@ -0,0 +1,458 @@
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+
+// 回显服务器压测工具：多线程、每线程一个epoll管理上千条连接
+// 每条连接保持 pipeline 条消息在途（闭环：收齐一条回显就补发一条），
+// 逐条记录往返延迟到 HDR 风格的对数-线性直方图，最后汇总吞吐和 p50/p99/p999
+// 用法: ./echo_bench [-t threads] [-c conns_per_thread] [-s msg_size] [-p pipeline]
+//                    [-d seconds] [-w warmup_seconds] <ip> <port>
+
+#define MAX_EVENTS 1024
+#define MAX_THREADS 256
+
+// ---------------------------------------------------------------------------
+// HDR 风格直方图：小于 2^HIST_SUB_BITS 的值精确计数，更大的值按2的幂分段，
+// 每段再线性分成 2^(HIST_SUB_BITS-1) 个子桶，相对误差 < 1/64
+// 记录是一次数组自增，各线程各自一份，结束后合并，不需要任何同步
+// ---------------------------------------------------------------------------
+#define HIST_SUB_BITS 7
+#define HIST_HALF (1 << (HIST_SUB_BITS - 1))
+#define HIST_BUCKETS (64 * HIST_HALF)
+
+typedef struct
+{
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+    double sum;
+} histogram;
+
+static inline int hist_index(uint64_t v)
+{
+    if (v < (1u << HIST_SUB_BITS))
+    {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - HIST_SUB_BITS + 1;
+    return (shift << (HIST_SUB_BITS - 1)) + (int)(v >> shift);
+}
+
+// 桶的下界
+static inline uint64_t hist_value(int idx)
+{
+    if (idx < (1 << HIST_SUB_BITS))
+    {
+        return idx;
+    }
+    int shift = (idx >> (HIST_SUB_BITS - 1)) - 1;
+    uint64_t mant = idx - ((uint64_t)shift << (HIST_SUB_BITS - 1));
+    return mant << shift;
+}
+
+static inline void hist_record(histogram *h, uint64_t v)
+{
+    h->counts[hist_index(v)]++;
+    h->total++;
+    h->sum += v;
+    if (v > h->max)
+    {
+        h->max = v;
+    }
+}
+
+static void hist_merge(histogram *dst, const histogram *src)
+{
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    dst->sum += src->sum;
+    if (src->max > dst->max)
+    {
+        dst->max = src->max;
+    }
+}
+
+// 百分位：累计计数第一次达到 q*total 的桶，取桶区间中点
+static uint64_t hist_percentile(const histogram *h, double q)
+{
+    if (h->total == 0)
+    {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(q * h->total);
+    if (target == 0)
+    {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->counts[i];
+        if (seen >= target)
+        {
+            uint64_t lo = hist_value(i);
+            uint64_t hi = i + 1 < HIST_BUCKETS ? hist_value(i + 1) : lo;
+            uint64_t mid = lo + (hi - lo) / 2;
+            return mid < h->max ? mid : h->max;
+        }
+    }
+    return h->max;
+}
+
+// ---------------------------------------------------------------------------
+// 压测连接与线程
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    int fd;
+    uint64_t to_send;   // 已排队、尚未写出的字节
+    uint64_t sent;      // 累计写出的字节（用于计算消息内偏移）
+    size_t received;    // 当前消息已收到的回显字节
+    uint64_t *start_ns; // 在途消息的发出时间，按顺序回显所以是一个环
+    int ts_head;
+    int ts_count;
+} bench_conn;
+
+typedef struct
+{
+    pthread_t thread_id;
+    int nconns;
+    int connected;
+    double connect_seconds;
+    unsigned long long messages;
+    unsigned long long bytes;
+    histogram hist; // 延迟，单位纳秒
+} bench_thread;
+
+static struct sockaddr_in g_server_addr;
+static size_t g_msg_size = 64;
+static int g_pipeline = 1;
+static int g_seconds = 10;
+static int g_warmup = 1;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        perror("fcntl");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// 排队一条新消息并记录发出时间
+static void conn_enqueue(bench_conn *c, uint64_t now)
+{
+    c->start_ns[(c->ts_head + c->ts_count) % g_pipeline] = now;
+    c->ts_count++;
+    c->to_send += g_msg_size;
+}
+
+// 尽量把排队的字节写完；消息内容固定，按累计偏移从同一块缓冲区里取；返回-1表示连接出错
+static int conn_flush(bench_conn *c, const char *msg)
+{
+    while (c->to_send > 0)
+    {
+        size_t off = c->sent % g_msg_size;
+        size_t len = g_msg_size - off;
+        if (len > c->to_send)
+        {
+            len = c->to_send;
+        }
+        ssize_t n = write(c->fd, msg + off, len);
+        if (n > 0)
+        {
+            c->sent += n;
+            c->to_send -= n;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 0;
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void conn_drop(bench_conn *c)
+{
+    close(c->fd);
+    c->fd = -1;
+}
+
+static void *bench_worker(void *arg)
+{
+    bench_thread *t = (bench_thread *)arg;
+    size_t buf_size = g_msg_size * g_pipeline < 65536 ? g_msg_size * g_pipeline : 65536;
+    char *msg = malloc(g_msg_size);
+    char *buf = malloc(buf_size);
+    bench_conn *conns = calloc(t->nconns, sizeof(bench_conn));
+    uint64_t *stamps = calloc((size_t)t->nconns * g_pipeline, sizeof(uint64_t));
+    memset(msg, 'x', g_msg_size);
+
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1)
+    {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+
+    // 1. 阻塞式建连，统计建连耗时
+    uint64_t start = now_ns();
+    for (int i = 0; i < t->nconns; i++)
+    {
+        conns[i].start_ns = stamps + (size_t)i * g_pipeline;
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd == -1 || connect(fd, (struct sockaddr *)&g_server_addr, sizeof(g_server_addr)) == -1)
+        {
+            perror("connect");
+            if (fd != -1)
+            {
+                close(fd);
+            }
+            conns[i].fd = -1;
+            continue;
+        }
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+        set_nonblocking(fd);
+        conns[i].fd = fd;
+
+        // EPOLLOUT 边沿用于发送缓冲区满之后继续写
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        ev.data.ptr = &conns[i];
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+        t->connected++;
+    }
+    t->connect_seconds = (now_ns() - start) / 1e9;
+
+    // 2. 每条连接先灌满 pipeline 条消息
+    uint64_t now = now_ns();
+    for (int i = 0; i < t->nconns; i++)
+    {
+        if (conns[i].fd == -1)
+        {
+            continue;
+        }
+        for (int k = 0; k < g_pipeline; k++)
+        {
+            conn_enqueue(&conns[i], now);
+        }
+        if (conn_flush(&conns[i], msg) == -1)
+        {
+            conn_drop(&conns[i]);
+        }
+    }
+
+    // 3. 预热期间的样本不计入统计，之后在规定时间内持续压测
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t measure_from = now_ns() + (uint64_t)g_warmup * 1000000000ull;
+    uint64_t deadline = measure_from + (uint64_t)g_seconds * 1000000000ull;
+    while ((now = now_ns()) < deadline)
+    {
+        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, 100);
+        bool measuring = now >= measure_from;
+        for (int i = 0; i < nfds; i++)
+        {
+            bench_conn *c = (bench_conn *)events[i].data.ptr;
+            if (c->fd == -1)
+            {
+                continue;
+            }
+            // ET模式循环读到EAGAIN
+            while (true)
+            {
+                ssize_t n = read(c->fd, buf, buf_size);
+                if (n > 0)
+                {
+                    if (measuring)
+                    {
+                        t->bytes += n;
+                    }
+                    c->received += n;
+                    // 一次read可能跨越多条消息的边界
+                    while (c->received >= g_msg_size && c->ts_count > 0)
+                    {
+                        c->received -= g_msg_size;
+                        uint64_t done = now_ns();
+                        if (measuring)
+                        {
+                            t->messages++;
+                            hist_record(&t->hist, done - c->start_ns[c->ts_head]);
+                        }
+                        c->ts_head = (c->ts_head + 1) % g_pipeline;
+                        c->ts_count--;
+                        conn_enqueue(c, done);
+                    }
+                }
+                else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                {
+                    break;
+                }
+                else if (n == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                else
+                {
+                    conn_drop(c);
+                    break;
+                }
+            }
+            if (c->fd != -1 && conn_flush(c, msg) == -1)
+            {
+                conn_drop(c);
+            }
+        }
+    }
+
+    for (int i = 0; i < t->nconns; i++)
+    {
+        if (conns[i].fd != -1)
+        {
+            close(conns[i].fd);
+        }
+    }
+    close(epoll_fd);
+    free(stamps);
+    free(conns);
+    free(buf);
+    free(msg);
+    return NULL;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-t threads] [-c conns_per_thread] [-s msg_size] [-p pipeline]\n"
+            "          [-d seconds] [-w warmup_seconds] <ip> <port>\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    int nthreads = 4;
+    int nconns = 64;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:c:s:p:d:w:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'c':
+            nconns = atoi(optarg);
+            break;
+        case 's':
+            g_msg_size = (size_t)atol(optarg);
+            break;
+        case 'p':
+            g_pipeline = atoi(optarg);
+            break;
+        case 'd':
+            g_seconds = atoi(optarg);
+            break;
+        case 'w':
+            g_warmup = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (argc - optind != 2 || nthreads < 1 || nthreads > MAX_THREADS || nconns < 1 ||
+        g_msg_size == 0 || g_pipeline < 1 || g_seconds < 1 || g_warmup < 0)
+    {
+        usage(argv[0]);
+    }
+
+    memset(&g_server_addr, 0, sizeof(g_server_addr));
+    g_server_addr.sin_family = AF_INET;
+    g_server_addr.sin_port = htons(atoi(argv[optind + 1]));
+    if (inet_pton(AF_INET, argv[optind], &g_server_addr.sin_addr) != 1)
+    {
+        fprintf(stderr, "invalid ip: %s\n", argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    // 直方图较大，线程结构放在堆上
+    bench_thread *threads = calloc(nthreads, sizeof(bench_thread));
+    for (int i = 0; i < nthreads; i++)
+    {
+        threads[i].nconns = nconns;
+        if (pthread_create(&threads[i].thread_id, NULL, bench_worker, &threads[i]) != 0)
+        {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    unsigned long long messages = 0, bytes = 0;
+    int connected = 0;
+    double connect_seconds = 0;
+    histogram *hist = calloc(1, sizeof(histogram));
+    for (int i = 0; i < nthreads; i++)
+    {
+        pthread_join(threads[i].thread_id, NULL);
+        messages += threads[i].messages;
+        bytes += threads[i].bytes;
+        connected += threads[i].connected;
+        hist_merge(hist, &threads[i].hist);
+        if (threads[i].connect_seconds > connect_seconds)
+        {
+            connect_seconds = threads[i].connect_seconds;
+        }
+    }
+
+    printf("threads=%d conns=%d msg_size=%zu pipeline=%d duration=%ds\n",
+           nthreads, connected, g_msg_size, g_pipeline, g_seconds);
+    printf("connect rate : %.0f conn/s\n", connect_seconds > 0 ? connected / connect_seconds : 0.0);
+    printf("echo rate    : %.0f msg/s\n", (double)messages / g_seconds);
+    printf("bandwidth    : %.2f MiB/s\n", (double)bytes / g_seconds / (1024 * 1024));
+    printf("latency (us) : avg %.1f  p50 %.1f  p90 %.1f  p99 %.1f  p999 %.1f  max %.1f\n",
+           hist->total ? hist->sum / hist->total / 1e3 : 0.0,
+           hist_percentile(hist, 0.50) / 1e3,
+           hist_percentile(hist, 0.90) / 1e3,
+           hist_percentile(hist, 0.99) / 1e3,
+           hist_percentile(hist, 0.999) / 1e3,
+           hist->max / 1e3);
+
+    free(hist);
+    free(threads);
+    return 0;
+}
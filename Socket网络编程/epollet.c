@@ -1,4 +1,9 @@
+#define _GNU_SOURCE // splice
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/errqueue.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <stdio.h>
@@ -7,11 +12,434 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <sys/epoll.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
 
 #define MAX_EVENTS 1024
-#define BUFFER_SIZE 1024
+#define MAX_WORKERS 64
+#define RING_SIZE 65536   // 每个环形缓冲区的容量，必须是2的幂
+#define POOL_SLAB_OBJS 64 // 内存池每次向系统申请的对象个数
+#define PIPE_SIZE 65536   // splice 模式下每个连接的管道容量
+#define PIPE_CACHE 64     // 每个worker缓存的空闲管道数
+#define ZEROCOPY_MIN 16384 // 小于该长度的发送用普通拷贝，零拷贝的页锁定和通知开销不划算
+#define ZC_MAX_INFLIGHT 64 // 每个连接最多未完成的 MSG_ZEROCOPY 发送次数
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+// 响应发送方式
+typedef enum
+{
+    MODE_COPY,     // readv/writev，数据经过用户态环形缓冲区
+    MODE_SPLICE,   // socket -> pipe -> socket，回显数据不进入用户态
+    MODE_ZEROCOPY, // 环形缓冲区 + MSG_ZEROCOPY，大块发送时内核直接引用用户页
+    MODE_SENDFILE, // 每收到一行请求就用 sendfile 回一份文件内容
+} send_mode;
+
+static send_mode g_mode = MODE_COPY;
+static uint64_t g_idle_ticks; // 空闲超时（时间轮格数），0 表示不淘汰空闲连接
+static int g_file_fd = -1; // sendfile 模式的文件，所有worker只读共享
+static off_t g_file_size;
+
+// ---------------------------------------------------------------------------
+// 定长对象内存池（slab + 空闲链表）
+// 每个worker一个实例，只在本线程使用，不需要加锁
+// ---------------------------------------------------------------------------
+typedef struct pool_node
+{
+    struct pool_node *next;
+} pool_node;
+
+typedef struct
+{
+    size_t obj_size;
+    pool_node *free_list;
+    void **slabs; // 记录所有slab，销毁时统一释放
+    size_t nslabs;
+    size_t slab_cap;
+} pool_t;
+
+static void pool_init(pool_t *p, size_t obj_size)
+{
+    // 对象至少要能放下一个空闲链表指针，并按指针大小对齐
+    if (obj_size < sizeof(pool_node))
+    {
+        obj_size = sizeof(pool_node);
+    }
+    p->obj_size = (obj_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    p->free_list = NULL;
+    p->slabs = NULL;
+    p->nslabs = 0;
+    p->slab_cap = 0;
+}
+
+// 申请一整块slab并切分成对象挂到空闲链表上
+static bool pool_grow(pool_t *p)
+{
+    if (p->nslabs == p->slab_cap)
+    {
+        size_t cap = p->slab_cap ? p->slab_cap * 2 : 8;
+        void **slabs = realloc(p->slabs, cap * sizeof(void *));
+        if (slabs == NULL)
+        {
+            return false;
+        }
+        p->slabs = slabs;
+        p->slab_cap = cap;
+    }
+
+    char *slab = malloc(p->obj_size * POOL_SLAB_OBJS);
+    if (slab == NULL)
+    {
+        return false;
+    }
+    p->slabs[p->nslabs++] = slab;
+    for (int i = POOL_SLAB_OBJS - 1; i >= 0; i--)
+    {
+        pool_node *node = (pool_node *)(slab + i * p->obj_size);
+        node->next = p->free_list;
+        p->free_list = node;
+    }
+    return true;
+}
+
+static void *pool_alloc(pool_t *p)
+{
+    if (p->free_list == NULL && !pool_grow(p))
+    {
+        return NULL;
+    }
+    pool_node *node = p->free_list;
+    p->free_list = node->next;
+    return node;
+}
+
+static void pool_free(pool_t *p, void *obj)
+{
+    pool_node *node = (pool_node *)obj;
+    node->next = p->free_list;
+    p->free_list = node;
+}
+
+static void pool_destroy(pool_t *p)
+{
+    for (size_t i = 0; i < p->nslabs; i++)
+    {
+        free(p->slabs[i]);
+    }
+    free(p->slabs);
+    p->slabs = NULL;
+    p->nslabs = p->slab_cap = 0;
+    p->free_list = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// 环形缓冲区：head/tail 自由递增，用 & (RING_SIZE - 1) 取下标
+// 存储块从内存池按需借出，缓冲区清空后立即归还，空闲连接不占缓冲内存
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    char *data;
+    uint32_t head; // 读位置
+    uint32_t tail; // 写位置
+} ring_t;
+
+static inline uint32_t ring_used(const ring_t *r) { return r->tail - r->head; }
+static inline uint32_t ring_free(const ring_t *r) { return RING_SIZE - ring_used(r); }
+
+static bool ring_acquire(ring_t *r, pool_t *pool)
+{
+    if (r->data == NULL)
+    {
+        r->data = pool_alloc(pool);
+        r->head = r->tail = 0;
+    }
+    return r->data != NULL;
+}
+
+static void ring_release(ring_t *r, pool_t *pool)
+{
+    if (r->data != NULL)
+    {
+        pool_free(pool, r->data);
+        r->data = NULL;
+    }
+    r->head = r->tail = 0;
+}
+
+// 把空闲区域（可能绕回开头）描述成最多两段iovec，供readv一次读满
+static int ring_write_iov(ring_t *r, struct iovec iov[2])
+{
+    uint32_t len = ring_free(r);
+    uint32_t pos = r->tail & (RING_SIZE - 1);
+    uint32_t first = RING_SIZE - pos < len ? RING_SIZE - pos : len;
+    iov[0].iov_base = r->data + pos;
+    iov[0].iov_len = first;
+    iov[1].iov_base = r->data;
+    iov[1].iov_len = len - first;
+    return len - first ? 2 : 1;
+}
+
+// 把已有数据（跳过开头skip字节）描述成最多两段iovec，供writev一次写出
+static int ring_read_iov(ring_t *r, uint32_t skip, struct iovec iov[2])
+{
+    uint32_t len = ring_used(r) - skip;
+    uint32_t pos = (r->head + skip) & (RING_SIZE - 1);
+    uint32_t first = RING_SIZE - pos < len ? RING_SIZE - pos : len;
+    iov[0].iov_base = r->data + pos;
+    iov[0].iov_len = first;
+    iov[1].iov_base = r->data;
+    iov[1].iov_len = len - first;
+    return len - first ? 2 : 1;
+}
+
+// 从src搬运最多len字节到dst
+static uint32_t ring_move(ring_t *dst, ring_t *src, uint32_t len)
+{
+    if (len > ring_used(src))
+    {
+        len = ring_used(src);
+    }
+    if (len > ring_free(dst))
+    {
+        len = ring_free(dst);
+    }
+    for (uint32_t done = 0; done < len;)
+    {
+        uint32_t spos = src->head & (RING_SIZE - 1);
+        uint32_t dpos = dst->tail & (RING_SIZE - 1);
+        uint32_t chunk = len - done;
+        if (chunk > RING_SIZE - spos)
+        {
+            chunk = RING_SIZE - spos;
+        }
+        if (chunk > RING_SIZE - dpos)
+        {
+            chunk = RING_SIZE - dpos;
+        }
+        memcpy(dst->data + dpos, src->data + spos, chunk);
+        src->head += chunk;
+        dst->tail += chunk;
+        done += chunk;
+    }
+    return len;
+}
+
+// ---------------------------------------------------------------------------
+// 分层时间轮：4层、每层64个槽，一格 TW_TICK_MS 毫秒
+// 第0层覆盖 64 格，第1层 64^2 格……到期时间远的定时器挂在高层，
+// 低层转完一圈时把高层对应槽里的定时器"降级"重新挂到低层（cascade）
+// 定时器节点嵌在连接里，挂入/摘除都是双向链表的 O(1) 操作，不需要任何系统调用
+// ---------------------------------------------------------------------------
+#define TW_TICK_MS 100
+#define TW_BITS 6
+#define TW_SIZE (1 << TW_BITS)
+#define TW_MASK (TW_SIZE - 1)
+#define TW_LEVELS 4
+
+typedef struct tw_node
+{
+    struct tw_node *prev;
+    struct tw_node *next; // NULL 表示未挂在时间轮上
+    uint64_t expires;     // 到期的格数（绝对值）
+} tw_node;
+
+typedef struct
+{
+    uint64_t now;         // 当前格
+    uint64_t now_ms;      // 当前格开始的时间
+    size_t count;         // 挂着的定时器个数
+    tw_node slots[TW_LEVELS][TW_SIZE]; // 每个槽一个带哨兵的环形链表
+} timer_wheel;
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void tw_init(timer_wheel *tw)
+{
+    tw->now = 0;
+    tw->now_ms = monotonic_ms();
+    tw->count = 0;
+    for (int level = 0; level < TW_LEVELS; level++)
+    {
+        for (int i = 0; i < TW_SIZE; i++)
+        {
+            tw->slots[level][i].prev = tw->slots[level][i].next = &tw->slots[level][i];
+        }
+    }
+}
+
+static inline bool tw_pending(const tw_node *node) { return node->next != NULL; }
+
+// 按距离现在的格数选层：差值落在第L层的范围内，就用到期时间的第L段6位作槽号
+static void tw_link(timer_wheel *tw, tw_node *node)
+{
+    uint64_t delta = node->expires > tw->now ? node->expires - tw->now : 0;
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= ((uint64_t)1 << (TW_BITS * (level + 1))))
+    {
+        level++;
+    }
+    uint64_t max_delta = ((uint64_t)1 << (TW_BITS * TW_LEVELS)) - 1;
+    if (delta > max_delta)
+    {
+        node->expires = tw->now + max_delta; // 超出时间轮范围的截断到最远一格
+    }
+    if (delta == 0)
+    {
+        node->expires = tw->now + 1; // 已到期的挂到下一格，下一次推进时立即触发
+    }
+    tw_node *head = &tw->slots[level][(node->expires >> (TW_BITS * level)) & TW_MASK];
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+// 挂入定时器，expires 为绝对格数
+static void tw_add(timer_wheel *tw, tw_node *node, uint64_t expires)
+{
+    node->expires = expires;
+    tw_link(tw, node);
+    tw->count++;
+}
+
+// 摘除定时器；未挂上的节点调用也安全
+static void tw_del(timer_wheel *tw, tw_node *node)
+{
+    if (!tw_pending(node))
+    {
+        return;
+    }
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node->next = NULL;
+    tw->count--;
+}
+
+// 把第 level 层当前槽里的定时器全部按新的剩余时间重新挂入（会落到更低的层）
+static void tw_cascade(timer_wheel *tw, int level)
+{
+    tw_node *head = &tw->slots[level][(tw->now >> (TW_BITS * level)) & TW_MASK];
+    tw_node *node = head->next;
+    head->prev = head->next = head;
+    while (node != head)
+    {
+        tw_node *next = node->next;
+        tw_link(tw, node);
+        node = next;
+    }
+}
+
+// 推进到当前时间，依次回调所有到期的定时器
+// 回调里可以释放节点所在的对象，也可以重新 tw_add
+static void tw_advance(timer_wheel *tw, void (*expire)(void *ctx, tw_node *node), void *ctx)
+{
+    uint64_t now_ms = monotonic_ms();
+    while (now_ms - tw->now_ms >= TW_TICK_MS)
+    {
+        tw->now_ms += TW_TICK_MS;
+        tw->now++;
+        if (tw->count == 0)
+        {
+            // 没有定时器就直接跳到当前时间
+            uint64_t ticks = (now_ms - tw->now_ms) / TW_TICK_MS;
+            tw->now += ticks;
+            tw->now_ms += ticks * TW_TICK_MS;
+            continue;
+        }
+
+        // 低层转完一圈（槽号回到0）时从上一层降级
+        for (int level = 1; level < TW_LEVELS && ((tw->now >> (TW_BITS * (level - 1))) & TW_MASK) == 0; level++)
+        {
+            tw_cascade(tw, level);
+        }
+
+        tw_node *head = &tw->slots[0][tw->now & TW_MASK];
+        while (head->next != head)
+        {
+            tw_node *node = head->next;
+            tw_del(tw, node);
+            expire(ctx, node);
+        }
+    }
+}
+
+// 计算 epoll_wait 的超时：到第0层下一个非空槽（或下一次降级）为止；没有定时器时永久等待
+static int tw_next_timeout(const timer_wheel *tw)
+{
+    if (tw->count == 0)
+    {
+        return -1;
+    }
+    uint64_t ticks = 1;
+    for (; ticks < TW_SIZE; ticks++)
+    {
+        uint64_t t = tw->now + ticks;
+        const tw_node *head = &tw->slots[0][t & TW_MASK];
+        if ((t & TW_MASK) == 0 || head->next != head)
+        {
+            break;
+        }
+    }
+    int64_t timeout = (int64_t)(tw->now_ms + ticks * TW_TICK_MS) - (int64_t)monotonic_ms();
+    return timeout > 0 ? (int)timeout : 0;
+}
+
+// ---------------------------------------------------------------------------
+// 连接上下文：通过 epoll_event.data.ptr 找到，替代按fd查表
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    tw_node timer;        // 空闲淘汰定时器
+    uint64_t last_active; // 最近一次有读写事件的时间轮格数
+    int fd;
+    ring_t in;         // 已读入、尚未处理的数据
+    ring_t out;        // 待发送的数据（部分写剩下的部分在这里排队）
+    bool read_paused;  // 输出缓冲区满导致停止读取，等可写后需要主动续读
+    bool closing;      // 还有零拷贝发送未完成，等通知到齐再真正关闭
+
+    // splice 模式
+    int pipe_fds[2];
+    uint32_t pipe_len; // 管道里尚未发出的字节
+
+    // sendfile 模式
+    uint32_t file_pending; // 还需要回复的文件份数
+    off_t file_off;        // 当前这一份已发送到的位置
+
+    // MSG_ZEROCOPY 模式：out.head 只在内核通知页面用完后才前移
+    uint32_t zc_sent;                 // out.head 之后已交给内核、尚未完成的字节
+    uint32_t zc_seq_next;             // 下一次零拷贝发送的序号（与内核计数一致）
+    uint32_t zc_seq_done;             // 已完成的序号
+    uint32_t zc_end[ZC_MAX_INFLIGHT]; // 每次发送完成后 out.head 应前移到的位置
+} conn_t;
+
+// 每个worker独占一个事件循环：自己的epoll实例 + 自己的监听socket
+typedef struct
+{
+    int id;
+    int port;
+    int listen_fd;
+    int epoll_fd;
+    pthread_t thread_id;
+    pool_t conn_pool;   // conn_t 对象池
+    pool_t buffer_pool; // RING_SIZE 大小的缓冲块池
+    int pipe_cache[PIPE_CACHE][2]; // 空闲管道，splice 模式下复用，避免每个连接都 pipe2/close
+    int npipes;
+    timer_wheel wheel; // 本worker所有连接的空闲定时器
+} worker_t;
 
 // 设置文件描述符为非阻塞模式
 static void set_nonblocking(int fd)
@@ -29,31 +457,30 @@ static void set_nonblocking(int fd)
     }
 }
 
-int main(int argc, char *argv[])
+// 创建监听socket；多worker时开启SO_REUSEPORT，由内核按四元组哈希把新连接分给各个监听socket
+static int create_listener(int port, bool reuse_port)
 {
-    if (argc != 2)
-    {
-        fprintf(stderr, "Usage: %s <port>\n", argv[0]);
-        exit(EXIT_FAILURE);
-    }
-
-    int port = atoi(argv[1]);
-
     // 1. 创建监听socket
     int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (listen_fd == -1)
     {
         perror("socket");
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
     // 设置SO_REUSEADDR选项
     int opt = 1;
     if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
     {
-        perror("setsockopt");
+        perror("setsockopt SO_REUSEADDR");
         close(listen_fd);
-        exit(EXIT_FAILURE);
+        return -1;
+    }
+    if (reuse_port && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1)
+    {
+        perror("setsockopt SO_REUSEPORT");
+        close(listen_fd);
+        return -1;
     }
 
     // 2. 绑定地址
@@ -67,7 +494,7 @@ int main(int argc, char *argv[])
     {
         perror("bind");
         close(listen_fd);
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
     // 3. 开始监听
@@ -75,206 +502,787 @@ int main(int argc, char *argv[])
     {
         perror("listen");
         close(listen_fd);
-        exit(EXIT_FAILURE);
+        return -1;
     }
 
-    printf("Server listening on port %d...\n", port);
+    // ET模式下accept要循环到EAGAIN，监听socket也必须是非阻塞的
+    set_nonblocking(listen_fd);
+    return listen_fd;
+}
+
+// 初始化一个worker：监听socket + epoll实例，监听socket以ET模式加入epoll
+static int worker_init(worker_t *w, bool reuse_port)
+{
+    pool_init(&w->conn_pool, sizeof(conn_t));
+    pool_init(&w->buffer_pool, RING_SIZE);
+    w->npipes = 0;
+    tw_init(&w->wheel);
+
+    w->listen_fd = create_listener(w->port, reuse_port);
+    if (w->listen_fd == -1)
+    {
+        return -1;
+    }
 
     // 4. 创建epoll实例
-    int epoll_fd = epoll_create1(0);
-    if (epoll_fd == -1)
+    w->epoll_fd = epoll_create1(0);
+    if (w->epoll_fd == -1)
     {
         perror("epoll_create1");
-        close(listen_fd);
-        exit(EXIT_FAILURE);
+        close(w->listen_fd);
+        return -1;
     }
 
-    // 5. 添加监听socket到epoll，使用ET模式
+    // 5. 添加监听socket到epoll，使用ET模式；data.ptr为NULL表示监听socket
     struct epoll_event event;
     event.events = EPOLLIN | EPOLLET; // 边缘触发模式
-    event.data.fd = listen_fd;
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == -1)
+    event.data.ptr = NULL;
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->listen_fd, &event) == -1)
     {
         perror("epoll_ctl EPOLL_CTL_ADD");
-        close(listen_fd);
-        close(epoll_fd);
-        exit(EXIT_FAILURE);
+        close(w->listen_fd);
+        close(w->epoll_fd);
+        return -1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 管道缓存（splice 模式）
+// ---------------------------------------------------------------------------
+static bool pipe_acquire(worker_t *w, conn_t *c)
+{
+    if (c->pipe_fds[0] != -1)
+    {
+        return true;
+    }
+    if (w->npipes > 0)
+    {
+        w->npipes--;
+        c->pipe_fds[0] = w->pipe_cache[w->npipes][0];
+        c->pipe_fds[1] = w->pipe_cache[w->npipes][1];
+        return true;
+    }
+    if (pipe2(c->pipe_fds, O_NONBLOCK) == -1)
+    {
+        perror("pipe2");
+        c->pipe_fds[0] = c->pipe_fds[1] = -1;
+        return false;
+    }
+    fcntl(c->pipe_fds[1], F_SETPIPE_SZ, PIPE_SIZE);
+    return true;
+}
+
+// 管道为空时放回缓存；里面还有数据（连接异常关闭）则直接关掉
+static void pipe_release(worker_t *w, conn_t *c)
+{
+    if (c->pipe_fds[0] == -1)
+    {
+        return;
+    }
+    if (c->pipe_len == 0 && w->npipes < PIPE_CACHE)
+    {
+        w->pipe_cache[w->npipes][0] = c->pipe_fds[0];
+        w->pipe_cache[w->npipes][1] = c->pipe_fds[1];
+        w->npipes++;
+    }
+    else
+    {
+        close(c->pipe_fds[0]);
+        close(c->pipe_fds[1]);
+    }
+    c->pipe_fds[0] = c->pipe_fds[1] = -1;
+    c->pipe_len = 0;
+}
+
+// 释放连接占用的所有资源；close会自动把fd从epoll中移除
+static void conn_destroy(worker_t *w, conn_t *c)
+{
+    tw_del(&w->wheel, &c->timer);
+    close(c->fd);
+    ring_release(&c->in, &w->buffer_pool);
+    ring_release(&c->out, &w->buffer_pool);
+    pipe_release(w, c);
+    pool_free(&w->conn_pool, c);
+}
+
+// 关闭连接。零拷贝发送未完成时内核还在引用输出缓冲区的页面，
+// 此时归还缓冲块会让后续连接的数据被发给对端，所以先只关读端，等完成通知到齐再释放
+static void conn_close(worker_t *w, conn_t *c)
+{
+    if (c->zc_seq_next != c->zc_seq_done)
+    {
+        c->closing = true;
+        shutdown(c->fd, SHUT_RD);
+        // 通知最多再等一个空闲周期，超时由定时器强制释放
+        if (g_idle_ticks > 0)
+        {
+            tw_del(&w->wheel, &c->timer);
+            tw_add(&w->wheel, &c->timer, w->wheel.now + g_idle_ticks);
+        }
+        return;
+    }
+    conn_destroy(w, c);
+}
+
+// 业务处理：回显，即把输入缓冲区的数据转入输出缓冲区
+// 输出为空时直接交换两个缓冲块，省掉一次memcpy
+// sendfile 模式下每个换行算一个请求，请求内容本身丢弃
+static void conn_process(worker_t *w, conn_t *c)
+{
+    if (ring_used(&c->in) == 0)
+    {
+        return;
+    }
+    if (g_mode == MODE_SENDFILE)
+    {
+        for (uint32_t i = c->in.head; i != c->in.tail; i++)
+        {
+            if (c->in.data[i & (RING_SIZE - 1)] == '\n')
+            {
+                c->file_pending++;
+            }
+        }
+        c->in.head = c->in.tail;
+    }
+    else if (c->out.data == NULL || ring_used(&c->out) == 0)
+    {
+        ring_t tmp = c->out;
+        c->out = c->in;
+        c->in = tmp;
+    }
+    else
+    {
+        ring_move(&c->out, &c->in, ring_used(&c->in));
+    }
+    if (c->in.data != NULL && ring_used(&c->in) == 0)
+    {
+        ring_release(&c->in, &w->buffer_pool);
+    }
+}
+
+// 对端重置/已关闭属于正常断开，不打印错误
+static int send_error(const char *what)
+{
+    if (errno != EPIPE && errno != ECONNRESET)
+    {
+        perror(what);
+    }
+    return -1;
+}
+
+// sendfile 模式：文件内容由内核直接从页缓存发往socket，不经过用户态
+// 每个连接用自己的 file_off，多个worker共享同一个fd也不会互相影响文件偏移
+static int conn_flush_file(conn_t *c)
+{
+    while (c->file_pending > 0)
+    {
+        ssize_t sent = sendfile(c->fd, g_file_fd, &c->file_off, g_file_size - c->file_off);
+        if (sent >= 0)
+        {
+            if (c->file_off >= g_file_size || sent == 0)
+            {
+                c->file_pending--;
+                c->file_off = 0;
+            }
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return 0;
+        }
+        else if (errno != EINTR)
+        {
+            return send_error("sendfile");
+        }
     }
+    return 0;
+}
+
+// splice 模式：把管道里的数据搬到socket，页面只在内核里转手
+static int conn_flush_splice(worker_t *w, conn_t *c)
+{
+    while (c->pipe_len > 0)
+    {
+        ssize_t sent = splice(c->pipe_fds[0], NULL, c->fd, NULL, c->pipe_len,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (sent > 0)
+        {
+            c->pipe_len -= sent;
+        }
+        else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 0;
+        }
+        else if (sent == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return send_error("splice out");
+        }
+    }
+    pipe_release(w, c);
+    return 0;
+}
+
+// 尽量发送输出缓冲区；返回-1表示连接出错需要关闭
+// 遇到EAGAIN时数据留在环形缓冲区里排队，等EPOLLOUT再继续，不需要额外申请内存
+static int conn_flush(worker_t *w, conn_t *c)
+{
+    if (g_mode == MODE_SPLICE)
+    {
+        return conn_flush_splice(w, c);
+    }
+    if (g_mode == MODE_SENDFILE)
+    {
+        return conn_flush_file(c);
+    }
+
+    while (c->out.data != NULL && ring_used(&c->out) > c->zc_sent)
+    {
+        struct iovec iov[2];
+        int iovcnt = ring_read_iov(&c->out, c->zc_sent, iov);
+        uint32_t len = ring_used(&c->out) - c->zc_sent;
+
+        // 已有零拷贝在途时后面的数据也走零拷贝，保证 out.head 按发送顺序前移
+        bool zerocopy = g_mode == MODE_ZEROCOPY && (c->zc_sent > 0 || len >= ZEROCOPY_MIN);
+        if (zerocopy && c->zc_seq_next - c->zc_seq_done == ZC_MAX_INFLIGHT)
+        {
+            return 0; // 在途发送太多，等完成通知
+        }
+
+        ssize_t sent;
+        if (zerocopy)
+        {
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iovcnt;
+            sent = sendmsg(c->fd, &msg, MSG_ZEROCOPY);
+            if (sent == -1 && errno == ENOBUFS)
+            {
+                // 超出 optmem 限制，这次退回普通拷贝发送
+                zerocopy = false;
+                sent = writev(c->fd, iov, iovcnt);
+            }
+        }
+        else
+        {
+            sent = writev(c->fd, iov, iovcnt);
+        }
+
+        if (sent > 0)
+        {
+            if (zerocopy)
+            {
+                // 页面仍被内核引用，记录本次发送的结束位置，收到通知后再回收
+                c->zc_sent += sent;
+                c->zc_end[c->zc_seq_next % ZC_MAX_INFLIGHT] = c->out.head + c->zc_sent;
+                c->zc_seq_next++;
+            }
+            else if (c->zc_sent > 0)
+            {
+                // 排在零拷贝数据后面的拷贝发送：并入最后一次零拷贝的回收位置
+                c->zc_sent += sent;
+                c->zc_end[(c->zc_seq_next - 1) % ZC_MAX_INFLIGHT] += sent;
+            }
+            else
+            {
+                c->out.head += sent;
+            }
+        }
+        else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return 0;
+        }
+        else if (sent == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return send_error("writev");
+        }
+    }
+    if (c->out.data != NULL && ring_used(&c->out) == 0)
+    {
+        ring_release(&c->out, &w->buffer_pool);
+    }
+    return 0;
+}
+
+// 处理输入并发送，直到输入处理完或输出再也腾不出空间
+// 输出满时输入会剩下一部分，下次可写（或零拷贝完成）时必须再从这里继续，否则这部分数据会滞留
+static int conn_pump(worker_t *w, conn_t *c)
+{
+    while (true)
+    {
+        uint32_t before = ring_used(&c->in);
+        conn_process(w, c);
+        if (conn_flush(w, c) == -1)
+        {
+            return -1;
+        }
+        if (ring_used(&c->in) == 0 || ring_used(&c->in) == before)
+        {
+            return 0;
+        }
+    }
+}
+
+// 读取 MSG_ZEROCOPY 完成通知（错误队列），前移 out.head 回收已完成的区间
+// 注意：回环和不支持分散/聚集的网卡上内核会退化为拷贝（SO_EE_CODE_ZEROCOPY_COPIED），语义不变
+static void conn_reap_zerocopy(conn_t *c)
+{
+    while (true)
+    {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(c->fd, &msg, MSG_ERRQUEUE) == -1)
+        {
+            return; // EAGAIN：通知已取完
+        }
+
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+            {
+                continue;
+            }
+            struct sock_extended_err *serr = (struct sock_extended_err *)CMSG_DATA(cm);
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0)
+            {
+                continue;
+            }
+            // [ee_info, ee_data] 是一段连续完成的发送序号
+            for (; (int32_t)(serr->ee_data - c->zc_seq_done) >= 0; c->zc_seq_done++)
+            {
+                uint32_t end = c->zc_end[c->zc_seq_done % ZC_MAX_INFLIGHT];
+                c->zc_sent -= end - c->out.head;
+                c->out.head = end;
+            }
+        }
+    }
+}
+
+// ET模式必须循环读取直到EAGAIN；输出积压到上限时暂停读取（背压），可写后再续读
+// splice 模式：socket -> pipe，再立即 pipe -> socket
+// 返回-1表示连接已关闭
+static int conn_read_splice(worker_t *w, conn_t *c)
+{
+    c->read_paused = false;
+    while (true)
+    {
+        if (!pipe_acquire(w, c))
+        {
+            return -1;
+        }
+        uint32_t before = c->pipe_len;
+        ssize_t n = 0;
+        if (c->pipe_len < PIPE_SIZE)
+        {
+            n = splice(c->fd, NULL, c->pipe_fds[1], NULL, PIPE_SIZE - c->pipe_len,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        }
+        else
+        {
+            errno = EAGAIN;
+            n = -1;
+        }
+
+        if (n > 0)
+        {
+            c->pipe_len += n;
+            if (conn_flush_splice(w, c) == -1)
+            {
+                return -1;
+            }
+        }
+        else if (n == 0)
+        {
+            printf("[worker %d] Client closed connection\n", w->id);
+            return -1;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            // EAGAIN 既可能是socket读空，也可能是管道满；管道原本非空时无法区分
+            if (conn_flush_splice(w, c) == -1)
+            {
+                return -1;
+            }
+            if (c->pipe_len > 0)
+            {
+                // 对端不读，管道积压：等EPOLLOUT后续读
+                c->read_paused = true;
+                return 0;
+            }
+            if (before > 0)
+            {
+                continue; // 管道刚被清空，再确认一次socket是否真的读空了
+            }
+            return 0;
+        }
+        else
+        {
+            if (errno != ECONNRESET)
+            {
+                perror("splice in");
+            }
+            return -1;
+        }
+    }
+}
+
+// ET模式必须循环读取直到EAGAIN；输出积压到上限时暂停读取（背压），可写后再续读
+// 返回-1表示连接已关闭
+static int conn_read(worker_t *w, conn_t *c)
+{
+    if (g_mode == MODE_SPLICE)
+    {
+        return conn_read_splice(w, c);
+    }
+
+    c->read_paused = false;
+    while (true)
+    {
+        if (!ring_acquire(&c->in, &w->buffer_pool))
+        {
+            fprintf(stderr, "buffer pool exhausted\n");
+            return -1;
+        }
+        if (ring_free(&c->in) == 0)
+        {
+            // 输入满了：先处理并尝试发送，腾出空间
+            if (conn_pump(w, c) == -1)
+            {
+                return -1;
+            }
+            if (!ring_acquire(&c->in, &w->buffer_pool))
+            {
+                return -1;
+            }
+            if (ring_free(&c->in) == 0)
+            {
+                // 对端不读，输出也满了：socket里剩下的数据等EPOLLOUT后再读
+                c->read_paused = true;
+                return 0;
+            }
+        }
+
+        struct iovec iov[2];
+        int iovcnt = ring_write_iov(&c->in, iov);
+        ssize_t n = readv(c->fd, iov, iovcnt);
+        if (n > 0)
+        {
+            c->in.tail += n;
+        }
+        else if (n == 0)
+        {
+            // 对端关闭连接
+            printf("[worker %d] Client closed connection\n", w->id);
+            return -1;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            // 数据已读完，处理接收到的数据并回显
+            return conn_pump(w, c);
+        }
+        else
+        {
+            if (errno != ECONNRESET)
+            {
+                perror("read");
+            }
+            return -1;
+        }
+    }
+}
+
+// 6. 处理新连接：必须循环accept直到EAGAIN，因为ET模式只通知一次
+static void handle_accept(worker_t *w)
+{
+    while (true)
+    {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        int conn_fd = accept(w->listen_fd, (struct sockaddr *)&client_addr, &client_len);
+        if (conn_fd == -1)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                perror("accept");
+            }
+            // 已经accept完所有连接
+            return;
+        }
+
+        printf("[worker %d] New connection from %s:%d\n", w->id,
+               inet_ntoa(client_addr.sin_addr),
+               ntohs(client_addr.sin_port));
+
+        // 设置新连接为非阻塞模式
+        set_nonblocking(conn_fd);
+
+        conn_t *c = pool_alloc(&w->conn_pool);
+        if (c == NULL)
+        {
+            fprintf(stderr, "conn pool exhausted\n");
+            close(conn_fd);
+            continue;
+        }
+        memset(c, 0, sizeof(*c));
+        c->fd = conn_fd;
+        c->pipe_fds[0] = c->pipe_fds[1] = -1;
+        c->last_active = w->wheel.now;
+        if (g_idle_ticks > 0)
+        {
+            tw_add(&w->wheel, &c->timer, w->wheel.now + g_idle_ticks);
+        }
+        if (g_mode == MODE_ZEROCOPY)
+        {
+            int opt = 1;
+            if (setsockopt(conn_fd, SOL_SOCKET, SO_ZEROCOPY, &opt, sizeof(opt)) == -1)
+            {
+                perror("setsockopt SO_ZEROCOPY");
+            }
+        }
+
+        // ET模式下一次性注册读写事件：可写边沿只在发送缓冲区由满变空时触发一次，
+        // 不需要每次部分写都 EPOLL_CTL_MOD 切换事件
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+        event.data.ptr = c;
+        if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, conn_fd, &event) == -1)
+        {
+            perror("epoll_ctl EPOLL_CTL_ADD");
+            conn_close(w, c);
+        }
+    }
+}
+
+// 空闲定时器到期：定时器不随每次读写重新挂载，只记录 last_active；
+// 到期时若期间有过活动，就按剩余时间重新挂上，真正空闲满一个周期才关闭
+static void conn_on_timer(void *ctx, tw_node *node)
+{
+    worker_t *w = (worker_t *)ctx;
+    conn_t *c = (conn_t *)node; // timer 是 conn_t 的第一个成员
+    if (c->closing)
+    {
+        // 零拷贝通知迟迟不到，不再等待
+        conn_destroy(w, c);
+        return;
+    }
+    uint64_t deadline = c->last_active + g_idle_ticks;
+    if (deadline > w->wheel.now)
+    {
+        tw_add(&w->wheel, &c->timer, deadline);
+        return;
+    }
+    printf("[worker %d] Evicting idle connection fd %d\n", w->id, c->fd);
+    conn_close(w, c);
+}
+
+// 7. 处理客户端事件
+static void handle_conn(worker_t *w, conn_t *c, uint32_t events)
+{
+    c->last_active = w->wheel.now;
+
+    // 7.0 零拷贝模式下 EPOLLERR 也表示错误队列里有完成通知，先回收再判断是否真的出错
+    if (g_mode == MODE_ZEROCOPY && (events & EPOLLERR))
+    {
+        conn_reap_zerocopy(c);
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err == 0)
+        {
+            events = (events & ~EPOLLERR) | EPOLLOUT; // 回收出了空间，按可写继续发送
+        }
+    }
+    if (c->closing)
+    {
+        // 只等零拷贝通知，到齐后释放
+        if (c->zc_seq_next == c->zc_seq_done)
+        {
+            conn_destroy(w, c);
+        }
+        return;
+    }
+
+    // 7.1 出错或双向挂断直接关闭
+    if (events & (EPOLLERR | EPOLLHUP))
+    {
+        printf("[worker %d] Client disconnected\n", w->id);
+        conn_close(w, c);
+        return;
+    }
+
+    // 7.2 可写：继续发送排队的数据；若之前因背压暂停读取，腾出空间后续读
+    if (events & EPOLLOUT)
+    {
+        if (conn_pump(w, c) == -1)
+        {
+            conn_close(w, c);
+            return;
+        }
+        if (c->read_paused && conn_read(w, c) == -1)
+        {
+            conn_close(w, c);
+            return;
+        }
+    }
+
+    // 7.3 可读（EPOLLRDHUP时也要先读完剩余数据，read返回0后再关闭）
+    if (events & (EPOLLIN | EPOLLRDHUP))
+    {
+        if (conn_read(w, c) == -1)
+        {
+            conn_close(w, c);
+        }
+    }
+}
+
+// 单个worker的事件循环，worker之间不共享任何连接状态，因此无需加锁
+static void *event_loop(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
 
     // 事件循环
     struct epoll_event events[MAX_EVENTS];
     while (true)
     {
-        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        // 超时由时间轮决定：没有定时器时永久阻塞，否则最多睡到下一个可能到期的格
+        int nfds = epoll_wait(w->epoll_fd, events, MAX_EVENTS, tw_next_timeout(&w->wheel));
         if (nfds == -1)
         {
+            if (errno == EINTR)
+            {
+                continue;
+            }
             perror("epoll_wait");
             break;
         }
 
         for (int i = 0; i < nfds; i++)
         {
-            // 6. 处理新连接
-            if (events[i].data.fd == listen_fd)
+            if (events[i].data.ptr == NULL)
             {
-                struct sockaddr_in client_addr;
-                socklen_t client_len = sizeof(client_addr);
-                int conn_fd;
-
-                // 必须循环accept直到EAGAIN，因为ET模式只通知一次
-                while ((conn_fd = accept(listen_fd,
-                                         (struct sockaddr *)&client_addr,
-                                         &client_len)) > 0)
-                {
-                    printf("New connection from %s:%d\n",
-                           inet_ntoa(client_addr.sin_addr),
-                           ntohs(client_addr.sin_port));
-
-                    // 设置新连接为非阻塞模式
-                    set_nonblocking(conn_fd);
-
-                    // 添加新连接到epoll，使用ET模式
-                    event.events = EPOLLIN | EPOLLET | EPOLLRDHUP;
-                    event.data.fd = conn_fd;
-                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn_fd, &event) == -1)
-                    {
-                        perror("epoll_ctl EPOLL_CTL_ADD");
-                        close(conn_fd);
-                        continue;
-                    }
-                }
-
-                if (conn_fd == -1)
-                {
-                    if (errno != EAGAIN && errno != EWOULDBLOCK)
-                    {
-                        perror("accept");
-                    }
-                    // 已经accept完所有连接
-                }
+                handle_accept(w);
             }
-            // 7. 处理客户端数据
             else
             {
-                // 7.1 处理连接关闭事件
-                if (events[i].events & (EPOLLRDHUP | EPOLLHUP))
-                {
-                    printf("Client disconnected\n");
-                    close(events[i].data.fd);
-                    continue;
-                }
-
-                // 7.2 处理可读事件
-                if (events[i].events & EPOLLIN)
-                {
-                    int fd = events[i].data.fd;
-                    char buffer[BUFFER_SIZE];
-                    ssize_t total_read = 0;
-
-                    // ET模式必须循环读取直到EAGAIN
-                    while (true)
-                    {
-                        ssize_t n = read(fd, buffer + total_read, sizeof(buffer) - total_read);
-                        if (n > 0)
-                        {
-                            total_read += n;
-                            // 检查是否已经读满缓冲区
-                            if (total_read == sizeof(buffer))
-                            {
-                                break;
-                            }
-                        }
-                        else if (n == 0)
-                        {
-                            // 对端关闭连接
-                            printf("Client closed connection\n");
-                            close(fd);
-                            break;
-                        }
-                        else
-                        {
-                            if (errno == EAGAIN || errno == EWOULDBLOCK)
-                            {
-                                // 数据已读完，可以处理接收到的数据
-                                if (total_read > 0)
-                                {
-                                    printf("Received %zd bytes: %.*s\n",
-                                           total_read, (int)total_read, buffer);
-
-                                    // Echo回数据
-                                    ssize_t total_sent = 0;
-                                    while (total_sent < total_read)
-                                    {
-                                        ssize_t sent = write(fd, buffer + total_sent,
-                                                             total_read - total_sent);
-                                        if (sent == -1)
-                                        {
-                                            if (errno == EAGAIN || errno == EWOULDBLOCK)
-                                            {
-                                                // 输出缓冲区已满，需要等待可写事件
-                                                event.events = EPOLLOUT | EPOLLET | EPOLLRDHUP;
-                                                event.data.fd = fd;
-                                                if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) == -1)
-                                                {
-                                                    perror("epoll_ctl EPOLL_CTL_MOD");
-                                                    close(fd);
-                                                }
-                                                break;
-                                            }
-                                            else
-                                            {
-                                                perror("write");
-                                                close(fd);
-                                                break;
-                                            }
-                                        }
-                                        total_sent += sent;
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                perror("read");
-                                close(fd);
-                            }
-                            break;
-                        }
-                    }
-                }
-                // 7.3 处理可写事件
-                else if (events[i].events & EPOLLOUT)
-                {
-                    int fd = events[i].data.fd;
-                    // 获取之前未发送完的数据（需通过上下文或自定义结构体传递）
-                    YourBuffer *pending_data = get_pending_data(fd);
-
-                    // 继续发送剩余数据
-                    ssize_t sent = write(fd, pending_data->buf + pending_data->sent_len,
-                                         pending_data->total_len - pending_data->sent_len);
-                    if (sent > 0)
-                    {
-                        pending_data->sent_len += sent;
-                        if (pending_data->sent_len == pending_data->total_len)
-                        {
-                            // 全部发送完成，恢复监听读事件
-                            free_pending_data(fd);
-                            event.events = EPOLLIN | EPOLLET | EPOLLRDHUP;
-                            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
-                        }
-                    }
-                    else if (sent == -1 && errno != EAGAIN)
-                    {
-                        // 真实错误
-                        close(fd);
-                        free_pending_data(fd);
-                    }
-                    // 若 sent == -1 && errno == EAGAIN，保持监听 EPOLLOUT
-                }
+                handle_conn(w, (conn_t *)events[i].data.ptr, events[i].events);
             }
         }
+
+        tw_advance(&w->wheel, conn_on_timer, w);
     }
 
-    close(listen_fd);
-    close(epoll_fd);
+    close(w->listen_fd);
+    close(w->epoll_fd);
+    pool_destroy(&w->conn_pool);
+    pool_destroy(&w->buffer_pool);
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 5)
+    {
+        fprintf(stderr, "Usage: %s <port> [workers] [copy|splice|zerocopy|sendfile:<path>] [idle_seconds]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // 空闲超时缺省60秒，0 表示关闭空闲淘汰
+    int idle_seconds = argc == 5 ? atoi(argv[4]) : 60;
+    g_idle_ticks = idle_seconds > 0 ? (uint64_t)idle_seconds * 1000 / TW_TICK_MS : 0;
+
+    // 发送方式缺省为copy；sendfile 模式对每行请求回复整个文件
+    if (argc >= 4)
+    {
+        if (strcmp(argv[3], "copy") == 0)
+        {
+            g_mode = MODE_COPY;
+        }
+        else if (strcmp(argv[3], "splice") == 0)
+        {
+            g_mode = MODE_SPLICE;
+        }
+        else if (strcmp(argv[3], "zerocopy") == 0)
+        {
+            g_mode = MODE_ZEROCOPY;
+        }
+        else if (strncmp(argv[3], "sendfile:", 9) == 0)
+        {
+            g_mode = MODE_SENDFILE;
+            g_file_fd = open(argv[3] + 9, O_RDONLY);
+            struct stat st;
+            if (g_file_fd == -1 || fstat(g_file_fd, &st) == -1)
+            {
+                perror(argv[3] + 9);
+                exit(EXIT_FAILURE);
+            }
+            g_file_size = st.st_size;
+        }
+        else
+        {
+            fprintf(stderr, "unknown mode: %s\n", argv[3]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int port = atoi(argv[1]);
+    // worker数量缺省为1，即原来的单线程ET服务器；大于1时进入多reactor模式
+    int nworkers = argc >= 3 ? atoi(argv[2]) : 1;
+    if (nworkers < 1 || nworkers > MAX_WORKERS)
+    {
+        fprintf(stderr, "workers must be in [1, %d]\n", MAX_WORKERS);
+        exit(EXIT_FAILURE);
+    }
+
+    // 对端已关闭时write会触发SIGPIPE，默认行为是杀死进程，这里改为返回EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    worker_t workers[MAX_WORKERS];
+    for (int i = 0; i < nworkers; i++)
+    {
+        workers[i].id = i;
+        workers[i].port = port;
+        if (worker_init(&workers[i], nworkers > 1) == -1)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("Server listening on port %d with %d worker(s)...\n", port, nworkers);
+
+    // 主线程自己充当0号worker，其余worker各起一个线程
+    for (int i = 1; i < nworkers; i++)
+    {
+        if (pthread_create(&workers[i].thread_id, NULL, event_loop, &workers[i]) != 0)
+        {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    event_loop(&workers[0]);
+
+    for (int i = 1; i < nworkers; i++)
+    {
+        pthread_join(workers[i].thread_id, NULL);
+    }
     return 0;
 }
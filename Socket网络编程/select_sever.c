@@ -2,108 +2,349 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
 #include <netinet/in.h>
-#include <sys/select.h>
+#include <netinet/tcp.h>
+
+// 固定大小线程池 + 单个多路复用线程
+// 原来每个客户端一个线程、每个线程每秒被select超时唤醒一次，且最多10个客户端；
+// 现在由主线程用epoll统一等待所有连接（-1超时，空闲连接不消耗CPU），
+// 就绪的fd通过无锁队列交给工作线程处理。连接数只受fd上限限制。
+// FD_SETSIZE 限制了select最多只能管理1024个fd，所以多路复用改用epoll。
 
-#define MAX_CLIENTS 10
 #define PORT 8080
 #define BUFFER_SIZE 1024
+#define WORKER_COUNT 4
+#define QUEUE_CAPACITY 65536 // 必须是2的幂
+#define MAX_EVENTS 1024
 
+// ---------------------------------------------------------------------------
+// 有界无锁MPMC队列（Vyukov算法）：每个槽位带一个序号，生产者/消费者各自CAS推进位置
+// 这里只有一个生产者（多路复用线程），消费者是所有工作线程
+// ---------------------------------------------------------------------------
 typedef struct
 {
+    atomic_size_t sequence;
     int fd;
-    pthread_t thread_id;
-} client_info;
+} queue_cell;
 
-client_info clients[MAX_CLIENTS];
-pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
+typedef struct
+{
+    queue_cell cells[QUEUE_CAPACITY];
+    _Alignas(64) atomic_size_t enqueue_pos; // 两个位置分开放在不同缓存行，避免伪共享
+    _Alignas(64) atomic_size_t dequeue_pos;
+    sem_t items; // 队列中元素个数；工作线程在队列为空时睡在这里，不忙等
+} fd_queue;
 
-void *handle_client(void *arg)
+static fd_queue queue;
+
+static void queue_init(fd_queue *q)
 {
-    int client_fd = *(int *)arg;
-    char buffer[BUFFER_SIZE];
+    for (size_t i = 0; i < QUEUE_CAPACITY; i++)
+    {
+        atomic_store_explicit(&q->cells[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&q->enqueue_pos, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->dequeue_pos, 0, memory_order_relaxed);
+    sem_init(&q->items, 0, 0);
+}
 
-    while (1)
+static bool queue_try_push(fd_queue *q, int fd)
+{
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    while (true)
+    {
+        queue_cell *cell = &q->cells[pos & (QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                cell->fd = fd;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                sem_post(&q->items);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // 队列已满
+        }
+        else
+        {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static bool queue_try_pop(fd_queue *q, int *fd)
+{
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    while (true)
+    {
+        queue_cell *cell = &q->cells[pos & (QUEUE_CAPACITY - 1)];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *fd = cell->fd;
+                atomic_store_explicit(&cell->sequence, pos + QUEUE_CAPACITY, memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false; // 队列为空
+        }
+        else
+        {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// 阻塞出队：信号量保证有元素后才去抢
+static int queue_pop(fd_queue *q)
+{
+    int fd;
+    while (sem_wait(&q->items) == -1 && errno == EINTR)
+    {
+    }
+    while (!queue_try_pop(q, &fd))
     {
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(client_fd, &read_fds);
+        // 信号量先于sequence发布的极短窗口，重试即可
+    }
+    return fd;
+}
+
+static int epoll_fd;
+
+// 每个连接没写出去的回显数据。发送缓冲区满时工作线程不能原地等可写（那样慢客户端会占住整个线程池），
+// 剩余字节存在这里，改为等 EPOLLOUT，线程回到线程池。积压期间不再读这个连接，所以剩余字节不超过一次读的量，
+// 缓冲区只在积压时才分配。ONESHOT 保证同一时刻只有一个线程访问某个fd的状态
+typedef struct
+{
+    char *buf; // BUFFER_SIZE 字节，没有积压时为 NULL
+    size_t off;
+    size_t len;
+} conn_t;
 
-        struct timeval tv = {1, 0}; // 1秒超时
+static conn_t *conns; // 按fd下标，大小为fd上限
+static size_t max_conns;
 
-        int ret = select(client_fd + 1, &read_fds, NULL, NULL, &tv);
-        if (ret == -1)
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        perror("fcntl");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// 尽量写出数据，返回写出的字节数；发送缓冲区满时不等待，返回-1表示连接出错
+static ssize_t write_some(int fd, const char *buf, size_t len)
+{
+    size_t done = 0;
+    while (done < len)
+    {
+        ssize_t n = write(fd, buf + done, len - done);
+        if (n > 0)
         {
-            perror("select in thread");
-            break;
+            done += n;
         }
-        else if (ret == 0)
+        else if (n == -1 && errno == EINTR)
         {
-            // 超时，可以做一些其他处理
             continue;
         }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    return done;
+}
+
+// 重新武装EPOLLONESHOT。积压时只传EPOLLOUT：不读新数据，也不要EPOLLRDHUP（对端半关闭后它会一直上报，写不出去时会空转）
+static bool rearm(int fd, uint32_t events)
+{
+    struct epoll_event ev;
+    ev.events = events | EPOLLONESHOT;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1)
+    {
+        perror("epoll_ctl EPOLL_CTL_MOD");
+        return false;
+    }
+    return true;
+}
+
+// 把没写完的部分存进连接的积压缓冲区
+static bool conn_save(conn_t *c, const char *data, size_t len)
+{
+    if (c->buf == NULL && (c->buf = malloc(BUFFER_SIZE)) == NULL)
+    {
+        perror("malloc");
+        return false;
+    }
+    memcpy(c->buf, data, len);
+    c->off = 0;
+    c->len = len;
+    return true;
+}
+
+static void conn_close(int fd)
+{
+    free(conns[fd].buf);
+    conns[fd].buf = NULL;
+    conns[fd].len = 0;
+    // close会自动从epoll中移除
+    close(fd);
+}
 
-        if (FD_ISSET(client_fd, &read_fds))
+// 处理一个就绪连接：先写积压的数据，再读到EAGAIN为止并回显，然后重新武装EPOLLONESHOT
+// ONESHOT 保证同一个fd同一时刻只会被一个工作线程处理，不需要按连接加锁
+static void handle_client(int client_fd)
+{
+    conn_t *c = &conns[client_fd];
+    if (c->len > 0)
+    {
+        ssize_t n = write_some(client_fd, c->buf + c->off, c->len);
+        if (n == -1)
         {
-            memset(buffer, 0, BUFFER_SIZE);
-            ssize_t bytes_read = read(client_fd, buffer, BUFFER_SIZE - 1);
-            if (bytes_read <= 0)
+            conn_close(client_fd);
+            return;
+        }
+        c->off += n;
+        c->len -= n;
+        if (c->len > 0)
+        {
+            if (!rearm(client_fd, EPOLLOUT))
             {
-                // 客户端断开连接
-                break;
+                conn_close(client_fd);
             }
-            printf("Received from client %d: %s\n", client_fd, buffer);
-
-            // 简单回显
-            write(client_fd, buffer, bytes_read);
+            return;
         }
+        free(c->buf);
+        c->buf = NULL;
     }
 
-    // 清理客户端
-    close(client_fd);
-    pthread_mutex_lock(&clients_mutex);
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    char buffer[BUFFER_SIZE];
+    while (true)
     {
-        if (clients[i].fd == client_fd)
+        ssize_t bytes_read = read(client_fd, buffer, BUFFER_SIZE);
+        if (bytes_read > 0)
+        {
+            // 简单回显；写不完的存起来等可写，期间不再读
+            ssize_t n = write_some(client_fd, buffer, bytes_read);
+            if (n == -1)
+            {
+                break;
+            }
+            if (n < bytes_read)
+            {
+                if (!conn_save(c, buffer + n, bytes_read - n) || !rearm(client_fd, EPOLLOUT))
+                {
+                    break;
+                }
+                return;
+            }
+        }
+        else if (bytes_read == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            if (!rearm(client_fd, EPOLLIN | EPOLLRDHUP))
+            {
+                break;
+            }
+            return;
+        }
+        else
         {
-            clients[i].fd = -1;
+            // 客户端断开连接或出错
             break;
         }
     }
-    pthread_mutex_unlock(&clients_mutex);
 
+    // 清理客户端
+    conn_close(client_fd);
+}
+
+static void *worker_thread(void *arg)
+{
+    (void)arg;
+    while (true)
+    {
+        handle_client(queue_pop(&queue));
+    }
     return NULL;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-    int server_fd, new_socket;
+    int server_fd;
     struct sockaddr_in address;
     int opt = 1;
-    int addrlen = sizeof(address);
+    int nworkers = argc > 1 ? atoi(argv[1]) : WORKER_COUNT;
+    if (nworkers < 1)
+    {
+        fprintf(stderr, "Usage: %s [workers]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    queue_init(&queue);
 
-    // 初始化客户端数组
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    // 连接状态按fd下标存放，fd不会超过进程的fd上限
+    struct rlimit nofile;
+    if (getrlimit(RLIMIT_NOFILE, &nofile) == -1)
     {
-        clients[i].fd = -1;
+        perror("getrlimit");
+        exit(EXIT_FAILURE);
+    }
+    max_conns = nofile.rlim_cur == RLIM_INFINITY ? 1 << 20 : nofile.rlim_cur;
+    if ((conns = calloc(max_conns, sizeof(conn_t))) == NULL)
+    {
+        perror("calloc");
+        exit(EXIT_FAILURE);
     }
 
     // 创建服务器socket
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0)
+    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == -1)
     {
         perror("socket failed");
         exit(EXIT_FAILURE);
     }
 
     // 设置socket选项
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt)))
+    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)))
     {
         perror("setsockopt");
         exit(EXIT_FAILURE);
     }
 
+    memset(&address, 0, sizeof(address));
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(PORT);
@@ -116,91 +357,100 @@ int main()
     }
 
     // 监听
-    if (listen(server_fd, 3) < 0)
+    if (listen(server_fd, SOMAXCONN) < 0)
     {
         perror("listen");
         exit(EXIT_FAILURE);
     }
+    set_nonblocking(server_fd);
 
-    printf("Server started on port %d\n", PORT);
-
-    while (1)
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1)
+    {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = server_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &ev) == -1)
     {
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(server_fd, &read_fds);
-        int max_fd = server_fd;
+        perror("epoll_ctl EPOLL_CTL_ADD");
+        exit(EXIT_FAILURE);
+    }
 
-        // 添加现有客户端到select集合
-        pthread_mutex_lock(&clients_mutex);
-        for (int i = 0; i < MAX_CLIENTS; i++)
+    // 启动固定数量的工作线程
+    for (int i = 0; i < nworkers; i++)
+    {
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, worker_thread, NULL) != 0)
         {
-            if (clients[i].fd != -1)
-            {
-                FD_SET(clients[i].fd, &read_fds);
-                if (clients[i].fd > max_fd)
-                {
-                    max_fd = clients[i].fd;
-                }
-            }
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
         }
-        pthread_mutex_unlock(&clients_mutex);
+        pthread_detach(tid);
+    }
 
-        // 设置5秒超时
-        struct timeval tv = {5, 0};
-        int activity = select(max_fd + 1, &read_fds, NULL, NULL, &tv);
+    printf("Server started on port %d with %d workers\n", PORT, nworkers);
 
-        if ((activity < 0) && (errno != EINTR))
-        {
-            perror("select error");
-        }
-        else if (activity == 0)
-        {
-            printf("Select timeout, no activity in 5 seconds\n");
-            continue;
-        }
-
-        // 检查新连接
-        if (FD_ISSET(server_fd, &read_fds))
+    struct epoll_event events[MAX_EVENTS];
+    while (1)
+    {
+        // 没有任何事件时一直阻塞，不再周期性超时唤醒
+        int nfds = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (nfds == -1)
         {
-            if ((new_socket = accept(server_fd, (struct sockaddr *)&address, (socklen_t *)&addrlen)) < 0)
+            if (errno == EINTR)
             {
-                perror("accept");
                 continue;
             }
+            perror("epoll_wait");
+            break;
+        }
 
-            printf("New connection, socket fd: %d\n", new_socket);
-
-            // 添加到客户端数组
-            pthread_mutex_lock(&clients_mutex);
-            int added = 0;
-            for (int i = 0; i < MAX_CLIENTS; i++)
+        for (int i = 0; i < nfds; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == server_fd)
             {
-                if (clients[i].fd == -1)
+                // 检查新连接：监听socket非阻塞，一次接完所有排队的连接
+                int new_socket;
+                while ((new_socket = accept(server_fd, NULL, NULL)) != -1)
                 {
-                    clients[i].fd = new_socket;
-                    if (pthread_create(&clients[i].thread_id, NULL, handle_client, &clients[i].fd) != 0)
+                    if ((size_t)new_socket >= max_conns)
                     {
-                        perror("pthread_create");
+                        fprintf(stderr, "fd %d exceeds fd limit\n", new_socket);
                         close(new_socket);
-                        clients[i].fd = -1;
+                        continue;
                     }
-                    else
+                    set_nonblocking(new_socket);
+                    // 回显按BUFFER_SIZE分段写出，关闭Nagle避免与对端延迟ACK互相等待
+                    setsockopt(new_socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+                    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+                    ev.data.fd = new_socket;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, new_socket, &ev) == -1)
                     {
-                        added = 1;
+                        perror("epoll_ctl EPOLL_CTL_ADD");
+                        close(new_socket);
                     }
-                    break;
                 }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    perror("accept");
+                }
+                continue;
             }
-            pthread_mutex_unlock(&clients_mutex);
 
-            if (!added)
+            // 客户端就绪：交给线程池。ONESHOT下同一个fd在重新武装前不会再次上报，
+            // 所以每个fd在队列里最多出现一次，队列不会被同一连接挤满
+            while (!queue_try_push(&queue, fd))
             {
-                printf("Max clients reached, rejecting connection\n");
-                close(new_socket);
+                sched_yield();
             }
         }
     }
 
+    close(server_fd);
+    close(epoll_fd);
     return 0;
 }
@@ -0,0 +1,660 @@
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+// io_uring 版本的回显服务器，语义与 epoll.c / epollet.c 相同：收到什么回什么
+// 1. 多次触发(multishot) accept：一个 SQE 持续产生新连接，不必每次重新提交
+// 2. 多次触发 recv + provided buffer ring：内核收包时自己从缓冲环里挑缓冲区，
+//    连接不预先占用缓冲内存
+// 3. 批量提交：一轮里处理完所有 CQE 产生的新 SQE，再用一次 io_uring_enter 提交并等待
+// 直接使用系统调用和 <linux/io_uring.h>，不依赖 liburing（需要 Linux 6.0+）
+// 用法: ./uring_server <port>
+
+#define QUEUE_DEPTH 4096
+#define BUF_GROUP 0
+#define BUF_COUNT 4096 // 必须是2的幂
+#define BUF_SIZE 4096
+#define MAX_CONNS 65536
+#define SEND_IOV_MAX 16 // 一次 sendmsg 最多合并的排队缓冲区数
+#define DEFERRED_MAX (4 * MAX_CONNS) // 每个连接至多一个 recv 和一个 send 等 SQE，再加 accept；必须是2的幂
+
+// user_data 编码：高8位操作类型，低32位fd
+enum
+{
+    OP_ACCEPT = 1,
+    OP_RECV = 2,
+    OP_SEND = 3,
+};
+
+static inline uint64_t make_user_data(uint8_t op, int fd)
+{
+    return ((uint64_t)op << 56) | (uint32_t)fd;
+}
+static inline uint8_t ud_op(uint64_t ud) { return ud >> 56; }
+static inline int ud_fd(uint64_t ud) { return (int)(uint32_t)ud; }
+
+// ---------------------------------------------------------------------------
+// 最小化的 io_uring 封装：mmap 出 SQ/CQ 两个环，自己维护 head/tail
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    int ring_fd;
+    // 提交队列
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_local_tail; // 已填写但还没提交的SQE
+    unsigned sq_submitted;
+    // 完成队列
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+} uring_t;
+
+static int uring_init(uring_t *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->ring_fd == -1)
+    {
+        perror("io_uring_setup");
+        return -1;
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        fprintf(stderr, "kernel too old: IORING_FEAT_SINGLE_MMAP required\n");
+        return -1;
+    }
+
+    // SQ 和 CQ 共用一次 mmap
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    size_t ring_size = sq_size > cq_size ? sq_size : cq_size;
+    char *ring_ptr = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring_ptr == MAP_FAILED)
+    {
+        perror("mmap sq/cq ring");
+        return -1;
+    }
+    ring->sq_head = (unsigned *)(ring_ptr + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(ring_ptr + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(ring_ptr + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(ring_ptr + params.sq_off.array);
+    ring->cq_head = (unsigned *)(ring_ptr + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(ring_ptr + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(ring_ptr + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(ring_ptr + params.cq_off.cqes);
+
+    ring->sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        perror("mmap sqes");
+        return -1;
+    }
+    ring->sq_local_tail = ring->sq_submitted = *ring->sq_tail;
+    return 0;
+}
+
+// 提交所有待提交的SQE，并至少等待 wait_nr 个完成事件
+static int uring_submit_and_wait(uring_t *ring, unsigned wait_nr)
+{
+    unsigned to_submit = ring->sq_local_tail - ring->sq_submitted;
+    // 发布SQE：先写好SQE内容，再用release语义推进tail，内核才能看到
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    ring->sq_submitted = ring->sq_local_tail;
+
+    while (true)
+    {
+        int ret = syscall(__NR_io_uring_enter, ring->ring_fd, to_submit, wait_nr,
+                          wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret >= 0)
+        {
+            return ret;
+        }
+        if (errno != EINTR)
+        {
+            perror("io_uring_enter");
+            return -1;
+        }
+        to_submit = 0;
+    }
+}
+
+// 取一个空闲SQE；队列满了先把已有的提交掉
+static struct io_uring_sqe *uring_get_sqe(uring_t *ring)
+{
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head > *ring->sq_mask)
+    {
+        uring_submit_and_wait(ring, 0);
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (ring->sq_local_tail - head > *ring->sq_mask)
+        {
+            return NULL;
+        }
+    }
+    unsigned idx = ring->sq_local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[idx] = idx;
+    ring->sq_local_tail++;
+    return sqe;
+}
+
+// ---------------------------------------------------------------------------
+// provided buffer ring：用户态往环里放缓冲区，内核 recv 时取用
+// ---------------------------------------------------------------------------
+typedef struct
+{
+    struct io_uring_buf_ring *br;
+    char *base; // BUF_COUNT * BUF_SIZE 的连续内存
+    unsigned short tail;
+    unsigned in_use; // 已被内核填了数据、还没归还的缓冲区数
+} buf_ring_t;
+
+static void conn_recv_resume(void);
+
+static int buf_ring_init(uring_t *ring, buf_ring_t *bufs)
+{
+    size_t ring_bytes = BUF_COUNT * sizeof(struct io_uring_buf);
+    bufs->br = mmap(NULL, ring_bytes, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    bufs->base = mmap(NULL, (size_t)BUF_COUNT * BUF_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (bufs->br == MAP_FAILED || bufs->base == MAP_FAILED)
+    {
+        perror("mmap buffers");
+        return -1;
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long)bufs->br;
+    reg.ring_entries = BUF_COUNT;
+    reg.bgid = BUF_GROUP;
+    if (syscall(__NR_io_uring_register, ring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+    {
+        perror("IORING_REGISTER_PBUF_RING");
+        return -1;
+    }
+
+    bufs->tail = 0;
+    for (unsigned short bid = 0; bid < BUF_COUNT; bid++)
+    {
+        struct io_uring_buf *buf = &bufs->br->bufs[(bufs->tail + bid) & (BUF_COUNT - 1)];
+        buf->addr = (unsigned long)(bufs->base + (size_t)bid * BUF_SIZE);
+        buf->len = BUF_SIZE;
+        buf->bid = bid;
+    }
+    bufs->tail += BUF_COUNT;
+    bufs->in_use = 0;
+    __atomic_store_n(&bufs->br->tail, bufs->tail, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 发送完成后把缓冲区还给内核；有连接因 ENOBUFS 在等缓冲区时，顺手给它重新挂上 recv
+static void buf_ring_recycle(buf_ring_t *bufs, unsigned short bid)
+{
+    struct io_uring_buf *buf = &bufs->br->bufs[bufs->tail & (BUF_COUNT - 1)];
+    buf->addr = (unsigned long)(bufs->base + (size_t)bid * BUF_SIZE);
+    buf->len = BUF_SIZE;
+    buf->bid = bid;
+    bufs->tail++;
+    bufs->in_use--;
+    __atomic_store_n(&bufs->br->tail, bufs->tail, __ATOMIC_RELEASE);
+    conn_recv_resume();
+}
+
+static inline char *buf_addr(buf_ring_t *bufs, unsigned short bid)
+{
+    return bufs->base + (size_t)bid * BUF_SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// 连接状态：同一连接同一时刻只有一个 sendmsg 在途，收到的缓冲区排队，保证回显顺序；
+// 发送时把队列前面的若干缓冲区合并成一次 sendmsg
+// ---------------------------------------------------------------------------
+#define NO_BUF 0xffff
+
+typedef struct
+{
+    bool recv_armed; // multishot recv 仍在内核中挂着（或在等 SQE）
+    bool recv_waiting; // 收到 ENOBUFS，在等待链表里等缓冲区归还
+    bool sending;    // 有一个 send 在途
+    bool eof;        // 对端已关闭写端：发完排队数据后关闭
+    bool error;      // 出错：丢弃排队数据，等在途操作结束后关闭
+    unsigned short head; // 待发送缓冲区队列（通过 buf_next 串起来）
+    unsigned short tail;
+    struct msghdr msg; // 在途 sendmsg 的参数，内核完成前必须保持有效
+    struct iovec iov[SEND_IOV_MAX];
+} conn_t;
+
+static conn_t conns[MAX_CONNS];
+static unsigned short buf_next[BUF_COUNT]; // 队列里的下一个缓冲区
+static unsigned buf_len[BUF_COUNT];        // 缓冲区里的有效字节
+static unsigned buf_off[BUF_COUNT];        // 已发送的字节
+
+// 等缓冲区的连接按 ENOBUFS 的先后串成双向链表，下标 MAX_CONNS 是哨兵
+#define WAIT_LIST MAX_CONNS
+static int wait_prev[MAX_CONNS + 1];
+static int wait_next[MAX_CONNS + 1];
+
+// 拿不到 SQE 的操作先按 user_data 记下来，下一次 io_uring_enter 腾出 SQ 后再补填
+static uint64_t deferred[DEFERRED_MAX];
+static unsigned deferred_head;
+static unsigned deferred_tail;
+
+static uring_t ring;
+static buf_ring_t bufs;
+
+static void wait_push(int fd)
+{
+    int last = wait_prev[WAIT_LIST];
+    wait_prev[fd] = last;
+    wait_next[fd] = WAIT_LIST;
+    wait_next[last] = fd;
+    wait_prev[WAIT_LIST] = fd;
+    conns[fd].recv_waiting = true;
+}
+
+static void wait_remove(int fd)
+{
+    wait_next[wait_prev[fd]] = wait_next[fd];
+    wait_prev[wait_next[fd]] = wait_prev[fd];
+    conns[fd].recv_waiting = false;
+}
+
+// 按 user_data 填写 SQE；send 的参数已经在 conns[fd].msg 里准备好
+static void fill_sqe(struct io_uring_sqe *sqe, uint64_t ud)
+{
+    int fd = ud_fd(ud);
+    sqe->fd = fd;
+    sqe->user_data = ud;
+    switch (ud_op(ud))
+    {
+    case OP_ACCEPT:
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        break;
+    case OP_RECV:
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUF_GROUP;
+        break;
+    case OP_SEND:
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = (unsigned long)&conns[fd].msg;
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        break;
+    }
+}
+
+// SQ 满且提交后仍腾不出位置时（例如内核返回 EBUSY），操作进延迟队列，不能丢
+static void submit_op(uint64_t ud)
+{
+    struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+    if (sqe == NULL)
+    {
+        deferred[deferred_tail++ & (DEFERRED_MAX - 1)] = ud;
+        return;
+    }
+    fill_sqe(sqe, ud);
+}
+
+static void prep_accept(int listen_fd)
+{
+    submit_op(make_user_data(OP_ACCEPT, listen_fd));
+}
+
+static void prep_recv(int fd)
+{
+    conns[fd].recv_armed = true;
+    submit_op(make_user_data(OP_RECV, fd));
+}
+
+static void prep_send(int fd)
+{
+    conn_t *c = &conns[fd];
+    int iovcnt = 0;
+    for (unsigned short bid = c->head; bid != NO_BUF && iovcnt < SEND_IOV_MAX; bid = buf_next[bid])
+    {
+        c->iov[iovcnt].iov_base = buf_addr(&bufs, bid) + buf_off[bid];
+        c->iov[iovcnt].iov_len = buf_len[bid] - buf_off[bid];
+        iovcnt++;
+    }
+    memset(&c->msg, 0, sizeof(c->msg));
+    c->msg.msg_iov = c->iov;
+    c->msg.msg_iovlen = iovcnt;
+    c->sending = true;
+    submit_op(make_user_data(OP_SEND, fd));
+}
+
+// 只有在没有任何在途操作时才能close：否则fd号被新连接复用后，迟到的CQE会串到新连接上
+static void conn_maybe_close(int fd)
+{
+    conn_t *c = &conns[fd];
+    if (c->recv_armed || c->sending)
+    {
+        return;
+    }
+    if (c->error || (c->eof && c->head == NO_BUF))
+    {
+        // 先摘出等待链表，下面归还缓冲区时才不会又给这个连接挂上 recv
+        if (c->recv_waiting)
+        {
+            wait_remove(fd);
+        }
+        // 归还所有排队中的缓冲区
+        for (unsigned short bid = c->head; bid != NO_BUF; bid = buf_next[bid])
+        {
+            buf_ring_recycle(&bufs, bid);
+        }
+        memset(c, 0, sizeof(*c));
+        close(fd);
+    }
+}
+
+// 有缓冲区归还时，唤醒等得最久的那个连接重新挂 recv；每还一个缓冲区唤醒一个
+static void conn_recv_resume(void)
+{
+    int fd = wait_next[WAIT_LIST];
+    if (fd != WAIT_LIST)
+    {
+        wait_remove(fd);
+        prep_recv(fd);
+    }
+}
+
+// 补填延迟队列里的操作；等待期间出错的连接不再提交，当作操作已经完成
+static void flush_deferred(void)
+{
+    while (deferred_head != deferred_tail)
+    {
+        uint64_t ud = deferred[deferred_head & (DEFERRED_MAX - 1)];
+        int fd = ud_fd(ud);
+        if (ud_op(ud) != OP_ACCEPT && conns[fd].error)
+        {
+            deferred_head++;
+            if (ud_op(ud) == OP_RECV)
+            {
+                conns[fd].recv_armed = false;
+            }
+            else
+            {
+                conns[fd].sending = false;
+            }
+            conn_maybe_close(fd);
+            continue;
+        }
+        struct io_uring_sqe *sqe = uring_get_sqe(&ring);
+        if (sqe == NULL)
+        {
+            return;
+        }
+        deferred_head++;
+        fill_sqe(sqe, ud);
+    }
+}
+
+// 如果连接空闲，开始发送队首缓冲区
+static void conn_kick(int fd)
+{
+    conn_t *c = &conns[fd];
+    if (!c->sending && !c->error && c->head != NO_BUF)
+    {
+        prep_send(fd);
+    }
+    conn_maybe_close(fd);
+}
+
+static void handle_accept(int listen_fd, struct io_uring_cqe *cqe)
+{
+    if (cqe->res >= 0)
+    {
+        int fd = cqe->res;
+        if (fd >= MAX_CONNS)
+        {
+            fprintf(stderr, "fd %d exceeds MAX_CONNS\n", fd);
+            close(fd);
+        }
+        else
+        {
+            // 回显会把一条消息拆成多个缓冲区发送，关闭Nagle避免与对端延迟ACK互相等待
+            int opt = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+            memset(&conns[fd], 0, sizeof(conn_t));
+            conns[fd].head = conns[fd].tail = NO_BUF;
+            prep_recv(fd);
+        }
+    }
+    else
+    {
+        fprintf(stderr, "accept: %s\n", strerror(-cqe->res));
+    }
+    // 没有 IORING_CQE_F_MORE 说明 multishot 已终止，需要重新提交
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+    {
+        prep_accept(listen_fd);
+    }
+}
+
+static void handle_recv(int fd, struct io_uring_cqe *cqe)
+{
+    conn_t *c = &conns[fd];
+    bool more = cqe->flags & IORING_CQE_F_MORE;
+    if (!more)
+    {
+        c->recv_armed = false;
+    }
+
+    if (cqe->res > 0)
+    {
+        unsigned short bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        bufs.in_use++;
+        if (c->error)
+        {
+            buf_ring_recycle(&bufs, bid);
+        }
+        else
+        {
+            buf_len[bid] = cqe->res;
+            buf_off[bid] = 0;
+            buf_next[bid] = NO_BUF;
+            if (c->tail == NO_BUF)
+            {
+                c->head = bid;
+            }
+            else
+            {
+                buf_next[c->tail] = bid;
+            }
+            c->tail = bid;
+            if (!more)
+            {
+                prep_recv(fd);
+            }
+        }
+    }
+    else if (cqe->res == -ENOBUFS)
+    {
+        // 缓冲环被取空。马上重挂只会立刻再收到 ENOBUFS，空转CPU；
+        // 挂进等待链表，由 buf_ring_recycle 在缓冲区归还时重新挂 recv。
+        // 内核报错到这里之间可能已经有缓冲区还回来（没有唤醒到这个连接），这时直接重挂
+        if (!c->error && !c->recv_armed)
+        {
+            if (bufs.in_use < BUF_COUNT)
+            {
+                prep_recv(fd);
+            }
+            else
+            {
+                wait_push(fd);
+            }
+        }
+    }
+    else if (cqe->res == 0)
+    {
+        // 对端关闭
+        c->eof = true;
+    }
+    else
+    {
+        if (cqe->res != -ECONNRESET)
+        {
+            fprintf(stderr, "recv: %s\n", strerror(-cqe->res));
+        }
+        c->error = true;
+    }
+    conn_kick(fd);
+}
+
+static void handle_send(int fd, struct io_uring_cqe *cqe)
+{
+    conn_t *c = &conns[fd];
+    c->sending = false;
+    if (cqe->res < 0)
+    {
+        // 发送失败：shutdown 让挂着的 multishot recv 尽快结束，之后统一关闭
+        c->error = true;
+        shutdown(fd, SHUT_RDWR);
+        conn_maybe_close(fd);
+        return;
+    }
+
+    // 按发送字节数依次消费队首缓冲区；发完的归还给内核，短写时队首只前移偏移量
+    unsigned sent = cqe->res;
+    while (sent > 0 && c->head != NO_BUF)
+    {
+        unsigned short bid = c->head;
+        unsigned take = buf_len[bid] - buf_off[bid];
+        if (take > sent)
+        {
+            take = sent;
+        }
+        buf_off[bid] += take;
+        sent -= take;
+        if (buf_off[bid] == buf_len[bid])
+        {
+            c->head = buf_next[bid];
+            if (c->head == NO_BUF)
+            {
+                c->tail = NO_BUF;
+            }
+            buf_ring_recycle(&bufs, bid);
+        }
+    }
+    conn_kick(fd);
+}
+
+static int create_listener(int port)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    int opt = 1;
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
+    {
+        perror("setsockopt");
+        close(listen_fd);
+        return -1;
+    }
+
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    server_addr.sin_port = htons(port);
+    if (bind(listen_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1)
+    {
+        perror("bind");
+        close(listen_fd);
+        return -1;
+    }
+    if (listen(listen_fd, SOMAXCONN) == -1)
+    {
+        perror("listen");
+        close(listen_fd);
+        return -1;
+    }
+    return listen_fd;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <port>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = create_listener(atoi(argv[1]));
+    if (listen_fd == -1 || uring_init(&ring, QUEUE_DEPTH) == -1 || buf_ring_init(&ring, &bufs) == -1)
+    {
+        exit(EXIT_FAILURE);
+    }
+    printf("io_uring server listening on port %s...\n", argv[1]);
+
+    wait_prev[WAIT_LIST] = wait_next[WAIT_LIST] = WAIT_LIST;
+    prep_accept(listen_fd);
+    while (true)
+    {
+        // 一次系统调用：提交上一轮积累的全部SQE，并等待至少一个完成事件；
+        // 还有延迟的操作时不等待，提交腾出位置后马上补填
+        if (uring_submit_and_wait(&ring, deferred_head == deferred_tail ? 1 : 0) == -1)
+        {
+            break;
+        }
+        flush_deferred();
+
+        // 收割所有已完成的CQE
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+        {
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            uint64_t ud = cqe->user_data;
+            switch (ud_op(ud))
+            {
+            case OP_ACCEPT:
+                handle_accept(ud_fd(ud), cqe);
+                break;
+            case OP_RECV:
+                handle_recv(ud_fd(ud), cqe);
+                break;
+            case OP_SEND:
+                handle_send(ud_fd(ud), cqe);
+                break;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    close(listen_fd);
+    close(ring.ring_fd);
+    return 0;
+}
@@ -1,42 +1,24 @@
+#include <iostream>
 #include <vector>
 #include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include "../C++语法/任务池.h"
+#include "../C++语法/归并排序算法.h"
 using namespace std;
 
+const int PARALLEL_GRAIN = 1 << 15; // 并行模式下小于这个长度的区间串行排序
+const int MERGE_GRAIN = 1 << 15;    // 并行合并时小于这个长度的区间串行合并
+
+// 闭区间 [left, right] 归并排序：临时数组只分配一次，交给自底向上的引擎
 void mergesort(vector<int> &nums, int left, int right)
 {
     if (left >= right)
         return;
-    int mid = left + (right - left) / 2;
-    mergesort(nums, left, mid);
-    mergesort(nums, mid + 1, right);
-
     vector<int> temp(right - left + 1);
-    int i = left, j = mid + 1, k = 0;
-    while (i <= mid && j <= right)
-    {
-        if (nums[i] <= nums[j])
-            temp[k++] = nums[i++];
-        else
-            temp[k++] = nums[j++];
-    }
-    while (i <= mid)
-    {
-        temp[k++] = nums[i++];
-    }
-    while (j <= right)
-    {
-        temp[k++] = nums[j++];
-    }
-    for (int i = 0; i < temp.size(); ++i)
-    {
-        nums[left + i] = temp[i];
-    }
-}
-
-void mergeSortOpt(vector<int> &nums)
-{
-    vector<int> temp(nums.size()); // 预分配
-    mergeSortHelper(nums, 0, nums.size() - 1, temp);
+    mergeSortBottomUp(nums.data() + left, temp.data(), right - left + 1);
 }
 
 void mergeSortHelper(vector<int> &nums, int left, int right, vector<int> &temp)
@@ -62,7 +44,138 @@ void mergeSortHelper(vector<int> &nums, int left, int right, vector<int> &temp)
     }
 }
 
-int main()
+void mergeSortOpt(vector<int> &nums)
 {
+    vector<int> temp(nums.size()); // 预分配
+    mergeSortHelper(nums, 0, nums.size() - 1, temp);
+}
+
+// 并行合并：取较长一段的中点，在另一段里二分出切分位置，中点左右两部分可以独立合并
+void parallelMerge(const int *a1, const int *e1, const int *a2, const int *e2, int *out, TaskPool &pool)
+{
+    if ((e1 - a1) + (e2 - a2) <= MERGE_GRAIN)
+    {
+        mergeRange(a1, e1, a2, e2, out);
+        return;
+    }
+    const int *m1, *m2;
+    if (e1 - a1 >= e2 - a2)
+    {
+        m1 = a1 + (e1 - a1) / 2;
+        m2 = lower_bound(a2, e2, *m1); // 右段中等于 *m1 的元素排在它后面
+    }
+    else
+    {
+        m2 = a2 + (e2 - a2) / 2;
+        m1 = upper_bound(a1, e1, *m2); // 左段中等于 *m2 的元素排在它前面
+    }
+    int *outMid = out + (m1 - a1) + (m2 - a2);
+    TaskPool::Group group;
+    pool.spawn(group, [=, &pool]
+               { parallelMerge(a1, m1, a2, m2, out, pool); });
+    parallelMerge(m1, e1, m2, e2, outMid, pool);
+    pool.wait(group);
+}
+
+// 并行归并排序 a[lo, hi)：结果放在 a（toTemp 为 false）或 temp（toTemp 为 true）里。
+// 两个子区间把结果放到另一块缓冲区，再合并回目标，避免每层都拷贝一遍
+void parallelMergeSortTask(int *a, int *temp, int lo, int hi, bool toTemp, TaskPool &pool)
+{
+    if (hi - lo <= PARALLEL_GRAIN)
+    {
+        mergeSortBottomUp(a + lo, temp + lo, hi - lo);
+        if (toTemp)
+        {
+            copy(a + lo, a + hi, temp + lo);
+        }
+        return;
+    }
+    int mid = lo + (hi - lo) / 2;
+    TaskPool::Group group;
+    pool.spawn(group, [=, &pool]
+               { parallelMergeSortTask(a, temp, lo, mid, !toTemp, pool); });
+    parallelMergeSortTask(a, temp, mid, hi, !toTemp, pool);
+    pool.wait(group);
+    const int *src = toTemp ? a : temp;
+    int *dst = toTemp ? temp : a;
+    parallelMerge(src + lo, src + mid, src + mid, src + hi, dst + lo, pool);
+}
+
+void parallelMergeSort(vector<int> &nums, TaskPool &pool)
+{
+    vector<int> temp(nums.size());
+    parallelMergeSortTask(nums.data(), temp.data(), 0, (int)nums.size(), false, pool);
+}
+
+template <typename Sort>
+double timeSort(vector<int> nums, const vector<int> &expect, Sort sortFunc)
+{
+    auto start = chrono::steady_clock::now();
+    sortFunc(nums);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (nums != expect)
+    {
+        cout << "结果错误 ";
+    }
+    return seconds;
+}
+
+void benchInput(const char *name, const vector<int> &data, TaskPool &pool)
+{
+    vector<int> expect(data);
+    sort(expect.begin(), expect.end());
+    double stdTime = timeSort(data, expect, [](vector<int> &v)
+                              { stable_sort(v.begin(), v.end()); });
+    double optTime = timeSort(data, expect, [](vector<int> &v)
+                              { mergeSortOpt(v); });
+    double bottomUpTime = timeSort(data, expect, [](vector<int> &v)
+                                   { mergeSortBottomUp(v); });
+    double parTime = timeSort(data, expect, [&pool](vector<int> &v)
+                              { parallelMergeSort(v, pool); });
+    cout << name << endl;
+    cout << "  std::stable_sort   " << stdTime << " s" << endl;
+    cout << "  mergeSortOpt       " << optTime << " s" << endl;
+    cout << "  mergeSortBottomUp  " << bottomUpTime << " s" << endl;
+    cout << "  parallelMergeSort  " << parTime << " s  加速比 " << bottomUpTime / parTime << endl;
+}
+
+// 压测：./a.out bench [n] [threads]，默认 1 亿个数、全部核心；
+// 分别测随机输入和基本有序（有序后随机交换 1% 的位置）的输入
+void bench(int n, unsigned threads)
+{
+    TaskPool pool(threads);
+    cout << n << " 个元素, " << pool.threadCount() << " 线程" << endl;
+    vector<int> data(n);
+    mt19937 rng(12345);
+    for (int &x : data)
+    {
+        x = (int)rng();
+    }
+    benchInput("随机", data, pool);
+    sort(data.begin(), data.end());
+    for (int i = 0; i < n / 100; i++)
+    {
+        swap(data[rng() % n], data[rng() % n]);
+    }
+    benchInput("基本有序", data, pool);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        int n = argc > 2 ? atoi(argv[2]) : 100000000;
+        unsigned threads = argc > 3 ? (unsigned)atoi(argv[3]) : thread::hardware_concurrency();
+        bench(n, threads);
+        return 0;
+    }
+    vector<int> nums = {12, 11, 13, 5, 6, 7, 3, 3, 1};
+    TaskPool pool;
+    parallelMergeSort(nums, pool);
+    for (int x : nums)
+    {
+        cout << x << " ";
+    }
+    cout << endl;
     return 0;
 }